@@ -0,0 +1,45 @@
+#include <migraphx/argument.hpp>
+#include <migraphx/errors.hpp>
+#include <cstdlib>
+#include <cstring>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+
+const std::size_t argument_alignment = 64;
+const std::size_t huge_page_size     = 2 * 1024 * 1024;
+
+std::shared_ptr<char> allocate_aligned(std::size_t bytes)
+{
+    // Allocations of huge page size are aligned to a huge page so they can be
+    // backed by them
+    auto alignment = bytes < huge_page_size ? argument_alignment : huge_page_size;
+    auto n         = (bytes + argument_alignment - 1) / argument_alignment * argument_alignment;
+    // Empty shapes still need a valid pointer
+    if(n == 0)
+        n = argument_alignment;
+    void* data = nullptr;
+    if(posix_memalign(&data, alignment, n) != 0)
+        MIGRAPHX_THROW("Failed to allocate " + std::to_string(bytes) + " bytes");
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    if(alignment == huge_page_size)
+        madvise(data, n, MADV_HUGEPAGE);
+#endif
+    return {static_cast<char*>(data), [](char* x) { std::free(x); }}; // NOLINT
+}
+
+argument::argument(const shape& s) : argument(s, allocate_aligned)
+{
+    std::memset(this->data(), 0, s.bytes());
+}
+
+argument::argument(const shape& s, const argument_allocator& alloc)
+    : m_data(alloc(s.bytes())), m_shape(s)
+{
+}
+
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
@@ -0,0 +1,156 @@
+#include <migraphx/compile_profiler.hpp>
+#include <migraphx/json.hpp>
+#include <algorithm>
+#include <iomanip>
+#include <numeric>
+#include <utility>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+
+thread_local compile_profiler* current_compile_profiler = nullptr;
+
+// The passes are only validated in debug builds
+#ifdef NDEBUG
+const bool validates_passes = false;
+#else
+const bool validates_passes = true;
+#endif
+
+compile_profiler* get_compile_profiler() { return current_compile_profiler; }
+
+compile_profiler* set_compile_profiler(compile_profiler* p)
+{
+    return std::exchange(current_compile_profiler, p);
+}
+
+void compile_profiler::add_pass(pass_record r) { passes.push_back(std::move(r)); }
+
+void compile_profiler::add_match(const std::string& name, bool hit, double time)
+{
+    auto& r = matchers[name];
+    r.attempts++;
+    if(hit)
+        r.hits++;
+    r.time += time;
+}
+
+const std::vector<compile_profiler::pass_record>& compile_profiler::get_passes() const
+{
+    return passes;
+}
+
+const std::map<std::string, compile_profiler::matcher_record>&
+compile_profiler::get_matchers() const
+{
+    return matchers;
+}
+
+double compile_profiler::total_time() const
+{
+    return std::accumulate(passes.begin(), passes.end(), 0.0, [](double x, const auto& r) {
+        return x + r.time + r.validate_time;
+    });
+}
+
+value compile_profiler::to_value() const
+{
+    value result;
+    value vpasses = value::array{};
+    for(auto&& r : passes)
+    {
+        value v;
+        v["name"]                = r.name;
+        v["time"]                = r.time;
+        if(validates_passes)
+            v["validate_time"] = r.validate_time;
+        v["instructions_before"] = r.instructions_before;
+        v["instructions_after"]  = r.instructions_after;
+        vpasses.push_back(v);
+    }
+    value vmatchers = value::array{};
+    for(auto&& p : matchers)
+    {
+        value v;
+        v["name"]     = p.first;
+        v["attempts"] = p.second.attempts;
+        v["hits"]     = p.second.hits;
+        v["time"]     = p.second.time;
+        vmatchers.push_back(v);
+    }
+    result["passes"]     = vpasses;
+    result["matchers"]   = vmatchers;
+    result["total_time"] = this->total_time();
+    return result;
+}
+
+std::string compile_profiler::to_json() const { return to_json_string(this->to_value()); }
+
+template <class Range, class F>
+static std::size_t column_width(const Range& r, const std::string& header, F f)
+{
+    std::size_t result = header.size();
+    for(auto&& x : r)
+        result = std::max(result, f(x).size());
+    return result + 2;
+}
+
+void compile_profiler::print(std::ostream& os) const
+{
+    auto flags = os.flags();
+    os << std::fixed << std::setprecision(3);
+
+    auto name_width =
+        column_width(passes, "Pass", [](const pass_record& r) -> const std::string& {
+            return r.name;
+        });
+    os << std::left << std::setw(name_width) << "Pass" << std::right << std::setw(12)
+       << "Time(ms)";
+    if(validates_passes)
+        os << std::setw(14) << "Validate(ms)";
+    os << std::setw(14) << "Instructions" << std::setw(10) << "Delta" << std::endl;
+    for(auto&& r : passes)
+    {
+        auto delta = std::ptrdiff_t(r.instructions_after) - std::ptrdiff_t(r.instructions_before);
+        os << std::left << std::setw(name_width) << r.name << std::right << std::setw(12) << r.time;
+        if(validates_passes)
+            os << std::setw(14) << r.validate_time;
+        os << std::setw(14) << r.instructions_after << std::setw(10) << std::showpos << delta
+           << std::noshowpos << std::endl;
+    }
+    os << std::endl;
+
+    if(not matchers.empty())
+    {
+        std::vector<std::pair<std::string, matcher_record>> sorted(matchers.begin(),
+                                                                   matchers.end());
+        std::sort(sorted.begin(), sorted.end(), [](const auto& x, const auto& y) {
+            return x.second.time > y.second.time;
+        });
+        auto matcher_width =
+            column_width(sorted, "Matcher", [](const auto& p) -> const std::string& {
+                return p.first;
+            });
+        os << std::left << std::setw(matcher_width) << "Matcher" << std::right << std::setw(12)
+           << "Attempts" << std::setw(10) << "Hits" << std::setw(12) << "Time(ms)" << std::endl;
+        for(auto&& p : sorted)
+        {
+            os << std::left << std::setw(matcher_width) << p.first << std::right << std::setw(12)
+               << p.second.attempts << std::setw(10) << p.second.hits << std::setw(12)
+               << p.second.time << std::endl;
+        }
+        os << std::endl;
+    }
+
+    auto validate_time =
+        std::accumulate(passes.begin(), passes.end(), 0.0, [](double x, const auto& r) {
+            return x + r.validate_time;
+        });
+    os << "Total time: " << this->total_time() << "ms" << std::endl;
+    if(validates_passes)
+        os << "Validate time: " << validate_time << "ms" << std::endl;
+    os.flags(flags);
+}
+
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
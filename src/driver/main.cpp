@@ -8,6 +8,7 @@
 #include <migraphx/onnx.hpp>
 #include <migraphx/stringutils.hpp>
 
+#include <migraphx/compile_profiler.hpp>
 #include <migraphx/dead_code_elimination.hpp>
 #include <migraphx/eliminate_identity.hpp>
 #include <migraphx/eliminate_pad.hpp>
@@ -19,6 +20,7 @@
 #include <migraphx/rewrite_batchnorm.hpp>
 #include <migraphx/simplify_algebra.hpp>
 #include <migraphx/simplify_reshapes.hpp>
+#include <migraphx/sink_transposes.hpp>
 
 #include <fstream>
 
@@ -104,6 +106,7 @@ struct loader
                                      migraphx::dead_code_elimination{},
                                      migraphx::simplify_algebra{},
                                      migraphx::dead_code_elimination{},
+                                     migraphx::sink_transposes{},
                                      migraphx::simplify_reshapes{},
                                      migraphx::dead_code_elimination{},
                                      migraphx::propagate_constant{},
@@ -143,9 +146,11 @@ struct compiler
     static const int q_int8 = 2;
     loader l;
     program_params parameters;
-    bool gpu          = true;
-    bool offload_copy = false;
-    int quantize      = 0;
+    bool gpu             = true;
+    bool offload_copy    = false;
+    bool profile_compile = false;
+    std::string profile_json;
+    int quantize = 0;
 
     std::vector<std::string> fill0;
     std::vector<std::string> fill1;
@@ -161,6 +166,13 @@ struct compiler
            ap.set_value(true));
         ap(quantize, {"--fp16"}, ap.help("Quantize for fp16"), ap.set_value(q_fp16));
         ap(quantize, {"--int8"}, ap.help("Quantize for int8"), ap.set_value(q_int8));
+        ap(profile_compile,
+           {"--profile-compile"},
+           ap.help("Print the time spent in each pass and matcher while compiling"),
+           ap.set_value(true));
+        ap(profile_json,
+           {"--profile-compile-json"},
+           ap.help("Write the time spent in each pass and matcher while compiling to a json file"));
     }
 
     auto params(const program& p, bool use_gpu = true)
@@ -180,9 +192,19 @@ struct compiler
         {
             quantize_int8(p, t, {params(p, false)});
         }
+        compile_profiler profiler;
         compile_options options;
         options.offload_copy = offload_copy;
+        if(profile_compile or not profile_json.empty())
+            options.profiler = &profiler;
         p.compile(t, options);
+        if(profile_compile)
+            profiler.print(std::cout);
+        if(not profile_json.empty())
+        {
+            std::ofstream os(profile_json);
+            os << profiler.to_json() << std::endl;
+        }
         return p;
     }
 };
@@ -4,45 +4,128 @@
 #include <migraphx/iterator_for.hpp>
 #include <migraphx/ranges.hpp>
 #include <migraphx/functional.hpp>
+#include <migraphx/value.hpp>
 
-#include <unordered_set>
+#include <algorithm>
+#include <unordered_map>
 
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
 
-template <class Range>
-void cse_range(program& p, Range&& r)
+static void hash_combine(std::size_t& seed, std::size_t h)
 {
-    std::unordered_multimap<std::string, instruction_ref> instructions;
-    std::unordered_set<instruction_ref> processed_ins;
-    for(auto ins : r)
+    seed ^= h + 0x9e3779b9 + (seed << 6u) + (seed >> 2u);
+}
+
+static std::size_t hash_bytes(const char* data, std::size_t n)
+{
+    // FNV-1a
+    std::size_t h = 14695981039346656037ull;
+    for(std::size_t i = 0; i < n; i++)
+    {
+        h ^= static_cast<unsigned char>(data[i]);
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+struct value_hasher
+{
+    std::size_t* seed;
+
+    template <class T>
+    void operator()(const T& x) const
+    {
+        hash_combine(*seed, std::hash<T>{}(x));
+    }
+
+    void operator()(std::nullptr_t) const {}
+
+    void operator()(const value::binary& x) const
+    {
+        hash_combine(*seed, hash_bytes(x.data(), x.size()));
+    }
+
+    void operator()(const std::vector<value>&) const {}
+
+    template <class T>
+    void operator()(const std::pair<std::string, T>& x) const
+    {
+        (*this)(x.second);
+    }
+};
+
+static std::size_t hash_value(const value& v)
+{
+    std::size_t seed = std::hash<std::string>{}(v.get_key());
+    if(v.is_array() or v.is_object())
+    {
+        for(auto&& x : v)
+            hash_combine(seed, hash_value(x));
+    }
+    else
+    {
+        v.visit(value_hasher{&seed});
+    }
+    return seed;
+}
+
+static std::size_t hash_shape(const shape& s)
+{
+    std::size_t seed = s.type();
+    for(auto len : s.lens())
+        hash_combine(seed, len);
+    for(auto stride : s.strides())
+        hash_combine(seed, stride);
+    return seed;
+}
+
+// Hash the fields that instruction equality compares, so equal instructions
+// always land in the same bucket. Inputs are hashed by identity since they
+// have already been deduplicated by the time an instruction is visited.
+static std::size_t hash_instruction(instruction_ref ins)
+{
+    std::size_t seed = hash_value(ins->get_operator().to_value());
+    hash_combine(seed, std::hash<std::string>{}(ins->name()));
+    hash_combine(seed, hash_shape(ins->get_shape()));
+    for(auto input : ins->inputs())
+        hash_combine(seed, std::hash<instruction_ref>{}(input));
+    if(ins->name() == "@literal")
+    {
+        // Only a prefix of the data is hashed so large weights are not read
+        // in full, the rest is checked when comparing
+        const auto& lit = ins->get_literal();
+        auto n          = std::min<std::size_t>(lit.get_shape().bytes(), 64);
+        hash_combine(seed, hash_bytes(lit.data(), n));
+    }
+    return seed;
+}
+
+void eliminate_common_subexpression::apply(program& p) const
+{
+    // Instructions are visited in order so the inputs of each instruction are
+    // already replaced by their first occurrence, which means one pass finds
+    // every chain of duplicates
+    std::unordered_multimap<std::size_t, instruction_ref> instructions;
+    for(auto ins : iterator_for(p))
     {
         // Skip dead instructions
         if(ins->outputs().empty())
             continue;
 
-        // Find instruction with the same name
-        auto found_instructions = range(instructions.equal_range(ins->name()));
-        for(const auto& pp : found_instructions)
+        auto h     = hash_instruction(ins);
+        auto found = range(instructions.equal_range(h));
+        auto eq    = std::find_if(found.begin(), found.end(), [&](const auto& pp) {
+            return *pp.second == *ins;
+        });
+        if(eq != found.end())
         {
-            auto eq = pp.second;
-            if(contains(processed_ins, eq))
-                continue;
-            if(*eq != *ins)
-                continue;
-            p.replace_instruction(ins, eq);
-            processed_ins.emplace(ins);
-            auto outputs = eq->outputs();
-            std::sort(outputs.begin(), outputs.end(), [&](auto x, auto y) {
-                return std::distance(eq, x) < std::distance(eq, y);
-            });
-            cse_range(p, outputs);
+            p.replace_instruction(ins, eq->second);
+            continue;
         }
-        instructions.emplace(ins->name(), ins);
+        instructions.emplace(h, ins);
     }
 }
 
-void eliminate_common_subexpression::apply(program& p) const { cse_range(p, iterator_for(p)); }
-
 } // namespace MIGRAPHX_INLINE_NS
 } // namespace migraphx
@@ -0,0 +1,38 @@
+#include <migraphx/file_buffer.hpp>
+#include <migraphx/errors.hpp>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+
+std::shared_ptr<char> map_file(const std::string& filename, std::size_t& size)
+{
+    auto fd = ::open(filename.c_str(), O_RDONLY);
+    if(fd < 0)
+        MIGRAPHX_THROW("Failed to open file: " + filename);
+    struct stat st;
+    if(::fstat(fd, &st) != 0)
+    {
+        ::close(fd);
+        MIGRAPHX_THROW("Failed to read the size of file: " + filename);
+    }
+    size = st.st_size;
+    // An empty file can not be mapped
+    if(size == 0)
+    {
+        ::close(fd);
+        return nullptr;
+    }
+    auto* data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(data == MAP_FAILED) // NOLINT
+        MIGRAPHX_THROW("Failed to map file: " + filename);
+    auto n = size;
+    return {static_cast<char*>(data), [n](char* x) { ::munmap(x, n); }};
+}
+
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
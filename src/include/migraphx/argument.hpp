@@ -5,71 +5,85 @@
 #include <migraphx/raw_data.hpp>
 #include <migraphx/config.hpp>
 #include <functional>
+#include <memory>
 #include <utility>
 
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
 
+/// Allocates `bytes` of memory, which is kept alive by the returned pointer
+using argument_allocator = std::function<std::shared_ptr<char>(std::size_t bytes)>;
+
+/// Allocate memory aligned to 64 bytes that is not initialized. Large
+/// allocations are backed by huge pages where available.
+std::shared_ptr<char> allocate_aligned(std::size_t bytes);
+
 /**
  * @brief Arguments passed to instructions
  *
  * An `argument` can represent a raw buffer of data that either be referenced from another element
- * or it can be owned by the argument.
+ * or it can be owned by the argument. The argument holds a pointer to the data together with the
+ * owner of the buffer, so copies of an argument share the same data.
  *
  */
 struct argument : raw_data<argument>
 {
     argument() {}
 
-    argument(const shape& s) : m_shape(s)
-    {
-        std::vector<char> buffer(s.bytes());
-        // TODO: Move vector
-        data = [=]() mutable { return buffer.data(); };
-    }
+    /// Allocate zero initialized memory for the shape
+    argument(const shape& s);
+
+    /// Allocate memory for the shape with `alloc`, which is not initialized
+    argument(const shape& s, const argument_allocator& alloc);
 
+    /// Keep `d` alive as the owner of the data. `d` is called once, when the
+    /// argument is made, so the pointer it returns must stay valid as long
+    /// as `d` lives.
     template <class F, MIGRAPHX_REQUIRES(std::is_pointer<decltype(std::declval<F>()())>{})>
-    argument(shape s, F d)
-        : data([f = std::move(d)]() mutable { return reinterpret_cast<char*>(f()); }),
-          m_shape(std::move(s))
+    argument(shape s, F d) : m_shape(std::move(s))
     {
+        auto f = std::make_shared<F>(std::move(d));
+        m_data = std::shared_ptr<char>(f, reinterpret_cast<char*>((*f)()));
     }
-    template <class T>
+
+    /// Reference data that is owned elsewhere. The argument does not keep the
+    /// data alive, so it must not be used once the owner is gone.
+    template <class T, MIGRAPHX_REQUIRES(not std::is_function<T>{})>
     argument(shape s, T* d)
-        : data([d] { return reinterpret_cast<char*>(d); }), m_shape(std::move(s))
+        : m_data(std::shared_ptr<char>{}, reinterpret_cast<char*>(d)), m_shape(std::move(s))
     {
     }
 
+    /// Share the ownership of the data
     template <class T>
     argument(shape s, std::shared_ptr<T> d)
-        : data([d] { return reinterpret_cast<char*>(d.get()); }), m_shape(std::move(s))
+        : m_data(d, reinterpret_cast<char*>(d.get())), m_shape(std::move(s))
     {
     }
 
-    argument(shape s, std::nullptr_t) : data([] { return nullptr; }), m_shape(std::move(s)) {}
+    argument(shape s, std::nullptr_t) : m_shape(std::move(s)) {}
 
     /// Provides a raw pointer to the data
-    std::function<char*()> data = nullptr;
+    char* data() const { return m_data.get(); }
 
     /// Whether data is available
-    bool empty() const { return not data; }
+    bool empty() const { return m_data == nullptr; }
 
     const shape& get_shape() const { return this->m_shape; }
 
-    argument reshape(const shape& s) const
+    argument reshape(const shape& s) const { return {s, m_data}; }
+
+    /// Reference the data starting at `offset` bytes with another shape
+    argument view(const shape& s, std::size_t offset) const
     {
-        argument self = *this;
-        return {s, [=]() mutable { return self.data(); }};
+        return {s, std::shared_ptr<char>(m_data, m_data.get() + offset)};
     }
 
     /// Make copy of the argument that is always sharing the data
-    argument share() const
-    {
-        auto self = std::make_shared<argument>(*this);
-        return {m_shape, [self]() mutable { return self->data(); }};
-    }
+    argument share() const { return *this; }
 
     private:
+    std::shared_ptr<char> m_data;
     shape m_shape;
 };
 
@@ -7,10 +7,14 @@
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
 
+struct compile_profiler;
+
 struct compile_options
 {
     bool offload_copy = false;
     tracer trace{};
+    /// Records the cost of the passes and matchers when set
+    compile_profiler* profiler = nullptr;
 };
 
 } // namespace MIGRAPHX_INLINE_NS
@@ -0,0 +1,73 @@
+#ifndef MIGRAPHX_GUARD_RTGLIB_COMPILE_PROFILER_HPP
+#define MIGRAPHX_GUARD_RTGLIB_COMPILE_PROFILER_HPP
+
+#include <migraphx/config.hpp>
+#include <migraphx/value.hpp>
+#include <chrono>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+
+/**
+ * @brief Records where the time goes while compiling a program
+ * @details The passes record their time, the time to validate the program
+ * after them and how they changed the number of instructions. The program is
+ * only validated in debug builds, so release builds do not report a
+ * validation time. Matchers run with find_matches record how often they are
+ * tried, how often they match and the time spent matching.
+ */
+struct compile_profiler
+{
+    using milliseconds = std::chrono::duration<double, std::milli>;
+
+    struct pass_record
+    {
+        std::string name;
+        double time                     = 0;
+        /// Always 0 in release builds, which skip the validation
+        double validate_time            = 0;
+        std::size_t instructions_before = 0;
+        std::size_t instructions_after  = 0;
+    };
+
+    struct matcher_record
+    {
+        std::size_t attempts = 0;
+        std::size_t hits     = 0;
+        double time          = 0;
+    };
+
+    void add_pass(pass_record r);
+    void add_match(const std::string& name, bool hit, double time);
+
+    const std::vector<pass_record>& get_passes() const;
+    const std::map<std::string, matcher_record>& get_matchers() const;
+
+    /// Total time of the passes including validation
+    double total_time() const;
+
+    value to_value() const;
+    std::string to_json() const;
+
+    /// Print a table of the passes and a table of the matchers
+    void print(std::ostream& os) const;
+
+    private:
+    std::vector<pass_record> passes;
+    std::map<std::string, matcher_record> matchers;
+};
+
+/// The profiler for the passes running on this thread, or nullptr
+compile_profiler* get_compile_profiler();
+
+/// Set the profiler for this thread and return the previous one
+compile_profiler* set_compile_profiler(compile_profiler* p);
+
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef MIGRAPHX_GUARD_RTGLIB_FILE_BUFFER_HPP
+#define MIGRAPHX_GUARD_RTGLIB_FILE_BUFFER_HPP
+
+#include <migraphx/config.hpp>
+#include <memory>
+#include <string>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+
+/**
+ * @brief Map a file into memory
+ *
+ * The pages are private, so writing to them does not change the file. The file
+ * is unmapped when the last copy of the returned pointer is released.
+ *
+ * @param filename The file to map
+ * @param size Set to the size of the file
+ */
+std::shared_ptr<char> map_file(const std::string& filename, std::size_t& size);
+
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+
+#endif
@@ -57,6 +57,9 @@ struct literal : raw_data<literal>
         std::copy(x, x + s.bytes(), buffer.get());
     }
 
+    /// Use the data in `b` without a copy, which is kept alive by the literal
+    literal(const shape& s, std::shared_ptr<char> b) : buffer(std::move(b)), m_shape(s) {}
+
     /// Whether data is available
     bool empty() const { return this->buffer == nullptr; }
 
@@ -68,8 +71,9 @@ struct literal : raw_data<literal>
     /// Convert the data to an argument
     argument get_argument() const
     {
-        std::vector<char> b(buffer.get(), buffer.get() + m_shape.bytes());
-        return {m_shape, [b]() mutable { return b.data(); }};
+        argument result{m_shape, allocate_aligned};
+        std::copy(buffer.get(), buffer.get() + m_shape.bytes(), result.data());
+        return result;
     }
 
     private:
@@ -0,0 +1,26 @@
+#ifndef MIGRAPHX_GUARD_RTGLIB_LOAD_SAVE_HPP
+#define MIGRAPHX_GUARD_RTGLIB_LOAD_SAVE_HPP
+
+#include <migraphx/program.hpp>
+#include <migraphx/config.hpp>
+#include <string>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+
+/**
+ * @brief Write the program to a binary file
+ *
+ * The instructions are stored as msgpack, followed by the raw data of the
+ * literals. A compiled program also records its target, so it can be run
+ * after loading without compiling it again.
+ */
+void save(const program& p, const std::string& filename);
+
+/// Read a program written by `save`, where the literals use the memory mapped file
+program load(const std::string& filename);
+
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+
+#endif
@@ -7,6 +7,8 @@
 #include <migraphx/program.hpp>
 #include <migraphx/iterator_for.hpp>
 #include <migraphx/type_name.hpp>
+#include <migraphx/compile_profiler.hpp>
+#include <migraphx/time.hpp>
 #include <migraphx/config.hpp>
 #include <unordered_map>
 #include <unordered_set>
@@ -224,11 +226,24 @@ void find_matches(program& p, instruction_ref ins, Ms&&... ms)
 #endif
         bool trace = enabled(MIGRAPHX_TRACE_MATCHES{});
     bool match     = false;
+    auto* profiler = get_compile_profiler();
     each_args(
         [&](auto&& m) {
             if(match)
                 return;
-            auto r = match_instruction(p, ins, m.matcher());
+            matcher_result r;
+            if(profiler == nullptr)
+            {
+                r = match_instruction(p, ins, m.matcher());
+            }
+            else
+            {
+                // The name is only needed for profiling, so it is computed on first use
+                static const std::string name = get_type_name(m);
+                auto t                        = time<compile_profiler::milliseconds>(
+                    [&] { r = match_instruction(p, ins, m.matcher()); });
+                profiler->add_match(name, r.result != p.end(), t);
+            }
             if(r.result == p.end())
                 return;
             if(trace)
@@ -3,12 +3,17 @@
 
 #include <migraphx/config.hpp>
 #include <migraphx/value.hpp>
+#include <memory>
+#include <vector>
 
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
 
 std::vector<char> to_msgpack(const value& v);
 value from_msgpack(const std::vector<char>& buffer);
+value from_msgpack(const char* buffer, std::size_t size);
+/// Binary values refer to the bytes in `buffer` instead of copying them
+value from_msgpack(std::shared_ptr<const char> buffer, std::size_t size);
 
 } // namespace MIGRAPHX_INLINE_NS
 } // namespace migraphx
@@ -18,6 +18,9 @@ struct onnx_options
     bool skip_unknown_operators = false;
     /// Print program if an error occurs
     bool print_program_on_error = false;
+    /// Map the onnx file and the files with external data into memory instead of reading them,
+    /// so the literals of external data use the mapped pages without a copy
+    bool use_mmap = false;
 };
 
 /// Create a program from an onnx file
@@ -65,6 +65,15 @@ struct argmax
     argument compute(const shape& output_shape, std::vector<argument> args) const
     {
         argument result{output_shape};
+        compute_to(result, args);
+        return result;
+    }
+
+    /// Write the result to `result`, which was allocated for the output shape
+    void compute_to(const argument& result, const std::vector<argument>& args) const
+    {
+        const auto& output_shape = result.get_shape();
+
         auto n_dim          = args.front().get_shape().lens().size();
         auto tuned_axis     = axis < 0 ? axis + n_dim : axis;
         auto batch_item_num = args.front().get_shape().lens()[tuned_axis];
@@ -77,8 +86,6 @@ struct argmax
                 });
             });
         });
-
-        return result;
     }
 };
 
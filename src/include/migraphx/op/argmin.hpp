@@ -64,6 +64,15 @@ struct argmin
     argument compute(const shape& output_shape, std::vector<argument> args) const
     {
         argument result{output_shape};
+        compute_to(result, args);
+        return result;
+    }
+
+    /// Write the result to `result`, which was allocated for the output shape
+    void compute_to(const argument& result, const std::vector<argument>& args) const
+    {
+        const auto& output_shape = result.get_shape();
+
         auto n_dim                 = args.front().get_shape().lens().size();
         auto tuned_axis            = axis < 0 ? axis + n_dim : axis;
         std::size_t batch_item_num = args.front().get_shape().lens()[tuned_axis];
@@ -76,8 +85,6 @@ struct argmin
                 });
             });
         });
-
-        return result;
     }
 };
 
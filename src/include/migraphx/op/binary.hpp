@@ -5,6 +5,9 @@
 #include <migraphx/check_shapes.hpp>
 #include <migraphx/shape_for_each.hpp>
 #include <migraphx/argument.hpp>
+#include <migraphx/par_for.hpp>
+#include <migraphx/reduce_dims.hpp>
+#include <algorithm>
 
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
@@ -31,9 +34,16 @@ struct binary : op_name<Derived>
     argument compute(const shape& output_shape, std::vector<argument> args) const
     {
         argument result{output_shape};
+        compute_to(result, args);
+        return result;
+    }
+
+    /// Write the result to `result`, which was allocated for the output shape
+    void compute_to(const argument& result, const std::vector<argument>& args) const
+    {
         auto s1 = args[0].get_shape();
         auto s2 = args[1].get_shape();
-        if(s1 == s2 and s1.packed())
+        if(s1 == s2 and s1.packed() and s1.strides() == result.get_shape().strides())
         {
             shape std_shape{s1.type(), s1.lens()};
             argument std_result{std_shape, result.data()};
@@ -50,14 +60,76 @@ struct binary : op_name<Derived>
         else
         {
             visit_all(result, args[0], args[1])([&](auto output, auto input1, auto input2) {
-                shape_for_each(output.get_shape(), [&](const auto& idx) {
-                    output(idx.begin(), idx.end()) = static_cast<const Derived&>(*this).apply()(
-                        input1(idx.begin(), idx.end()), input2(idx.begin(), idx.end()));
-                });
+                strided_transform(
+                    output, input1, input2, static_cast<const Derived&>(*this).apply());
             });
         }
+    }
 
-        return result;
+    // Apply f to the elements of x and y that are at the same index, for
+    // shapes that are broadcast or transposed. The dimensions that are
+    // contiguous in all three tensors are merged, so the work is split into
+    // rows of the last dimension.
+    template <class T, class U, class V, class F>
+    static void strided_transform(T output, U x, V y, F f)
+    {
+        // The number of elements of a row evaluated by one task
+        const std::size_t block_size = 4096;
+        // The smallest number of tasks for each thread
+        const std::size_t min_blocks = 16;
+        auto shapes      = reduce_dims({output.get_shape(), x.get_shape(), y.get_shape()});
+        const auto& lens = shapes[0].lens();
+        if(shapes[0].elements() == 0)
+            return;
+        auto n        = lens.size();
+        auto len      = lens.back();
+        auto nblocks  = (len + block_size - 1) / block_size;
+        auto nrows    = shapes[0].elements() / len;
+        auto o_stride = shapes[0].strides().back();
+        auto x_stride = shapes[1].strides().back();
+        auto y_stride = shapes[2].strides().back();
+        par_for(nrows * nblocks, min_blocks, [&](std::size_t i) {
+            auto row   = i / nblocks;
+            auto first = (i % nblocks) * block_size;
+            auto last  = std::min(len, first + block_size);
+            // The offset of the row in each tensor
+            std::size_t o_offset = 0;
+            std::size_t x_offset = 0;
+            std::size_t y_offset = 0;
+            for(std::size_t d = n - 1; d > 0; d--)
+            {
+                auto idx = row % lens[d - 1];
+                row /= lens[d - 1];
+                o_offset += idx * shapes[0].strides()[d - 1];
+                x_offset += idx * shapes[1].strides()[d - 1];
+                y_offset += idx * shapes[2].strides()[d - 1];
+            }
+            auto* o       = output.data() + o_offset;
+            const auto* a = x.data() + x_offset;
+            const auto* b = y.data() + y_offset;
+            if(o_stride == 1 and x_stride == 1 and y_stride == 1)
+            {
+                for(auto j = first; j < last; j++)
+                    o[j] = f(a[j], b[j]);
+            }
+            else if(o_stride == 1 and x_stride == 1 and y_stride == 0)
+            {
+                auto b0 = *b;
+                for(auto j = first; j < last; j++)
+                    o[j] = f(a[j], b0);
+            }
+            else if(o_stride == 1 and x_stride == 0 and y_stride == 1)
+            {
+                auto a0 = *a;
+                for(auto j = first; j < last; j++)
+                    o[j] = f(a0, b[j]);
+            }
+            else
+            {
+                for(auto j = first; j < last; j++)
+                    o[j * o_stride] = f(a[j * x_stride], b[j * y_stride]);
+            }
+        });
     }
 };
 
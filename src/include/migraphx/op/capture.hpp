@@ -29,6 +29,9 @@ struct capture
 
     shape compute_shape(std::vector<shape> inputs) const { return inputs.front(); }
 
+    // The input is returned, so it must stay live as long as the capture
+    std::ptrdiff_t output_alias(const std::vector<shape>&) const { return 0; }
+
     argument compute(const shape&, std::vector<argument> args) const
     {
         if(f)
@@ -30,7 +30,13 @@ struct clip
     argument compute(const shape& output_shape, std::vector<argument> args) const
     {
         argument result{output_shape};
+        compute_to(result, args);
+        return result;
+    }
 
+    /// Write the result to `result`, which was allocated for the output shape
+    void compute_to(const argument& result, const std::vector<argument>& args) const
+    {
         visit_all(result, args[0], args[1], args[2])(
             [&](auto output, auto input, auto min_val, auto max_val) {
                 auto max = max_val.front();
@@ -40,7 +46,6 @@ struct clip
                     return std::min(std::max(type(min), x), type(max));
                 });
             });
-        return result;
     }
 };
 
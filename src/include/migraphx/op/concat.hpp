@@ -77,6 +77,15 @@ struct concat
     argument compute(const shape& output_shape, std::vector<argument> args) const
     {
         argument result{output_shape};
+        compute_to(result, args);
+        return result;
+    }
+
+    /// Write the result to `result`, which was allocated for the output shape
+    void compute_to(const argument& result, const std::vector<argument>& args) const
+    {
+        const auto& output_shape = result.get_shape();
+
         std::vector<std::size_t> coffsets = compute_offsets(output_shape, args);
         for(std::size_t l = 0; l < args.size(); l++)
         {
@@ -93,7 +102,6 @@ struct concat
                 }
             });
         }
-        return result;
     }
 };
 
@@ -8,6 +8,7 @@
 #include <migraphx/literal.hpp>
 #include <migraphx/shape_for_each.hpp>
 #include <migraphx/config.hpp>
+#include <algorithm>
 #include <cmath>
 #include <utility>
 
@@ -37,12 +38,16 @@ struct contiguous
     {
         assert(output_shape.standard());
         argument result{output_shape};
+        compute_to(result, args);
+        return result;
+    }
+
+    /// Write the result to `result`, which was allocated for the output shape
+    void compute_to(const argument& result, const std::vector<argument>& args) const
+    {
         visit_all(result, args[0])([&](auto output, auto input) {
-            shape_for_each(output.get_shape(), [&](const auto& idx) {
-                output(idx.begin(), idx.end()) = input(idx.begin(), idx.end());
-            });
+            std::copy(input.strided_begin(), input.strided_end(), output.strided_begin());
         });
-        return result;
     }
 };
 
@@ -8,6 +8,7 @@
 #include <migraphx/literal.hpp>
 #include <migraphx/shape_for_each.hpp>
 #include <migraphx/config.hpp>
+#include <algorithm>
 #include <cmath>
 #include <utility>
 
@@ -60,6 +61,14 @@ struct gather
     argument compute(const shape& output_shape, std::vector<argument> args) const
     {
         argument result{output_shape};
+        compute_to(result, args);
+        return result;
+    }
+
+    /// Write the result to `result`, which was allocated for the output shape
+    void compute_to(const argument& result, const std::vector<argument>& args) const
+    {
+        const auto& output_shape = result.get_shape();
         // negative axis means counting dimensions from back
         auto lens      = args[0].get_shape().lens();
         int axis_index = (axis < 0) ? static_cast<int>(lens.size() + axis) : axis;
@@ -78,20 +87,39 @@ struct gather
                 {
                     auto out_lens        = data.get_shape().lens();
                     out_lens[axis_index] = indices.get_shape().elements();
-                    migraphx::shape out_comp_shape{data.get_shape().type(), out_lens};
-                    shape_for_each(out_comp_shape, [&](const auto& out_idx) {
-                        auto data_idx        = out_idx;
-                        auto in_index        = indices[data_idx[axis_index]];
-                        in_index             = (in_index < 0) ? in_index + axis_dim_size : in_index;
-                        data_idx[axis_index] = in_index;
-                        output[out_comp_shape.index(out_idx.begin(), out_idx.end())] =
-                            data(data_idx.begin(), data_idx.end());
+                    std::vector<std::size_t> ind(indices.get_shape().elements());
+                    std::transform(indices.strided_begin(),
+                                   indices.strided_end(),
+                                   ind.begin(),
+                                   [&](auto i) { return (i < 0) ? i + axis_dim_size : i; });
+                    // The output is written in order a row of the last dimension at a
+                    // time, so the offset into the data is only computed once per row
+                    auto n          = out_lens.back();
+                    auto stride     = data.get_shape().strides().back();
+                    bool last_axis  = static_cast<std::size_t>(axis_index) + 1 == out_lens.size();
+                    auto row_lens   = out_lens;
+                    row_lens.back() = 1;
+                    auto out        = output.strided_begin();
+                    shape_for_each(shape{output_shape.type(), row_lens}, [&](const auto& out_idx) {
+                        auto data_idx = out_idx;
+                        if(last_axis)
+                        {
+                            data_idx[axis_index] = 0;
+                            auto* x              = &data(data_idx.begin(), data_idx.end());
+                            for(std::size_t i = 0; i < n; i++, ++out)
+                                *out = x[ind[i] * stride];
+                        }
+                        else
+                        {
+                            data_idx[axis_index] = ind[data_idx[axis_index]];
+                            auto* x              = &data(data_idx.begin(), data_idx.end());
+                            for(std::size_t i = 0; i < n; i++, ++out)
+                                *out = x[i * stride];
+                        }
                     });
                 }
             });
         });
-
-        return result;
     }
 };
 
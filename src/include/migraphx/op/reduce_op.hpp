@@ -135,6 +135,15 @@ struct reduce_op : op_name<Derived>
     argument compute(const shape& output_shape, std::vector<argument> args) const
     {
         argument result{output_shape};
+        compute_to(result, args);
+        return result;
+    }
+
+    /// Write the result to `result`, which was allocated for the output shape
+    void compute_to(const argument& result, const std::vector<argument>& args) const
+    {
+        const auto& output_shape = result.get_shape();
+
         auto arg_lens   = args.front().get_shape().lens();
         auto tuned_axes = tune_axes(arg_lens.size());
         std::vector<std::size_t> batch_lens(output_shape.lens().size(), 1);
@@ -146,8 +155,6 @@ struct reduce_op : op_name<Derived>
                 this->reduce(input, batch_shape, tuned_axes, out_idx, output);
             });
         });
-
-        return result;
     }
 
     auto init() const { return zero(); }
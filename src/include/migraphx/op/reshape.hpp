@@ -68,7 +68,7 @@ struct reshape
 
     argument compute(shape output_shape, std::vector<argument> args) const
     {
-        return {std::move(output_shape), std::move(args.front().data)};
+        return args.front().reshape(output_shape);
     }
 
     std::ptrdiff_t output_alias(const std::vector<shape>&) const { return 0; }
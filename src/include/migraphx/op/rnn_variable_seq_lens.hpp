@@ -37,6 +37,15 @@ struct rnn_var_sl_shift_output
     argument compute(const shape& output_shape, std::vector<argument> args) const
     {
         argument result{output_shape};
+        compute_to(result, args);
+        return result;
+    }
+
+    /// Write the result to `result`, which was allocated for the output shape
+    void compute_to(const argument& result, const std::vector<argument>& args) const
+    {
+        const auto& output_shape = result.get_shape();
+
         int64_t max_len = static_cast<int64_t>(output_shape.lens()[0]);
         visit_all(result, args[0])([&](auto output, auto input) {
             using value_type = typename decltype(output)::value_type;
@@ -59,8 +68,6 @@ struct rnn_var_sl_shift_output
                 });
             });
         });
-
-        return result;
     }
 };
 
@@ -76,6 +83,15 @@ struct rnn_var_sl_shift_sequence
     argument compute(const shape& output_shape, std::vector<argument> args) const
     {
         argument result{output_shape};
+        compute_to(result, args);
+        return result;
+    }
+
+    /// Write the result to `result`, which was allocated for the output shape
+    void compute_to(const argument& result, const std::vector<argument>& args) const
+    {
+        const auto& output_shape = result.get_shape();
+
         int64_t max_len = static_cast<int64_t>(output_shape.lens()[0]);
         visit_all(result, args[0])([&](auto output, auto input) {
             using value_type = typename decltype(output)::value_type;
@@ -96,8 +112,6 @@ struct rnn_var_sl_shift_sequence
                 });
             });
         });
-
-        return result;
     }
 };
 
@@ -30,8 +30,16 @@ struct unary : op_name<Derived>
     argument compute(const shape& output_shape, std::vector<argument> args) const
     {
         argument result{output_shape};
-        auto in_shape = args[0].get_shape();
-        if(in_shape.packed())
+        compute_to(result, args);
+        return result;
+    }
+
+    /// Write the result to `result`, which was allocated for the output shape
+    void compute_to(const argument& result, const std::vector<argument>& args) const
+    {
+        const auto& output_shape = result.get_shape();
+        auto in_shape            = args[0].get_shape();
+        if(in_shape.packed() and in_shape.strides() == output_shape.strides())
         {
             shape std_in_shape{in_shape.type(), in_shape.lens()};
             shape std_out_shape{output_shape.type(), output_shape.lens()};
@@ -58,8 +66,6 @@ struct unary : op_name<Derived>
                 });
             });
         }
-
-        return result;
     }
 };
 
@@ -734,6 +734,10 @@ bool has_finalize(const T& x)
     return detail::has_finalize_op(x);
 }
 
+/// Operators used as attributes of other operators are stored with their name
+void migraphx_to_value(value& v, const operation& op);
+void migraphx_from_value(const value& v, operation& op);
+
 #endif
 
 } // namespace MIGRAPHX_INLINE_NS
@@ -17,7 +17,13 @@
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
 
-void run_passes(program& prog, const std::vector<pass>& passes, tracer trace = tracer{});
+struct compile_profiler;
+
+/// Run the passes on the program, and record their cost in `profiler` when it is set
+void run_passes(program& prog,
+                const std::vector<pass>& passes,
+                tracer trace               = tracer{},
+                compile_profiler* profiler = nullptr);
 
 } // namespace MIGRAPHX_INLINE_NS
 } // namespace migraphx
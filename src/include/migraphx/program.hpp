@@ -116,6 +116,16 @@ struct program
 
     void finalize();
 
+    /// Serialize the instructions and the target the program was compiled
+    /// for, where `store_literal` converts the data of each literal
+    value to_value(const std::function<value(const literal&)>& store_literal) const;
+    value to_value() const;
+
+    /// Rebuild the program from `to_value`, which is finalized for its target
+    /// when it was compiled
+    void from_value(const value& v, const std::function<literal(const value&)>& load_literal);
+    void from_value(const value& v);
+
     void perf_report(std::ostream& os, std::size_t n, parameter_map params) const;
 
     void debug_print() const;
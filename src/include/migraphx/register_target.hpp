@@ -0,0 +1,55 @@
+#ifndef MIGRAPHX_GUARD_RTGLIB_REGISTER_TARGET_HPP
+#define MIGRAPHX_GUARD_RTGLIB_REGISTER_TARGET_HPP
+
+#include <migraphx/config.hpp>
+#include <migraphx/target.hpp>
+#include <string>
+#include <vector>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+
+void register_target(const target& t);
+target make_target(const std::string& name);
+std::vector<std::string> get_targets();
+
+template <class T>
+int register_target()
+{
+    register_target(T{});
+    return 0;
+}
+
+template <class T>
+struct auto_register_target
+{
+    static int static_register;
+    // This typedef ensures that the static member will be instantiated if
+    // the class itself is instantiated
+    using static_register_type =
+        std::integral_constant<decltype(&static_register), &static_register>;
+};
+
+#ifdef __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wglobal-constructors"
+#endif
+
+template <class T>
+int auto_register_target<T>::static_register = register_target<T>(); // NOLINT
+
+#ifdef __clang__
+#pragma clang diagnostic pop
+#endif
+
+#define MIGRAPHX_REGISTER_TARGET_NAME_DETAIL(x) migraphx_auto_register_target_##x
+#define MIGRAPHX_REGISTER_TARGET_NAME(x) MIGRAPHX_REGISTER_TARGET_NAME_DETAIL(x)
+#define MIGRAPHX_REGISTER_TARGET(...)                                                     \
+    void MIGRAPHX_REGISTER_TARGET_NAME(__LINE__)(                                         \
+        migraphx::auto_register_target<__VA_ARGS__> x =                                  \
+            migraphx::auto_register_target<__VA_ARGS__>{}) __attribute__((unused));
+
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+
+#endif
@@ -114,6 +114,13 @@ auto to_value_impl(rank<11>, const T& x)
 template <class T, MIGRAPHX_REQUIRES(std::is_empty<T>{})>
 void from_value_impl(rank<0>, const value& v, T& x)
 {
+    // msgpack from before empty objects were packed as maps loads them as
+    // empty arrays
+    if(v.is_array() and v.empty())
+    {
+        x = T{};
+        return;
+    }
     if(not v.is_object())
         MIGRAPHX_THROW("Expected an object");
     if(not v.get_object().empty())
@@ -12,20 +12,29 @@ template <class F>
 void shape_for_each(const migraphx::shape& s, F f)
 {
     // Ensure calls to f use const ref to vector
-    auto call = [&f](const std::vector<std::size_t>& i) { f(i); };
-    std::vector<std::size_t> indices(s.lens().size());
-    shape ss{s.type(), s.lens()};
-    for(std::size_t i = 0; i < ss.elements(); i++)
+    auto call          = [&f](const std::vector<std::size_t>& i) { f(i); };
+    const auto& lens   = s.lens();
+    const auto n       = s.elements();
+    const auto ndim    = lens.size();
+    const auto row_len = ndim == 0 ? 1 : lens.back();
+    std::vector<std::size_t> indices(ndim);
+    std::size_t i = 0;
+    while(i < n)
     {
-        std::transform(ss.strides().begin(),
-                       ss.strides().end(),
-                       ss.lens().begin(),
-                       indices.begin(),
-                       [&](std::size_t stride, std::size_t len) {
-                           assert(len > 0 and stride > 0);
-                           return (i / stride) % len;
-                       });
-        call(indices);
+        // Walk the last dimension, then carry into the earlier dimensions
+        // like an odometer
+        for(std::size_t j = 0; j < row_len; j++, i++)
+        {
+            if(ndim > 0)
+                indices.back() = j;
+            call(indices);
+        }
+        for(std::size_t d = ndim; d > 1; d--)
+        {
+            if(++indices[d - 2] < lens[d - 2])
+                break;
+            indices[d - 2] = 0;
+        }
     }
 }
 
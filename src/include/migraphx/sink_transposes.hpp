@@ -0,0 +1,27 @@
+#ifndef MIGRAPHX_GUARD_RTGLIB_SINK_TRANSPOSES_HPP
+#define MIGRAPHX_GUARD_RTGLIB_SINK_TRANSPOSES_HPP
+
+#include <string>
+#include <migraphx/config.hpp>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+
+struct program;
+
+/**
+ * Move transposes past the elementwise operators, reductions, softmax and
+ * concat that read them, remapping the axes of the operators, so transposes
+ * that undo each other meet and are removed by simplify_reshapes instead of
+ * being copied by auto_contiguous.
+ */
+struct sink_transposes
+{
+    std::string name() const { return "sink_transposes"; }
+    void apply(program& p) const;
+};
+
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+
+#endif
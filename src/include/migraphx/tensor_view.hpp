@@ -6,7 +6,10 @@
 #include <migraphx/requires.hpp>
 #include <migraphx/config.hpp>
 
+#include <algorithm>
 #include <iostream>
+#include <iterator>
+#include <type_traits>
 #include <utility>
 
 namespace migraphx {
@@ -20,6 +23,136 @@ T as_number(T x)
 inline int32_t as_number(int8_t x) { return static_cast<int32_t>(x); }
 inline uint32_t as_number(uint8_t x) { return static_cast<uint32_t>(x); }
 
+/**
+ * A random access iterator over the elements of a tensor in the order of
+ * its indices, which also works for tensors that are not standard. Stepping
+ * along the last dimension only adds its stride, so the offset is only
+ * recomputed from the shape when the iterator moves to the next row. The
+ * iterator holds its own copy of the shape, which shares the lens and strides
+ * with the view, so it stays valid after a temporary view is destroyed.
+ */
+template <class T>
+struct tensor_view_iterator
+{
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type        = std::remove_cv_t<T>;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = T*;
+    using reference         = T&;
+
+    tensor_view_iterator() = default;
+    tensor_view_iterator(T* d, const shape& s, std::size_t i) : m_data(d), m_shape(s)
+    {
+        if(not s.lens().empty())
+        {
+            m_row_len    = s.lens().back();
+            m_row_stride = s.strides().back();
+        }
+        this->seek(i);
+    }
+
+    reference operator*() const { return m_data[m_offset]; }
+    pointer operator->() const { return m_data + m_offset; }
+    reference operator[](difference_type n) const { return *(*this + n); }
+
+    tensor_view_iterator& operator++()
+    {
+        m_index++;
+        if(++m_col < m_row_len)
+            m_offset += m_row_stride;
+        else
+            this->seek(m_index);
+        return *this;
+    }
+
+    tensor_view_iterator operator++(int)
+    {
+        auto result = *this;
+        ++(*this);
+        return result;
+    }
+
+    tensor_view_iterator& operator--()
+    {
+        this->seek(m_index - 1);
+        return *this;
+    }
+
+    tensor_view_iterator operator--(int)
+    {
+        auto result = *this;
+        --(*this);
+        return result;
+    }
+
+    tensor_view_iterator& operator+=(difference_type n)
+    {
+        this->seek(m_index + n);
+        return *this;
+    }
+
+    tensor_view_iterator& operator-=(difference_type n) { return *this += -n; }
+
+    friend tensor_view_iterator operator+(tensor_view_iterator x, difference_type n)
+    {
+        return x += n;
+    }
+    friend tensor_view_iterator operator+(difference_type n, tensor_view_iterator x)
+    {
+        return x += n;
+    }
+    friend tensor_view_iterator operator-(tensor_view_iterator x, difference_type n)
+    {
+        return x -= n;
+    }
+    friend difference_type operator-(const tensor_view_iterator& x, const tensor_view_iterator& y)
+    {
+        return difference_type(x.m_index) - difference_type(y.m_index);
+    }
+
+    friend bool operator==(const tensor_view_iterator& x, const tensor_view_iterator& y)
+    {
+        return x.m_index == y.m_index;
+    }
+    friend bool operator!=(const tensor_view_iterator& x, const tensor_view_iterator& y)
+    {
+        return x.m_index != y.m_index;
+    }
+    friend bool operator<(const tensor_view_iterator& x, const tensor_view_iterator& y)
+    {
+        return x.m_index < y.m_index;
+    }
+    friend bool operator>(const tensor_view_iterator& x, const tensor_view_iterator& y)
+    {
+        return y < x;
+    }
+    friend bool operator<=(const tensor_view_iterator& x, const tensor_view_iterator& y)
+    {
+        return not(y < x);
+    }
+    friend bool operator>=(const tensor_view_iterator& x, const tensor_view_iterator& y)
+    {
+        return not(x < y);
+    }
+
+    private:
+    void seek(std::size_t i)
+    {
+        m_index = i;
+        m_col   = m_row_len == 0 ? 0 : i % m_row_len;
+        // The end of the tensor is never dereferenced
+        m_offset = i < m_shape.elements() ? m_shape.index(i) : 0;
+    }
+
+    T* m_data                = nullptr;
+    shape m_shape            = {};
+    std::size_t m_index      = 0;
+    std::size_t m_col        = 0;
+    std::size_t m_offset     = 0;
+    std::size_t m_row_len    = 1;
+    std::size_t m_row_stride = 0;
+};
+
 template <class T>
 struct tensor_view
 {
@@ -105,7 +238,6 @@ struct tensor_view
         return m_data[m_shape.index(this->size() - 1)];
     }
 
-    // TODO: Add iterators so it can handle nonstandard tensors
     T* begin()
     {
         assert(this->m_shape.standard() or this->empty());
@@ -136,20 +268,31 @@ struct tensor_view
             return m_data + this->size();
     }
 
+    /// Iterate the elements in the order of their indices for any shape
+    tensor_view_iterator<T> strided_begin() const { return {m_data, m_shape, 0}; }
+
+    tensor_view_iterator<T> strided_end() const
+    {
+        return {m_data, m_shape, this->empty() ? 0 : this->size()};
+    }
+
     template <class U = T>
     std::vector<U> to_vector() const
     {
-        return std::vector<U>(this->begin(), this->end());
+        if(this->m_shape.standard())
+            return std::vector<U>(this->begin(), this->end());
+        return std::vector<U>(this->strided_begin(), this->strided_end());
     }
 
     friend std::ostream& operator<<(std::ostream& os, const tensor_view<T>& x)
     {
         if(!x.empty())
         {
-            os << as_number(x.front());
-            for(std::size_t i = 1; i < x.m_shape.elements(); i++)
+            auto it = x.strided_begin();
+            os << as_number(*it);
+            for(++it; it != x.strided_end(); ++it)
             {
-                os << ", " << as_number(x.m_data[x.m_shape.index(i)]);
+                os << ", " << as_number(*it);
             }
         }
         return os;
@@ -165,12 +308,10 @@ bool operator==(const tensor_view<T>& x, const tensor_view<U>& y)
 {
     if(x.get_shape() == y.get_shape())
     {
-        for(std::size_t i = 0; i < x.get_shape().elements(); i++)
-        {
-            if(!float_equal(x[i], y[i]))
-                return false;
-        }
-        return true;
+        return std::equal(x.strided_begin(),
+                          x.strided_end(),
+                          y.strided_begin(),
+                          [](const auto& a, const auto& b) { return float_equal(a, b); });
     }
     return false;
 }
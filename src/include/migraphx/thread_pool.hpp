@@ -0,0 +1,49 @@
+#ifndef MIGRAPHX_GUARD_RTGLIB_THREAD_POOL_HPP
+#define MIGRAPHX_GUARD_RTGLIB_THREAD_POOL_HPP
+
+#include <migraphx/env.hpp>
+#include <migraphx/config.hpp>
+#include <functional>
+#include <memory>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+
+MIGRAPHX_DECLARE_ENV_VAR(MIGRAPHX_CPU_THREADS)
+MIGRAPHX_DECLARE_ENV_VAR(MIGRAPHX_CPU_AFFINITY)
+
+struct thread_pool_impl;
+
+/**
+ * @brief A persistent pool of worker threads
+ *
+ * Each worker owns a queue of tasks and steals from the other queues when its
+ * own queue is empty. The thread calling `run` takes part in the work until
+ * all of its tasks are finished, so nested calls to `run` do not deadlock.
+ */
+struct thread_pool
+{
+    /// Create a pool where `nthreads` threads (including the caller) run tasks
+    explicit thread_pool(std::size_t nthreads, bool pin = false);
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+    ~thread_pool();
+
+    /// Number of threads that can run tasks concurrently, including the caller
+    std::size_t size() const;
+
+    /// Run `f(i)` for every `i` in `[0, n)` and wait for all of them to finish
+    void run(std::size_t n, const std::function<void(std::size_t)>& f);
+
+    private:
+    std::unique_ptr<thread_pool_impl> impl;
+};
+
+/// The process-wide pool, sized by `MIGRAPHX_CPU_THREADS` and pinned to cores
+/// when `MIGRAPHX_CPU_AFFINITY` is enabled
+thread_pool& get_thread_pool();
+
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+
+#endif
@@ -94,13 +94,46 @@ To try_convert_value(const From& x)
 
 struct value
 {
+    /**
+     * @brief Raw bytes, such as the data of a tensor
+     *
+     * The bytes are kept in a shared buffer, so copies of the value do not
+     * copy the data, and the buffer can be owned by something else, such as
+     * the message it was decoded from.
+     */
+    struct binary
+    {
+        binary() = default;
+        /// Copy `n` bytes from `x`
+        binary(const void* x, std::size_t n);
+        /// Use the bytes in `x` without a copy, which are kept alive by the binary
+        binary(std::shared_ptr<const char> x, std::size_t n) : buffer(std::move(x)), m_size(n) {}
+
+        const char* data() const { return buffer.get(); }
+        std::size_t size() const { return m_size; }
+        bool empty() const { return m_size == 0; }
+        const char* begin() const { return data(); }
+        const char* end() const { return data() + size(); }
+        /// The buffer holding the bytes
+        const std::shared_ptr<const char>& share() const { return buffer; }
+
+        friend bool operator==(const binary& x, const binary& y);
+        friend bool operator!=(const binary& x, const binary& y);
+        friend bool operator<(const binary& x, const binary& y);
+
+        private:
+        std::shared_ptr<const char> buffer = nullptr;
+        std::size_t m_size                 = 0;
+    };
+
 // clang-format off
 #define MIGRAPHX_VISIT_VALUE_TYPES(m) \
     m(int64, std::int64_t) \
     m(uint64, std::uint64_t) \
     m(float, double) \
     m(string, std::string) \
-    m(bool, bool)
+    m(bool, bool) \
+    m(binary, value::binary)
     // clang-format on
     enum type_t
     {
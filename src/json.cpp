@@ -56,6 +56,56 @@ void value_to_json(const std::vector<value>& x, json& j)
 
 void value_to_json(std::nullptr_t&, json& j) { j = {}; }
 
+// Binary data is written as an object whose only key is "@binary", with the
+// bytes encoded as a hex string
+const std::string json_binary_key = "@binary";
+
+void value_to_json(const value::binary& x, json& j)
+{
+    const char* digits = "0123456789abcdef";
+    std::string hex(x.size() * 2, '0');
+    for(std::size_t i = 0; i < x.size(); i++)
+    {
+        auto byte      = static_cast<unsigned char>(x.data()[i]);
+        hex[2 * i]     = digits[byte >> 4u];
+        hex[2 * i + 1] = digits[byte & 0xfu];
+    }
+    j = json::object({{json_binary_key, hex}});
+}
+
+static bool is_json_binary(const json& j)
+{
+    return j.is_object() and j.size() == 1 and j.contains(json_binary_key) and
+           j.at(json_binary_key).is_string();
+}
+
+static int from_hex_digit(char c)
+{
+    if(c >= '0' and c <= '9')
+        return c - '0';
+    if(c >= 'a' and c <= 'f')
+        return c - 'a' + 10;
+    if(c >= 'A' and c <= 'F')
+        return c - 'A' + 10;
+    MIGRAPHX_THROW("Convert JSON to Value: invalid hex digit in binary data");
+}
+
+static value json_to_binary(const json& j)
+{
+    if(j.is_binary())
+    {
+        const auto& b = j.get_binary();
+        return value::binary{b.data(), b.size()};
+    }
+    const auto& hex = j.at(json_binary_key).get_ref<const std::string&>();
+    if(hex.size() % 2 != 0)
+        MIGRAPHX_THROW("Convert JSON to Value: binary data has an odd number of hex digits");
+    std::vector<char> b(hex.size() / 2);
+    for(std::size_t i = 0; i < b.size(); i++)
+        b[i] = static_cast<char>(from_hex_digit(hex[2 * i]) * 16 + from_hex_digit(hex[2 * i + 1]));
+    return value::binary{b.data(), b.size()};
+}
+
 void value_to_json(const value& val, json& j)
 {
     if(val.is_array())
@@ -97,6 +147,11 @@ migraphx::value value_from_json(const json& j)
         break;
 
     case json::value_t::object:
+        if(is_json_binary(j))
+        {
+            val = json_to_binary(j);
+            break;
+        }
         val = migraphx::value::object{};
         for(const auto& item : j.items())
         {
@@ -106,7 +161,7 @@ migraphx::value value_from_json(const json& j)
         }
         break;
 
-    case json::value_t::binary: MIGRAPHX_THROW("Convert JSON to Value: binary type not supported!");
+    case json::value_t::binary: val = json_to_binary(j); break;
     case json::value_t::discarded:
         MIGRAPHX_THROW("Convert JSON to Value: discarded type not supported!");
     }
@@ -0,0 +1,112 @@
+#include <migraphx/load_save.hpp>
+#include <migraphx/file_buffer.hpp>
+#include <migraphx/msgpack.hpp>
+#include <migraphx/serialize.hpp>
+#include <migraphx/errors.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+
+// The file starts with the magic, the version and the size of the msgpack
+// header, then the data of the literals follows at aligned offsets
+const char file_magic[8]           = {'M', 'I', 'G', 'R', 'A', 'P', 'H', 'X'};
+const std::uint64_t file_version   = 1;
+const std::size_t file_prefix_size = sizeof(file_magic) + 2 * sizeof(std::uint64_t);
+const std::size_t file_alignment   = 64;
+
+static std::size_t align_to(std::size_t n, std::size_t alignment)
+{
+    return (n + alignment - 1) / alignment * alignment;
+}
+
+static void write_u64(std::ostream& os, std::uint64_t x)
+{
+    os.write(reinterpret_cast<const char*>(&x), sizeof(x));
+}
+
+static std::uint64_t read_u64(const char* p)
+{
+    std::uint64_t x = 0;
+    std::memcpy(&x, p, sizeof(x));
+    return x;
+}
+
+static void write_padding(std::ostream& os, std::size_t& pos, std::size_t alignment)
+{
+    auto n = align_to(pos, alignment) - pos;
+    std::fill_n(std::ostreambuf_iterator<char>(os), n, 0);
+    pos += n;
+}
+
+void save(const program& p, const std::string& filename)
+{
+    std::vector<literal> literals;
+    std::size_t data_size = 0;
+    auto v                = p.to_value([&](const literal& l) {
+        data_size = align_to(data_size, file_alignment);
+        value result;
+        result["shape"]  = migraphx::to_value(l.get_shape());
+        result["offset"] = data_size;
+        data_size += l.get_shape().bytes();
+        literals.push_back(l);
+        return result;
+    });
+    auto header = to_msgpack(v);
+
+    std::ofstream os(filename, std::ios::binary);
+    if(not os)
+        MIGRAPHX_THROW("Failed to open file for writing: " + filename);
+    os.write(file_magic, sizeof(file_magic));
+    write_u64(os, file_version);
+    write_u64(os, header.size());
+    os.write(header.data(), header.size());
+    std::size_t pos = file_prefix_size + header.size();
+    write_padding(os, pos, file_alignment);
+    std::size_t data_pos = 0;
+    for(auto&& l : literals)
+    {
+        write_padding(os, data_pos, file_alignment);
+        os.write(l.data(), l.get_shape().bytes());
+        data_pos += l.get_shape().bytes();
+    }
+    if(not os)
+        MIGRAPHX_THROW("Failed to write file: " + filename);
+}
+
+program load(const std::string& filename)
+{
+    std::size_t size = 0;
+    auto file        = map_file(filename, size);
+    if(size < file_prefix_size)
+        MIGRAPHX_THROW("Invalid program file: " + filename);
+    if(not std::equal(file_magic, file_magic + sizeof(file_magic), file.get()))
+        MIGRAPHX_THROW("Not a program file: " + filename);
+    auto version = read_u64(file.get() + sizeof(file_magic));
+    if(version != file_version)
+        MIGRAPHX_THROW("Unsupported program file version: " + std::to_string(version));
+    auto header_size = read_u64(file.get() + sizeof(file_magic) + sizeof(std::uint64_t));
+    if(header_size > size - file_prefix_size)
+        MIGRAPHX_THROW("Invalid program file: " + filename);
+    auto v = from_msgpack(std::shared_ptr<const char>(file, file.get() + file_prefix_size),
+                          header_size);
+    auto data_offset = align_to(file_prefix_size + header_size, file_alignment);
+
+    program p;
+    p.from_value(v, [&](const value& lv) {
+        auto s      = migraphx::from_value<shape>(lv.at("shape"));
+        auto offset = data_offset + lv.at("offset").without_key().to<std::size_t>();
+        if(offset > size or s.bytes() > size - offset)
+            MIGRAPHX_THROW("Literal is outside of the program file: " + filename);
+        // The literal shares ownership of the mapping
+        return literal{s, std::shared_ptr<char>(file, file.get() + offset)};
+    });
+    return p;
+}
+
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
@@ -7,74 +7,6 @@ MSGPACK_API_VERSION_NAMESPACE(MSGPACK_DEFAULT_API_NS)
 {
     namespace adaptor {
 
-    template <>
-    struct convert<migraphx::value>
-    {
-        const msgpack::object& operator()(const msgpack::object& o, migraphx::value& v) const
-        {
-            switch(o.type)
-            {
-            case msgpack::type::NIL:
-            {
-                v = nullptr;
-                break;
-            }
-            case msgpack::type::BOOLEAN:
-            {
-                v = o.as<bool>();
-                break;
-            }
-            case msgpack::type::POSITIVE_INTEGER:
-            {
-                v = o.as<std::uint64_t>();
-                break;
-            }
-            case msgpack::type::NEGATIVE_INTEGER:
-            {
-                v = o.as<std::int64_t>();
-                break;
-            }
-            case msgpack::type::FLOAT32:
-            case msgpack::type::FLOAT64:
-            {
-                v = o.as<double>();
-                break;
-            }
-            case msgpack::type::STR:
-            {
-                v = o.as<std::string>();
-                break;
-            }
-            case msgpack::type::BIN: { MIGRAPHX_THROW("msgpack BIN type not supported.");
-            }
-            case msgpack::type::ARRAY:
-            {
-                migraphx::value r = migraphx::value::array{};
-                std::for_each(
-                    o.via.array.ptr,
-                    o.via.array.ptr + o.via.array.size,
-                    [&](const msgpack::object& so) { r.push_back(so.as<migraphx::value>()); });
-                v = r;
-                break;
-            }
-            case msgpack::type::MAP:
-            {
-                migraphx::value r = migraphx::value::object{};
-                std::for_each(o.via.map.ptr,
-                              o.via.map.ptr + o.via.map.size,
-                              [&](const msgpack::object_kv& p) {
-                                  r[p.key.as<std::string>()] = p.val.as<migraphx::value>();
-                              });
-                v = r;
-                break;
-            }
-            case msgpack::type::EXT: { MIGRAPHX_THROW("msgpack EXT type not supported.");
-            }
-            }
-            return o;
-        }
-    };
-
     template <>
     struct pack<migraphx::value>
     {
@@ -89,6 +21,12 @@ MSGPACK_API_VERSION_NAMESPACE(MSGPACK_DEFAULT_API_NS)
             o.pack(x);
         }
         template <class Stream>
+        void write(msgpack::packer<Stream>& o, const migraphx::value::binary& x) const
+        {
+            o.pack_bin(x.size());
+            o.pack_bin_body(x.data(), x.size());
+        }
+        template <class Stream>
         void write(msgpack::packer<Stream>& o, const std::vector<migraphx::value>& v) const
         {
             if(v.empty())
@@ -117,6 +55,12 @@ MSGPACK_API_VERSION_NAMESPACE(MSGPACK_DEFAULT_API_NS)
         template <class Stream>
         packer<Stream>& operator()(msgpack::packer<Stream>& o, const migraphx::value& v) const
         {
+            // An empty object would be packed as an empty array otherwise
+            if(v.is_object() and v.empty())
+            {
+                o.pack_map(0);
+                return o;
+            }
             v.visit([&](auto&& x) { this->write(o, x); });
             return o;
         }
@@ -145,10 +89,78 @@ std::vector<char> to_msgpack(const value& v)
     msgpack::pack(vs, v);
     return vs.buffer;
 }
+
+// The bytes of BIN objects are referenced by the object instead of copied when
+// the buffer is kept alive by `owner`
+struct msgpack_buffer
+{
+    std::shared_ptr<const char> owner = nullptr;
+    const char* first                 = nullptr;
+    const char* last                  = nullptr;
+
+    bool contains(const char* p) const { return owner != nullptr and p >= first and p < last; }
+};
+
+static value from_msgpack_object(const msgpack::object& o, const msgpack_buffer& b)
+{
+    switch(o.type)
+    {
+    case msgpack::type::NIL: return nullptr;
+    case msgpack::type::BOOLEAN: return o.as<bool>();
+    case msgpack::type::POSITIVE_INTEGER: return o.as<std::uint64_t>();
+    case msgpack::type::NEGATIVE_INTEGER: return o.as<std::int64_t>();
+    case msgpack::type::FLOAT32:
+    case msgpack::type::FLOAT64: return o.as<double>();
+    case msgpack::type::STR: return o.as<std::string>();
+    case msgpack::type::BIN:
+    {
+        const char* data = o.via.bin.ptr;
+        if(b.contains(data))
+            return value::binary{std::shared_ptr<const char>(b.owner, data), o.via.bin.size};
+        return value::binary{data, o.via.bin.size};
+    }
+    case msgpack::type::ARRAY:
+    {
+        value r = value::array{};
+        std::for_each(o.via.array.ptr,
+                      o.via.array.ptr + o.via.array.size,
+                      [&](const msgpack::object& so) { r.push_back(from_msgpack_object(so, b)); });
+        return r;
+    }
+    case msgpack::type::MAP:
+    {
+        value r = value::object{};
+        std::for_each(o.via.map.ptr,
+                      o.via.map.ptr + o.via.map.size,
+                      [&](const msgpack::object_kv& p) {
+                          r[p.key.as<std::string>()] = from_msgpack_object(p.val, b);
+                      });
+        return r;
+    }
+    case msgpack::type::EXT: MIGRAPHX_THROW("msgpack EXT type not supported.");
+    }
+    MIGRAPHX_THROW("Unknown msgpack type");
+}
+
+static bool reference_bin(msgpack::type::object_type t, std::size_t, void*)
+{
+    return t == msgpack::type::BIN;
+}
+
+value from_msgpack(const char* buffer, std::size_t size)
+{
+    msgpack::object_handle oh = msgpack::unpack(buffer, size);
+    return from_msgpack_object(oh.get(), {});
+}
 value from_msgpack(const std::vector<char>& buffer)
 {
-    msgpack::object_handle oh = msgpack::unpack(buffer.data(), buffer.size());
-    return oh.get().as<value>();
+    return from_msgpack(buffer.data(), buffer.size());
+}
+value from_msgpack(std::shared_ptr<const char> buffer, std::size_t size)
+{
+    msgpack::object_handle oh = msgpack::unpack(buffer.get(), size, &reference_bin);
+    msgpack_buffer b{buffer, buffer.get(), buffer.get() + size};
+    return from_msgpack_object(oh.get(), b);
 }
 
 } // namespace MIGRAPHX_INLINE_NS
@@ -6,8 +6,10 @@
 #include <unordered_map>
 #include <functional>
 #include <array>
+#include <cstdint>
 #include <utility>
 #include <vector>
+#include <stdexcept>
 
 #include <migraphx/fallthrough.hpp>
 #include <migraphx/program.hpp>
@@ -16,6 +18,8 @@
 #include <migraphx/instruction.hpp>
 #include <migraphx/config.hpp>
 #include <migraphx/onnx.hpp>
+#include <migraphx/file_buffer.hpp>
+#include <migraphx/make_shared_array.hpp>
 #include <migraphx/pad_calc.hpp>
 #include <migraphx/type_traits.hpp>
 #include <migraphx/float_equal.hpp>
@@ -43,6 +47,12 @@ struct onnx_parser
     std::size_t default_dim_value = 1;
     std::unordered_map<std::string, std::vector<std::size_t>> map_input_dims;
     bool skip_unknown_operators = false;
+    bool use_mmap               = false;
+    // The directory of the onnx file with a trailing separator, which the locations of external
+    // data are relative to
+    std::string path;
+    // Files with external data that are already mapped, with their sizes
+    std::unordered_map<std::string, std::pair<std::shared_ptr<char>, std::size_t>> mapped_files;
 
     std::unordered_map<std::string, op_func> ops;
     std::unordered_map<std::string, operation> map_actv_funcs;
@@ -2373,7 +2383,7 @@ struct onnx_parser
         {
             if(model.has_graph())
             {
-                this->parse_graph(model.graph());
+                this->parse_graph(*model.mutable_graph());
             }
         }
         else
@@ -2389,7 +2399,7 @@ struct onnx_parser
         {
             if(model.has_graph())
             {
-                this->parse_graph(model.graph());
+                this->parse_graph(*model.mutable_graph());
             }
         }
         else
@@ -2398,10 +2408,10 @@ struct onnx_parser
         }
     }
 
-    void parse_graph(const onnx::GraphProto& graph)
+    void parse_graph(onnx::GraphProto& graph)
     {
-        for(auto&& f : graph.initializer())
-            instructions[f.name()] = prog.add_literal(parse_tensor(f));
+        for(auto&& f : *graph.mutable_initializer())
+            instructions[f.name()] = prog.add_literal(parse_initializer(f));
 
         for(auto&& input : graph.input())
         {
@@ -2527,34 +2537,129 @@ struct onnx_parser
         MIGRAPHX_THROW("Invalid attribute type");
     }
 
-    static literal parse_tensor(const onnx::TensorProto& t)
+    // The type of the elements of a tensor stored as raw bytes
+    static shape::type_t get_raw_type(const onnx::TensorProto& t)
+    {
+        switch(t.data_type())
+        {
+        case onnx::TensorProto::FLOAT: return shape::float_type;
+        case onnx::TensorProto::FLOAT16: return shape::half_type;
+        case onnx::TensorProto::DOUBLE: return shape::double_type;
+        case onnx::TensorProto::INT64: return shape::int64_type;
+        case onnx::TensorProto::INT8:
+        case onnx::TensorProto::UINT16:
+        case onnx::TensorProto::INT16: return shape::int16_type;
+        case onnx::TensorProto::INT32:
+        case onnx::TensorProto::BOOL: return shape::int32_type;
+        case onnx::TensorProto::UINT8:
+        case onnx::TensorProto::STRING:
+        case onnx::TensorProto::UNDEFINED:
+        case onnx::TensorProto::UINT32:
+        case onnx::TensorProto::UINT64:
+        case onnx::TensorProto::COMPLEX64:
+        case onnx::TensorProto::COMPLEX128: throw std::runtime_error("");
+        }
+        MIGRAPHX_THROW("Invalid tensor type");
+    }
+
+    static shape get_raw_shape(const onnx::TensorProto& t)
     {
         std::vector<std::size_t> dims(t.dims().begin(), t.dims().end());
-        if(t.has_raw_data())
+        // in case of scalar constants in onnx file, use dims=1 to fill initializer data
+        if(dims.empty())
+            return {get_raw_type(t)};
+        return {get_raw_type(t), dims};
+    }
+
+    // Initializers take the raw bytes from the message, or use the external data,
+    // instead of copying them
+    literal parse_initializer(onnx::TensorProto& t)
+    {
+        if(t.data_location() == onnx::TensorProto::EXTERNAL)
+            return parse_external_data(t);
+        if(not t.has_raw_data())
+            return parse_tensor(t);
+        auto s = get_raw_shape(t);
+        check_raw_data(t, s);
+        std::shared_ptr<std::string> data(t.release_raw_data());
+        return literal{s, std::shared_ptr<char>(data, &(*data)[0])};
+    }
+
+    static void check_raw_data(const onnx::TensorProto& t, const shape& s)
+    {
+        if(t.raw_data().size() != s.bytes())
+            MIGRAPHX_THROW("Raw data of " + std::to_string(t.raw_data().size()) +
+                           " bytes does not match the shape of tensor " + t.name());
+    }
+
+    static std::size_t parse_external_size(const onnx::TensorProto& t, const std::string& x)
+    {
+        // stoull would accept whitespace and a sign
+        if(not x.empty() and x.find_first_not_of("0123456789") == std::string::npos)
         {
-            const std::string& s = t.raw_data();
-            switch(t.data_type())
+            try
+            {
+                return std::stoull(x);
+            }
+            catch(const std::out_of_range&)
             {
-            case onnx::TensorProto::FLOAT: return create_literal(shape::float_type, dims, s.data());
-            case onnx::TensorProto::FLOAT16:
-                return create_literal(shape::half_type, dims, s.data());
-            case onnx::TensorProto::DOUBLE:
-                return create_literal(shape::double_type, dims, s.data());
-            case onnx::TensorProto::INT64: return create_literal(shape::int64_type, dims, s.data());
-            case onnx::TensorProto::INT8:
-            case onnx::TensorProto::UINT16:
-            case onnx::TensorProto::INT16: return create_literal(shape::int16_type, dims, s.data());
-            case onnx::TensorProto::INT32:
-            case onnx::TensorProto::BOOL: return create_literal(shape::int32_type, dims, s.data());
-            case onnx::TensorProto::UINT8:
-            case onnx::TensorProto::STRING:
-            case onnx::TensorProto::UNDEFINED:
-            case onnx::TensorProto::UINT32:
-            case onnx::TensorProto::UINT64:
-            case onnx::TensorProto::COMPLEX64:
-            case onnx::TensorProto::COMPLEX128: throw std::runtime_error("");
             }
-            MIGRAPHX_THROW("Invalid tensor type");
+        }
+        MIGRAPHX_THROW("Invalid external data size \"" + x + "\" for initializer " + t.name());
+    }
+
+    literal parse_external_data(const onnx::TensorProto& t)
+    {
+        std::string location;
+        std::size_t offset = 0;
+        auto s             = get_raw_shape(t);
+        for(auto&& e : t.external_data())
+        {
+            if(e.key() == "location")
+                location = e.value();
+            else if(e.key() == "offset")
+                offset = parse_external_size(t, e.value());
+            else if(e.key() == "length" and parse_external_size(t, e.value()) != s.bytes())
+                MIGRAPHX_THROW("Length of external data does not match initializer " + t.name());
+        }
+        if(location.empty())
+            MIGRAPHX_THROW("No location for the external data of initializer " + t.name());
+        auto filename = path + location;
+        if(not use_mmap)
+        {
+            std::ifstream is(filename, std::ios::binary);
+            auto buffer = make_shared_array<char>(s.bytes());
+            is.seekg(offset);
+            is.read(buffer.get(), s.bytes());
+            if(not is)
+                MIGRAPHX_THROW("Failed to read external data for initializer " + t.name());
+            return literal{s, buffer};
+        }
+        if(not contains(mapped_files, filename))
+        {
+            std::size_t size = 0;
+            auto buffer      = map_file(filename, size);
+            mapped_files.emplace(filename, std::make_pair(buffer, size));
+        }
+        const auto& file = mapped_files.at(filename);
+        if(offset > file.second or s.bytes() > file.second - offset)
+            MIGRAPHX_THROW("External data is outside of " + filename + " for initializer " +
+                           t.name());
+        char* data = file.first.get() + offset;
+        // The offset is not required to be aligned
+        if(reinterpret_cast<std::uintptr_t>(data) % s.type_size() != 0)
+            return literal{s, data};
+        return literal{s, std::shared_ptr<char>(file.first, data)};
+    }
+
+    static literal parse_tensor(const onnx::TensorProto& t)
+    {
+        std::vector<std::size_t> dims(t.dims().begin(), t.dims().end());
+        if(t.has_raw_data())
+        {
+            auto s = get_raw_shape(t);
+            check_raw_data(t, s);
+            return literal{s, t.raw_data().data()};
         }
         switch(t.data_type())
         {
@@ -2591,15 +2696,6 @@ struct onnx_parser
         MIGRAPHX_THROW("Invalid tensor type");
     }
 
-    static literal
-    create_literal(shape::type_t shape_type, const std::vector<size_t>& dims, const char* data)
-    {
-        // in case of scalar constants in onnx file, use dims=1 to fill initializer data
-        if(dims.empty())
-            return literal{{shape_type}, data};
-        return literal{{shape_type, dims}, data};
-    }
-
     template <class T, MIGRAPHX_REQUIRES(not std::is_pointer<T>{})>
     static literal create_literal(shape::type_t shape_type, const std::vector<size_t>& dims, T data)
     {
@@ -2695,12 +2791,14 @@ struct onnx_parser
 };
 
 template <class... Ts>
-program parse_onnx_from(const onnx_options& options, Ts&&... xs)
+program parse_onnx_from(const onnx_options& options, const std::string& path, Ts&&... xs)
 {
     onnx_parser parser;
     parser.map_input_dims         = options.map_input_dims;
     parser.default_dim_value      = options.default_dim_value;
     parser.skip_unknown_operators = options.skip_unknown_operators;
+    parser.use_mmap               = options.use_mmap;
+    parser.path                   = path;
 
     if(options.print_program_on_error)
     {
@@ -2724,18 +2822,28 @@ program parse_onnx_from(const onnx_options& options, Ts&&... xs)
 
 program parse_onnx(const std::string& name, const onnx_options& options)
 {
+    // Keep the separator so a model in the root directory still has a path
+    auto sep  = name.find_last_of('/');
+    auto path = sep == std::string::npos ? "" : name.substr(0, sep + 1);
+    if(options.use_mmap)
+    {
+        // The file is only mapped while parsing, since the literals do not use it
+        std::size_t size = 0;
+        auto buffer      = map_file(name, size);
+        return parse_onnx_from(options, path, buffer.get(), size);
+    }
     std::fstream input(name.c_str(), std::ios::in | std::ios::binary);
-    return parse_onnx_from(options, input);
+    return parse_onnx_from(options, path, input);
 }
 
 program parse_onnx_buffer(const std::string& buffer, const onnx_options& options)
 {
-    return parse_onnx_from(options, buffer.data(), buffer.size());
+    return parse_onnx_from(options, "", buffer.data(), buffer.size());
 }
 
 program parse_onnx_buffer(const void* data, std::size_t size, const onnx_options& options)
 {
-    return parse_onnx_from(options, data, size);
+    return parse_onnx_from(options, "", data, size);
 }
 
 } // namespace MIGRAPHX_INLINE_NS
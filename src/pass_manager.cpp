@@ -6,6 +6,7 @@
 #include <migraphx/env.hpp>
 #include <migraphx/ranges.hpp>
 #include <migraphx/time.hpp>
+#include <migraphx/compile_profiler.hpp>
 #include <migraphx/iterator_for.hpp>
 #include <iostream>
 #include <sstream>
@@ -15,25 +16,49 @@
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
 
-void run_passes(program& prog, const std::vector<pass>& passes, tracer trace)
+using milliseconds = std::chrono::duration<double, std::milli>;
+
+#ifndef NDEBUG
+static void validate_pass(const program& prog, const pass& p, tracer trace)
+{
+    trace("Validate ...");
+    auto invalid = prog.validate();
+    if(invalid != prog.end())
+    {
+        auto index = std::distance(prog.begin(), invalid);
+        MIGRAPHX_THROW(p.name() + " pass produces invalid program at instruction " +
+                       std::to_string(index) + ": " + invalid->name());
+    }
+    trace();
+}
+#endif
+
+void run_passes(program& prog,
+                const std::vector<pass>& passes,
+                tracer trace,
+                compile_profiler* profiler)
 {
+    // Matchers report to the profiler of the current thread, which is kept
+    // for nested calls that do not have a profiler
+    struct restore_profiler
+    {
+        compile_profiler* previous;
+        ~restore_profiler() { set_compile_profiler(previous); }
+    } restore{profiler == nullptr ? get_compile_profiler() : set_compile_profiler(profiler)};
     for(auto& p : passes)
     {
+        compile_profiler::pass_record r;
+        r.name                = p.name();
+        r.instructions_before = prog.size();
         trace("Pass: ", p.name());
-        p.apply(prog);
+        r.time = time<milliseconds>([&] { p.apply(prog); });
         trace(prog);
-
+        r.instructions_after = prog.size();
 #ifndef NDEBUG
-        trace("Validate ...");
-        auto invalid = prog.validate();
-        if(invalid != prog.end())
-        {
-            auto index = std::distance(prog.begin(), invalid);
-            MIGRAPHX_THROW(p.name() + " pass produces invalid program at instruction " +
-                           std::to_string(index) + ": " + invalid->name());
-        }
-        trace();
+        r.validate_time = time<milliseconds>([&] { validate_pass(prog, p, trace); });
 #endif
+        if(profiler != nullptr)
+            profiler->add_pass(r);
     }
 }
 
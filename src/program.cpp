@@ -8,6 +8,9 @@
 #include <migraphx/time.hpp>
 #include <migraphx/iterator_for.hpp>
 #include <migraphx/pass_manager.hpp>
+#include <migraphx/register_op.hpp>
+#include <migraphx/register_target.hpp>
+#include <migraphx/serialize.hpp>
 #include <iostream>
 #include <sstream>
 #include <algorithm>
@@ -18,12 +21,79 @@
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
 
+enum class eval_kind
+{
+    literal,
+    param,
+    outline,
+    ret,
+    op
+};
+
+// A step of the execution plan, which refers to the results of other steps by
+// their index in the plan
+struct eval_step
+{
+    instruction_ref ins;
+    eval_kind kind = eval_kind::op;
+    // The result of a literal or outline, which does not change between runs
+    argument value{};
+    // A literal that is returned by the program is copied on every run, so
+    // the results of different runs do not share it
+    bool copy = false;
+    // The index of the argument of a parameter
+    std::size_t param = 0;
+    std::vector<std::size_t> inputs{};
+    // Results that are not used anymore once this step has run
+    std::vector<std::size_t> frees{};
+};
+
+struct eval_plan
+{
+    std::vector<eval_step> steps{};
+    // The names of the parameters, in the order of their arguments
+    std::vector<std::string> params{};
+    std::size_t max_inputs = 0;
+    // The modification count of the program when the plan was built
+    std::size_t modification = 0;
+
+    // Whether the plan runs the instructions of p in the same order with the
+    // same arguments. This also catches the arguments that passes rewire with
+    // instruction::replace_argument, which the program does not count.
+    bool matches(const program& p, std::size_t m) const
+    {
+        if(modification != m or steps.size() != p.size())
+            return false;
+        std::size_t n = 0;
+        for(auto ins : iterator_for(p))
+        {
+            const auto& step = steps[n++];
+            if(step.ins != ins or step.inputs.size() != ins->inputs().size())
+                return false;
+            for(std::size_t i = 0; i < step.inputs.size(); i++)
+            {
+                if(steps[step.inputs[i]].ins != ins->inputs()[i])
+                    return false;
+            }
+        }
+        return true;
+    }
+};
+
 struct program_impl
 {
     // A list is used to keep references to an instruction stable
     std::list<instruction> instructions;
     std::vector<std::string> input_names;
     context ctx;
+    // The name of the target the program is compiled for
+    std::string target_name;
+    // Counts the changes made by the methods of the program
+    std::size_t modification = 0;
+    // Only built when the program is finalized, so evaluating never writes to
+    // it and a program can be evaluated by several threads. A run of a
+    // program that was changed since builds a plan of its own.
+    eval_plan plan;
 };
 
 const operation& get_operation(instruction_ref ins) { return ins->get_operator(); }
@@ -116,9 +186,11 @@ void program::assign(const program& p)
     else if(!impl->instructions.empty())
     {
         impl->instructions.clear();
+        impl->modification++;
     }
     impl->ctx         = p.impl->ctx;
     impl->input_names = p.impl->input_names;
+    impl->target_name = p.impl->target_name;
 
     std::unordered_map<instruction_ref, instruction_ref> ins_map;
     for(auto ins : iterator_for(p))
@@ -179,6 +251,7 @@ instruction_ref program::insert_instruction(instruction_ref ins,
                args.begin(), args.end(), [&](instruction_ref x) { return has_instruction(x); }) &&
            "Argument is not an exisiting instruction");
     assert(not starts_with(op.name(), "@"));
+    impl->modification++;
     shape r     = compute_shape(op, args);
     auto result = impl->instructions.insert(ins, {op, r, std::move(args)});
     instruction::backreference(result);
@@ -195,6 +268,7 @@ instruction_ref program::replace_instruction(instruction_ref ins,
            "Argument is not an exisiting instruction");
     assert(not starts_with(op.name(), "@"));
 
+    impl->modification++;
     shape r = compute_shape(op, args);
     instruction::replace(ins, op, r, std::move(args));
     assert(ins->valid(begin()));
@@ -206,6 +280,7 @@ instruction_ref program::replace_instruction(instruction_ref ins, instruction_re
     assert(has_instruction(ins));
     assert(has_instruction(rep));
     assert(ins != rep);
+    impl->modification++;
 
     if(ins == std::prev(this->end()))
     {
@@ -243,6 +318,7 @@ instruction_ref program::remove_instruction(instruction_ref ins)
 {
     assert(has_instruction(ins));
     assert(ins->outputs().empty());
+    impl->modification++;
     ins->clear_arguments();
     return impl->instructions.erase(ins);
 }
@@ -253,6 +329,7 @@ instruction_ref program::remove_instructions(instruction_ref first, instruction_
         return first;
     // TODO: Check every element
     assert(has_instruction(first));
+    impl->modification++;
     std::for_each(first, last, [&](instruction& ins) { ins.clear_arguments(); });
     assert(std::all_of(first, last, [&](const instruction& ins) { return ins.outputs().empty(); }));
     return impl->instructions.erase(first, last);
@@ -260,6 +337,7 @@ instruction_ref program::remove_instructions(instruction_ref first, instruction_
 
 instruction_ref program::move_instruction(instruction_ref src, instruction_ref dst)
 {
+    impl->modification++;
     impl->instructions.splice(dst, impl->instructions, src);
     return src;
 }
@@ -274,12 +352,14 @@ instruction_ref program::move_instructions(instruction_ref src, instruction_ref
 
 instruction_ref program::add_literal(literal l)
 {
+    impl->modification++;
     impl->instructions.emplace_front(std::move(l));
     return impl->instructions.begin();
 }
 
 instruction_ref program::add_outline(const shape& s)
 {
+    impl->modification++;
     impl->instructions.push_front({builtin::outline{s}, s, {}});
     return impl->instructions.begin();
 }
@@ -288,6 +368,7 @@ instruction_ref program::add_parameter(std::string name, shape s)
 {
     assert(get_parameter_shape(name) == shape{});
     impl->input_names.push_back(name);
+    impl->modification++;
 
     impl->instructions.push_front({builtin::param{std::move(name)}, std::move(s), {}});
     return impl->instructions.begin();
@@ -298,6 +379,7 @@ instruction_ref program::add_return(std::vector<instruction_ref> args)
     assert(std::all_of(
                args.begin(), args.end(), [&](instruction_ref x) { return has_instruction(x); }) &&
            "Argument is not an exisiting instruction");
+    impl->modification++;
     impl->instructions.push_back({builtin::returns{}, {}, args});
     auto result = std::prev(impl->instructions.end());
     instruction::backreference(result);
@@ -419,12 +501,13 @@ instruction_ref program::validate() const
 void program::compile(const target& t, compile_options options)
 {
     assert(this->validate() == impl->instructions.end());
-    this->impl->ctx = t.get_context();
+    this->impl->ctx         = t.get_context();
+    this->impl->target_name = t.name();
     if(enabled(MIGRAPHX_TRACE_COMPILE{}))
         options.trace = tracer{std::cout};
     options.trace(*this);
     options.trace();
-    run_passes(*this, t.get_passes(this->impl->ctx, options), options.trace);
+    run_passes(*this, t.get_passes(this->impl->ctx, options), options.trace, options.profiler);
     auto invalid = this->validate();
     if(invalid != impl->instructions.end())
     {
@@ -434,84 +517,291 @@ void program::compile(const target& t, compile_options options)
     this->finalize();
 }
 
-void program::finalize()
+static eval_plan build_eval_plan(const program& p, std::size_t modification)
 {
-    for(auto ins : iterator_for(*this))
+    eval_plan plan;
+    plan.modification = modification;
+    if(p.size() == 0)
+        return plan;
+    // Results of the program that alias a literal get a copy of it, so they
+    // can outlive the program
+    std::unordered_set<instruction_ref> outputs;
+    auto last = std::prev(p.end());
+    if(last->name() == "@return")
     {
-        ins->finalize(this->impl->ctx);
+        for(auto ins : last->inputs())
+            outputs.insert(instruction::get_output_alias(ins));
     }
-}
-
-template <class F>
-std::vector<argument> generic_eval(const program& p,
-                                   context& ctx,
-                                   std::unordered_map<std::string, argument> params,
-                                   F trace)
-{
-    assert(p.validate() == p.end());
-    std::unordered_map<instruction_ref, argument> results;
-    results.reserve(p.size() * 2);
-    std::vector<argument> values;
-    values.reserve(16);
+    else
+    {
+        outputs.insert(instruction::get_output_alias(last));
+    }
+    plan.params = p.get_parameter_names();
+    std::unordered_map<instruction_ref, std::size_t> index;
+    plan.steps.reserve(p.size());
     for(auto ins : iterator_for(p))
     {
+        eval_step step;
+        step.ins         = ins;
         const auto& name = ins->name();
         if(name == "@literal")
         {
-            results.emplace(ins, trace(ins, [&] { return ins->get_literal().get_argument(); }));
+            step.kind     = eval_kind::literal;
+            const auto& l = ins->get_literal();
+            // Nothing writes to the literals, so they are used without a copy
+            // unless they are returned
+            step.value = {l.get_shape(), const_cast<char*>(l.data())}; // NOLINT
+            step.copy  = contains(outputs, ins);
         }
         else if(name == "@param")
         {
-            results.emplace(
-                ins, trace(ins, [&] {
-                    auto param_name = any_cast<builtin::param>(ins->get_operator()).parameter;
-                    if(not contains(params, param_name))
-                        MIGRAPHX_THROW("Parameter not found: " + param_name);
-                    auto param = params[param_name];
-                    if(param.get_shape() != ins->get_shape())
-                        MIGRAPHX_THROW("Incorrect shape {" + to_string(param.get_shape()) +
-                                       "} for parameter: " + param_name);
-                    return param;
-                }));
+            step.kind         = eval_kind::param;
+            const auto& pname = any_cast<builtin::param>(ins->get_operator()).parameter;
+            auto it           = std::find(plan.params.begin(), plan.params.end(), pname);
+            if(it == plan.params.end())
+                it = plan.params.insert(it, pname);
+            step.param = std::distance(plan.params.begin(), it);
         }
         else if(name == "@outline")
         {
-            results.emplace(ins, trace(ins, [&] { return argument{ins->get_shape(), nullptr}; }));
+            step.kind  = eval_kind::outline;
+            step.value = argument{ins->get_shape(), nullptr};
         }
         else if(name == "@return")
         {
-            std::vector<argument> prog_outputs;
-            std::transform(ins->inputs().begin(),
-                           ins->inputs().end(),
-                           std::back_inserter(prog_outputs),
-                           [&](instruction_ref i) {
-                               assert(results.find(i) != results.end());
-                               return results[i];
-                           });
+            step.kind = eval_kind::ret;
+        }
+        std::transform(ins->inputs().begin(),
+                       ins->inputs().end(),
+                       std::back_inserter(step.inputs),
+                       [&](instruction_ref i) { return index.at(i); });
+        plan.max_inputs = std::max(plan.max_inputs, step.inputs.size());
+        index[ins]      = plan.steps.size();
+        plan.steps.push_back(std::move(step));
+    }
+    // Going backwards, the first step to use a result is the last one to use
+    // it when running the program
+    std::vector<bool> used(plan.steps.size(), false);
+    for(std::size_t n = plan.steps.size(); n > 0; n--)
+    {
+        auto& step = plan.steps[n - 1];
+        for(auto i : step.inputs)
+        {
+            if(used[i])
+                continue;
+            used[i] = true;
+            step.frees.push_back(i);
+        }
+        // Results that are never used can be freed right away
+        if(step.ins->outputs().empty() and step.ins != last)
+            step.frees.push_back(n - 1);
+    }
+    return plan;
+}
 
-            return prog_outputs;
+// The plan of the program when it still matches, otherwise a plan for this
+// run is built in local
+static const eval_plan& get_eval_plan(const program& p, const program_impl& impl, eval_plan& local)
+{
+    if(impl.plan.matches(p, impl.modification))
+        return impl.plan;
+    local = build_eval_plan(p, impl.modification);
+    return local;
+}
+
+void program::finalize()
+{
+    for(auto ins : iterator_for(*this))
+    {
+        ins->finalize(this->impl->ctx);
+    }
+    this->impl->plan = build_eval_plan(*this, this->impl->modification);
+}
+
+value program::to_value(const std::function<value(const literal&)>& store_literal) const
+{
+    value result;
+    result["target"]     = impl->target_name;
+    result["parameters"] = migraphx::to_value(impl->input_names);
+    value nodes          = value::array{};
+    std::unordered_map<instruction_ref, std::size_t> index;
+    for(auto ins : iterator_for(*this))
+    {
+        value node;
+        node["name"]  = ins->name();
+        node["shape"] = migraphx::to_value(ins->get_shape());
+        if(ins->name() == "@literal")
+            node["literal"] = store_literal(ins->get_literal());
+        else
+            node["operator"] = ins->get_operator().to_value();
+        std::vector<std::size_t> inputs;
+        std::transform(ins->inputs().begin(),
+                       ins->inputs().end(),
+                       std::back_inserter(inputs),
+                       [&](auto i) { return index.at(i); });
+        node["inputs"] = migraphx::to_value(inputs);
+        index[ins]     = nodes.size();
+        nodes.push_back(node);
+    }
+    result["instructions"] = nodes;
+    return result;
+}
+
+value program::to_value() const
+{
+    return this->to_value([](const literal& l) { return migraphx::to_value(l); });
+}
+
+void program::from_value(const value& v, const std::function<literal(const value&)>& load_literal)
+{
+    impl->instructions.clear();
+    impl->modification++;
+    impl->ctx         = context{};
+    impl->input_names = migraphx::from_value<std::vector<std::string>>(v.at("parameters"));
+    impl->target_name = v.at("target").get_string();
+
+    std::vector<instruction_ref> nodes;
+    for(auto&& node : v.at("instructions"))
+    {
+        auto name = node.at("name").get_string();
+        std::vector<instruction_ref> inputs;
+        for(auto&& i : node.at("inputs"))
+            inputs.push_back(nodes.at(i.to<std::size_t>()));
+        instruction_ref ins;
+        if(name == "@literal")
+        {
+            ins = impl->instructions.insert(impl->instructions.end(),
+                                            instruction{load_literal(node.at("literal"))});
+        }
+        else if(name == "@param" or name == "@outline")
+        {
+            auto s = migraphx::from_value<shape>(node.at("shape"));
+            operation op;
+            if(name == "@param")
+                op = migraphx::from_value<builtin::param>(node.at("operator"));
+            else
+                op = migraphx::from_value<builtin::outline>(node.at("operator"));
+            ins = impl->instructions.insert(impl->instructions.end(), {op, s, {}});
+        }
+        else if(name == "@return")
+        {
+            ins = add_return(inputs);
         }
         else
         {
-            values.resize(ins->inputs().size());
-            std::transform(
-                ins->inputs().begin(), ins->inputs().end(), values.begin(), [&](instruction_ref i) {
-                    assert(results.find(i) != results.end());
-                    return results[i];
-                });
-            results.emplace(ins, trace(ins, [&] {
-                                return ins->get_operator().compute(ctx, ins->get_shape(), values);
-                            }));
+            auto op = load_op(name);
+            op.from_value(node.at("operator"));
+            ins = add_instruction(op, inputs);
         }
-        assert(results.find(ins) != results.end());
+        nodes.push_back(ins);
+    }
+    if(not impl->target_name.empty())
+    {
+        impl->ctx = make_target(impl->target_name).get_context();
+        this->finalize();
     }
+}
 
-    return {results.at(std::prev(p.end()))};
+void program::from_value(const value& v)
+{
+    this->from_value(v, [](const value& x) { return migraphx::from_value<literal>(x); });
+}
+
+template <class F>
+std::vector<argument> generic_eval(const program& p,
+                                   context& ctx,
+                                   const std::vector<argument>& args,
+                                   const eval_plan& plan,
+                                   F trace)
+{
+    assert(p.validate() == p.end());
+    assert(args.size() == plan.params.size());
+    // The results of the steps and the inputs of an instruction belong to
+    // the run, so runs of the same program do not share them
+    std::vector<argument> results(plan.steps.size());
+    std::vector<argument> values;
+    values.reserve(plan.max_inputs);
+    for(std::size_t n = 0; n < plan.steps.size(); n++)
+    {
+        const auto& step = plan.steps[n];
+        auto ins         = step.ins;
+        switch(step.kind)
+        {
+        case eval_kind::literal:
+            results[n] = trace(ins, [&] {
+                return step.copy ? ins->get_literal().get_argument() : step.value;
+            });
+            break;
+        case eval_kind::outline: results[n] = trace(ins, [&] { return step.value; }); break;
+        case eval_kind::param:
+            results[n] = trace(ins, [&] {
+                const auto& arg = args[step.param];
+                if(arg.get_shape() != ins->get_shape())
+                    MIGRAPHX_THROW("Incorrect shape {" + to_string(arg.get_shape()) +
+                                   "} for parameter: " + plan.params[step.param]);
+                return arg;
+            });
+            break;
+        case eval_kind::ret:
+        {
+            std::vector<argument> prog_outputs(step.inputs.size());
+            std::transform(step.inputs.begin(),
+                           step.inputs.end(),
+                           prog_outputs.begin(),
+                           [&](std::size_t i) { return results[i]; });
+            return prog_outputs;
+        }
+        case eval_kind::op:
+            values.clear();
+            std::transform(step.inputs.begin(),
+                           step.inputs.end(),
+                           std::back_inserter(values),
+                           [&](std::size_t i) { return results[i]; });
+            results[n] = trace(
+                ins, [&] { return ins->get_operator().compute(ctx, ins->get_shape(), values); });
+            break;
+        }
+        // Drop the results that are not needed anymore, so the memory of
+        // intermediate results is not kept until the end of the program
+        for(auto i : step.frees)
+            results[i] = argument{};
+    }
+    return {results.back()};
+}
+
+// Look up the arguments of the parameters in the order of the plan
+static std::vector<argument> get_eval_arguments(const eval_plan& plan,
+                                                const program::parameter_map& params)
+{
+    std::vector<argument> result;
+    result.reserve(plan.params.size());
+    std::transform(plan.params.begin(),
+                   plan.params.end(),
+                   std::back_inserter(result),
+                   [&](const std::string& name) {
+                       auto it = params.find(name);
+                       if(it == params.end())
+                           MIGRAPHX_THROW("Parameter not found: " + name);
+                       return it->second;
+                   });
+    return result;
+}
+
+template <class F>
+std::vector<argument> generic_eval(const program& p,
+                                   context& ctx,
+                                   const program::parameter_map& params,
+                                   const eval_plan& plan,
+                                   F trace)
+{
+    return generic_eval(p, ctx, get_eval_arguments(plan, params), plan, trace);
 }
 
 std::vector<argument> program::eval(parameter_map params) const
 {
-    auto& ctx = this->impl->ctx;
+    eval_plan local;
+    auto& ctx        = this->impl->ctx;
+    const auto& plan = get_eval_plan(*this, *impl, local);
 #ifndef NDEBUG
     auto sctx          = ctx;
     auto check_context = [&](auto f) {
@@ -528,7 +818,7 @@ std::vector<argument> program::eval(parameter_map params) const
 
     if(trace_level > 0)
     {
-        return generic_eval(*this, ctx, std::move(params), [&](auto& ins, auto f) {
+        return generic_eval(*this, ctx, params, plan, [&](auto& ins, auto f) {
             ctx.finish();
             std::cout << "Run instruction: ";
             this->debug_print(ins);
@@ -541,8 +831,9 @@ std::vector<argument> program::eval(parameter_map params) const
     }
     else
     {
-        return generic_eval(
-            *this, ctx, std::move(params), [&](auto&, auto f) { return check_context(f); });
+        return generic_eval(*this, ctx, params, plan, [&](auto&, auto f) {
+            return check_context(f);
+        });
     }
 }
 
@@ -571,16 +862,18 @@ void program::perf_report(std::ostream& os, std::size_t n, parameter_map params)
         }));
     }
     std::sort(total_vec.begin(), total_vec.end());
+    eval_plan local;
+    const auto& plan = get_eval_plan(*this, *impl, local);
     std::unordered_map<instruction_ref, std::vector<double>> ins_vec;
     // Fill the map
-    generic_eval(*this, ctx, params, [&](auto ins, auto) {
+    generic_eval(*this, ctx, params, plan, [&](auto ins, auto) {
         ins_vec[ins].reserve(n);
         return argument{};
     });
     // Run and time each instruction
     for(std::size_t i = 0; i < n; i++)
     {
-        generic_eval(*this, ctx, params, [&](auto ins, auto f) {
+        generic_eval(*this, ctx, params, plan, [&](auto ins, auto f) {
             argument result;
             ins_vec[ins].push_back(time<milliseconds>([&] {
                 result = f();
@@ -814,8 +1107,10 @@ void program::print_cpp(std::ostream& os) const
 
 void program::dry_run(std::unordered_map<std::string, argument> params) const
 {
-    auto& ctx = this->impl->ctx;
-    generic_eval(*this, ctx, std::move(params), [](auto&&...) { return argument{}; });
+    eval_plan local;
+    auto& ctx        = this->impl->ctx;
+    const auto& plan = get_eval_plan(*this, *impl, local);
+    generic_eval(*this, ctx, params, plan, [](auto&&...) { return argument{}; });
 }
 
 void program::annotate(std::ostream& os, std::function<void(instruction_ref)> a) const
@@ -1,26 +1,44 @@
 #include <migraphx/serialize.hpp>
 #include <migraphx/argument.hpp>
 #include <migraphx/literal.hpp>
+#include <migraphx/operation.hpp>
+#include <migraphx/register_op.hpp>
+#include <cstdint>
 
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
 
+// The data is stored as a single binary value instead of a value for each
+// element
 template <class RawData>
 void raw_data_to_value(value& v, const RawData& rd)
 {
     value result;
     result["shape"] = migraphx::to_value(rd.get_shape());
-    rd.visit([&](auto x) { result["data"] = std::vector<value>(x.begin(), x.end()); });
-    v = result;
+    result["data"]  = value::binary{rd.data(), rd.get_shape().bytes()};
+    v               = result;
 }
 
 void migraphx_to_value(value& v, const literal& l) { raw_data_to_value(v, l); }
 void migraphx_from_value(const value& v, literal& l)
 {
-    auto s = migraphx::from_value<shape>(v.at("shape"));
+    auto s           = migraphx::from_value<shape>(v.at("shape"));
+    const auto& data = v.at("data");
+    if(data.is_binary())
+    {
+        const auto& b = data.get_binary();
+        if(b.size() != s.bytes())
+            MIGRAPHX_THROW("Data of " + std::to_string(b.size()) + " bytes does not match shape");
+        // Share the bytes of the binary, unless they are not aligned for the type
+        if(b.empty() or reinterpret_cast<std::uintptr_t>(b.data()) % s.type_size() != 0)
+            l = literal{s, b.data()};
+        else
+            l = literal{s, std::const_pointer_cast<char>(b.share())};
+        return;
+    }
     s.visit_type([&](auto as) {
         using type = typename decltype(as)::type;
-        l          = literal{s, v.at("data").to_vector<type>()};
+        l          = literal{s, data.to_vector<type>()};
     });
 }
 
@@ -31,5 +49,19 @@ void migraphx_from_value(const value& v, argument& a)
     a         = l.get_argument();
 }
 
+void migraphx_to_value(value& v, const operation& op)
+{
+    value result;
+    result["name"]     = op.name();
+    result["operator"] = op.to_value();
+    v                  = result;
+}
+
+void migraphx_from_value(const value& v, operation& op)
+{
+    op = load_op(v.at("name").get_string());
+    op.from_value(v.at("operator"));
+}
+
 } // namespace MIGRAPHX_INLINE_NS
 } // namespace migraphx
@@ -0,0 +1,203 @@
+#include <migraphx/sink_transposes.hpp>
+#include <migraphx/program.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/op/transpose.hpp>
+#include <migraphx/iterator_for.hpp>
+#include <migraphx/permutation.hpp>
+#include <migraphx/serialize.hpp>
+#include <migraphx/ranges.hpp>
+#include <algorithm>
+#include <unordered_set>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+
+// The operators that compute each element from the elements at the same
+// index of their inputs, whatever the layout of the inputs
+static bool is_elementwise(const std::string& name)
+{
+    // clang-format off
+    static const std::unordered_set<std::string> names = {
+        "abs", "acos", "acosh", "asin", "asinh", "atan", "atanh", "ceil", "convert", "cos",
+        "cosh", "elu", "erf", "exp", "floor", "leaky_relu", "log", "neg", "recip", "relu",
+        "round", "rsqrt", "sigmoid", "sign", "sin", "sinh", "sqrt", "tan", "tanh",
+        "add", "div", "max", "min", "mul", "pow", "prelu", "sqdiff", "sub"
+    };
+    // clang-format on
+    return contains(names, name);
+}
+
+// The reductions keep the reduced dimensions, so they can be transposed
+static bool is_reduction(const std::string& name)
+{
+    return contains({"reduce_max", "reduce_mean", "reduce_min", "reduce_prod", "reduce_sum"},
+                    name);
+}
+
+// The operators along an axis that only take a standard input
+static bool needs_standard_input(const std::string& name)
+{
+    return contains({"softmax", "logsoftmax", "argmax", "argmin"}, name);
+}
+
+static bool is_sinkable(const std::string& name)
+{
+    return is_elementwise(name) or is_reduction(name) or needs_standard_input(name) or
+           name == "concat";
+}
+
+// The operators that take an input in any layout
+static bool reads_any_layout(const std::string& name)
+{
+    return is_elementwise(name) or is_reduction(name) or
+           contains({"concat", "contiguous", "transpose"}, name);
+}
+
+static instruction_ref skip_contiguous(instruction_ref ins)
+{
+    while(ins->name() == "contiguous")
+        ins = ins->inputs().front();
+    return ins;
+}
+
+// The dims of the transpose an input is, or is a copy of
+static std::vector<int64_t> get_permutation(instruction_ref ins)
+{
+    auto t = skip_contiguous(ins);
+    if(t->name() != "transpose")
+        return {};
+    return any_cast<op::transpose>(t->get_operator()).dims;
+}
+
+// The readers of ins, where the copies made of ins are read through
+static std::vector<instruction_ref> get_readers(instruction_ref ins)
+{
+    std::vector<instruction_ref> result;
+    for(auto output : ins->outputs())
+    {
+        if(output->name() != "contiguous")
+        {
+            result.push_back(output);
+            continue;
+        }
+        auto readers = get_readers(output);
+        result.insert(result.end(), readers.begin(), readers.end());
+    }
+    return result;
+}
+
+// The axis of a transposed tensor is the axis perm[axis] of the tensor that
+// was transposed
+static operation permute_axes(operation op, const std::vector<int64_t>& perm)
+{
+    auto n     = static_cast<int64_t>(perm.size());
+    auto remap = [&](int64_t axis) { return perm[axis < 0 ? axis + n : axis]; };
+    auto v     = op.to_value();
+    if(v.contains("axes"))
+    {
+        auto axes = v.at("axes").to_vector<int64_t>();
+        std::transform(axes.begin(), axes.end(), axes.begin(), remap);
+        v["axes"] = migraphx::to_value(axes);
+    }
+    if(v.contains("axis"))
+        v["axis"] = remap(v.at("axis").to<int64_t>());
+    op.from_value(v);
+    return op;
+}
+
+// Whether ins can read its inputs before they are transposed by perm: they
+// are transposes by perm, or broadcasts read elementwise, which are
+// transposed back without a copy. The transpose of sunk is moved past it
+// first.
+static bool can_sink(instruction_ref ins, const std::vector<int64_t>& perm, instruction_ref sunk)
+{
+    if(not is_sinkable(ins->name()))
+        return false;
+    return std::all_of(ins->inputs().begin(), ins->inputs().end(), [&](auto input) {
+        if(skip_contiguous(input) == sunk)
+            return true;
+        if(get_permutation(input) == perm)
+            return not needs_standard_input(ins->name()) or
+                   skip_contiguous(input)->inputs().front()->get_shape().standard();
+        return is_elementwise(ins->name()) and input->get_shape().broadcasted();
+    });
+}
+
+// Whether the readers of ins can read it once it is transposed
+static bool readers_take_transpose(instruction_ref ins)
+{
+    if(not ins->get_shape().standard())
+        return true;
+    return std::all_of(ins->outputs().begin(), ins->outputs().end(), [](auto output) {
+        return reads_any_layout(output->name());
+    });
+}
+
+// Whether a transpose moved past ins, and then past its readers, ends up
+// next to a transpose it is merged with
+static bool reaches_transpose(instruction_ref ins, const std::vector<int64_t>& perm)
+{
+    auto readers = get_readers(ins);
+    if(readers.empty())
+        return false;
+    return std::all_of(readers.begin(), readers.end(), [&](auto reader) {
+        if(reader->name() == "transpose")
+            return true;
+        return can_sink(reader, perm, ins) and readers_take_transpose(reader) and
+               reaches_transpose(reader, perm);
+    });
+}
+
+struct transpose_sinking
+{
+    program* prog;
+
+    void sink(instruction_ref ins, const std::vector<int64_t>& perm)
+    {
+        auto iperm = invert_permutation(perm);
+        std::vector<instruction_ref> inputs;
+        std::transform(
+            ins->inputs().begin(), ins->inputs().end(), std::back_inserter(inputs), [&](auto i) {
+                if(get_permutation(i) == perm)
+                    return skip_contiguous(i)->inputs().front();
+                return prog->insert_instruction(ins, op::transpose{iperm}, i);
+            });
+        auto op = ins->get_operator();
+        if(not is_elementwise(ins->name()))
+            op = permute_axes(op, perm);
+        auto x = prog->insert_instruction(ins, op, inputs);
+        prog->replace_instruction(ins, op::transpose{perm}, x);
+    }
+
+    void apply()
+    {
+        for(auto ins : iterator_for(*prog))
+        {
+            if(not is_sinkable(ins->name()))
+                continue;
+            auto it = std::find_if(ins->inputs().begin(), ins->inputs().end(), [](auto input) {
+                return not get_permutation(input).empty();
+            });
+            if(it == ins->inputs().end())
+                continue;
+            auto perm = get_permutation(*it);
+            if(not can_sink(ins, perm, prog->end()) or not readers_take_transpose(ins))
+                continue;
+            // Transposing the broadcasts, or the smaller result of a
+            // reduction, can add a copy unless the transpose is merged later
+            bool all_transposed =
+                std::all_of(ins->inputs().begin(), ins->inputs().end(), [&](auto input) {
+                    return get_permutation(input) == perm;
+                });
+            if((is_reduction(ins->name()) or not all_transposed) and
+               not reaches_transpose(ins, perm))
+                continue;
+            sink(ins, perm);
+        }
+    }
+};
+
+void sink_transposes::apply(program& p) const { transpose_sinking{&p}.apply(); }
+
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
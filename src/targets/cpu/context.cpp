@@ -0,0 +1,155 @@
+#include <migraphx/cpu/context.hpp>
+#include <algorithm>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace cpu {
+
+stream::~stream()
+{
+    {
+        std::lock_guard<std::mutex> lock(m);
+        stop = true;
+    }
+    cv.notify_all();
+    if(thread.joinable())
+        thread.join();
+}
+
+void stream::push(std::function<void()> f)
+{
+    {
+        std::lock_guard<std::mutex> lock(m);
+        tasks.push_back(std::move(f));
+        if(not thread.joinable())
+            thread = std::thread([this] { this->work(); });
+    }
+    cv.notify_all();
+}
+
+void stream::wait()
+{
+    std::unique_lock<std::mutex> lock(m);
+    cv.wait(lock, [&] { return tasks.empty() and not busy; });
+    if(error)
+    {
+        auto e = error;
+        error  = nullptr;
+        std::rethrow_exception(e);
+    }
+}
+
+void stream::work()
+{
+    std::unique_lock<std::mutex> lock(m);
+    for(;;)
+    {
+        cv.wait(lock, [&] { return stop or not tasks.empty(); });
+        // The tasks left are finished before stopping
+        if(tasks.empty())
+            return;
+        auto f = std::move(tasks.front());
+        tasks.pop_front();
+        busy = true;
+        lock.unlock();
+        std::exception_ptr e = nullptr;
+        try
+        {
+            f();
+        }
+        catch(...)
+        {
+            e = std::current_exception();
+        }
+        lock.lock();
+        busy = false;
+        if(e and not error)
+            error = e;
+        if(tasks.empty())
+            cv.notify_all();
+    }
+}
+
+void event::record(stream& s)
+{
+    {
+        std::lock_guard<std::mutex> lock(m);
+        recorded++;
+    }
+    s.push([this] {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            completed++;
+        }
+        cv.notify_all();
+    });
+}
+
+void event::wait(stream& s)
+{
+    std::size_t n = 0;
+    {
+        std::lock_guard<std::mutex> lock(m);
+        n = recorded;
+    }
+    s.push([this, n] {
+        std::unique_lock<std::mutex> lock(m);
+        cv.wait(lock, [&] { return completed >= n; });
+    });
+}
+
+template <class T>
+static std::vector<std::shared_ptr<T>> make_shared_vector(std::size_t n)
+{
+    std::vector<std::shared_ptr<T>> result(n);
+    std::generate(result.begin(), result.end(), [] { return std::make_shared<T>(); });
+    return result;
+}
+
+context::context(std::size_t n) : streams(make_shared_vector<stream>(std::max<std::size_t>(n, 1)))
+{
+}
+
+context::context(const context& x) : current_stream(x.current_stream)
+{
+    // The copy continues after the work pushed to x
+    x.finish();
+    streams = make_shared_vector<stream>(x.streams.size());
+    events  = make_shared_vector<event>(x.events.size());
+}
+
+context& context::operator=(const context& x)
+{
+    if(this == &x)
+        return *this;
+    x.finish();
+    current_stream = x.current_stream;
+    streams        = make_shared_vector<stream>(x.streams.size());
+    events         = make_shared_vector<event>(x.events.size());
+    preallocations.clear();
+    return *this;
+}
+
+argument context::get_preallocation(const std::string& id, const shape& s)
+{
+    auto& buffer = preallocations[id];
+    if(buffer.empty() or buffer.get_shape() != s)
+        buffer = argument{s, allocate_aligned};
+    return buffer;
+}
+
+void context::create_events(std::size_t num_of_events)
+{
+    for(std::size_t i = events.size(); i < num_of_events + 1; ++i)
+        events.push_back(std::make_shared<event>());
+}
+
+void context::finish() const
+{
+    for(auto&& s : streams)
+        s->wait();
+}
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
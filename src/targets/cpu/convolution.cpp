@@ -0,0 +1,432 @@
+#include <migraphx/cpu/convolution.hpp>
+#include <migraphx/cpu/propagate_layout.hpp>
+#include <migraphx/par_for.hpp>
+#include <migraphx/half.hpp>
+#include <blaze/math/CustomMatrix.h>
+#include <algorithm>
+#include <numeric>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace cpu {
+
+template <class T>
+using matrix = blaze::CustomMatrix<T, blaze::unaligned, blaze::unpadded>; // NOLINT
+
+template <class V, class T, class... Ts>
+void visit_quantize_impl(V&& v, T&& x, Ts&&... xs)
+{
+    x.visit([&](auto y) { visit_all(xs...)([&](auto... ys) { v(y, ys...); }); });
+}
+
+template <class T, class... Ts>
+auto visit_quantize(T&& x, Ts&&... xs)
+{
+    return [&](auto v) {
+        // Workaround for https://gcc.gnu.org/bugzilla/show_bug.cgi?id=70100
+        visit_quantize_impl(v, x, xs...);
+    };
+}
+
+// A run of neighbouring outputs on the innermost spatial dimension that all
+// read inside of the input for one position of the window
+struct conv_run
+{
+    std::size_t out;
+    std::size_t in;
+    std::size_t n;
+};
+
+// Precomputes the padding and bounds checks of a convolution, so the kernels
+// only loop over runs of valid elements
+struct conv_geometry
+{
+    std::size_t batch          = 0;
+    std::size_t channels       = 0;
+    std::size_t filters        = 0;
+    std::size_t group_channels = 0;
+    std::size_t group_filters  = 0;
+    std::size_t in_size        = 0;
+    std::size_t out_size       = 0;
+    std::size_t win_size       = 0;
+    std::size_t step           = 1;
+    bool pointwise             = false;
+    std::vector<std::vector<conv_run>> runs;
+    shape input_shape;
+    shape weights_shape;
+    shape output_shape;
+
+    template <class Op>
+    conv_geometry(const shape& input, const shape& weights, const shape& output, const Op& op)
+        : input_shape(input), weights_shape(weights), output_shape(output)
+    {
+        const auto& in_lens  = input.lens();
+        const auto& wei_lens = weights.lens();
+        const auto& out_lens = output.lens();
+        batch                = in_lens[0];
+        channels             = in_lens[1];
+        filters              = wei_lens[0];
+        group_channels       = wei_lens[1];
+        group_filters        = filters / op.group;
+
+        shape in_s{shape::float_type,
+                   std::vector<std::size_t>(in_lens.begin() + 2, in_lens.end())};
+        shape win_s{shape::float_type,
+                    std::vector<std::size_t>(wei_lens.begin() + 2, wei_lens.end())};
+        shape out_s{shape::float_type,
+                    std::vector<std::size_t>(out_lens.begin() + 2, out_lens.end())};
+        in_size  = in_s.elements();
+        out_size = out_s.elements();
+        win_size = win_s.elements();
+
+        auto kdims = in_s.lens().size();
+        auto last  = kdims - 1;
+        step       = op.stride[last];
+        pointwise =
+            win_size == 1 and
+            std::all_of(op.stride.begin(), op.stride.end(), [](auto s) { return s == 1; }) and
+            std::all_of(op.padding.begin(), op.padding.end(), [](auto p) { return p == 0; });
+
+        auto row_lens  = out_s.lens();
+        row_lens[last] = 1;
+        shape row_s{shape::float_type, row_lens};
+
+        auto in_width  = std::ptrdiff_t(in_s.lens()[last]);
+        auto out_width = std::ptrdiff_t(out_s.lens()[last]);
+        auto stride    = std::ptrdiff_t(step);
+        runs.resize(win_size);
+        for(std::size_t k = 0; k < win_size; k++)
+        {
+            auto kidx = win_s.multi(k);
+            auto offset =
+                std::ptrdiff_t(kidx[last] * op.dilation[last]) - std::ptrdiff_t(op.padding[last]);
+            // Outputs on the innermost dimension that read inside of the input
+            std::ptrdiff_t first = offset < 0 ? (stride - 1 - offset) / stride : 0;
+            std::ptrdiff_t end =
+                std::min(in_width > offset ? (in_width - 1 - offset) / stride + 1 : 0, out_width);
+            if(first >= end)
+                continue;
+            for(std::size_t r = 0; r < row_s.elements(); r++)
+            {
+                auto oidx = row_s.multi(r);
+                std::vector<std::size_t> iidx(kdims);
+                bool inside = true;
+                for(std::size_t d = 0; d < last; d++)
+                {
+                    auto i = std::ptrdiff_t(oidx[d] * op.stride[d] + kidx[d] * op.dilation[d]) -
+                             std::ptrdiff_t(op.padding[d]);
+                    inside = inside and i >= 0 and i < std::ptrdiff_t(in_s.lens()[d]);
+                    iidx[d] = i;
+                }
+                if(not inside)
+                    continue;
+                oidx[last] = first;
+                iidx[last] = first * stride + offset;
+                runs[k].push_back({out_s.index(oidx), in_s.index(iidx), std::size_t(end - first)});
+            }
+        }
+    }
+
+    bool matches(const shape& input, const shape& weights, const shape& output) const
+    {
+        return input == input_shape and weights == weights_shape and output == output_shape;
+    }
+};
+
+template <class T, class U>
+void conv_direct(tensor_view<T> output,
+                 tensor_view<U> input,
+                 tensor_view<U> weights,
+                 const conv_geometry& geo)
+{
+    using acc_type = std::conditional_t<std::is_same<T, half>{}, float, T>;
+    par_for(geo.batch * geo.filters, 1, [&](std::size_t i) {
+        auto n = i / geo.filters;
+        auto k = i % geo.filters;
+        auto g = k / geo.group_filters;
+        std::vector<acc_type> acc(geo.out_size, acc_type(0));
+        for(std::size_t c = 0; c < geo.group_channels; c++)
+        {
+            const U* x =
+                input.data() + (n * geo.channels + g * geo.group_channels + c) * geo.in_size;
+            const U* w = weights.data() + (k * geo.group_channels + c) * geo.win_size;
+            for(std::size_t kk = 0; kk < geo.win_size; kk++)
+            {
+                acc_type wv = w[kk];
+                for(auto&& run : geo.runs[kk])
+                {
+                    auto* y        = acc.data() + run.out;
+                    const auto* xr = x + run.in;
+                    // Keep the unit stride loop separate so it can be vectorized
+                    if(geo.step == 1)
+                    {
+                        for(std::size_t j = 0; j < run.n; j++)
+                            y[j] += wv * xr[j];
+                    }
+                    else
+                    {
+                        for(std::size_t j = 0; j < run.n; j++)
+                            y[j] += wv * xr[j * geo.step];
+                    }
+                }
+            }
+        }
+        std::copy(acc.begin(), acc.end(), output.data() + i * geo.out_size);
+    });
+}
+
+// Lower to a gemm of the weights with the im2col matrix of the input, which is
+// built in tiles of output columns so each tile stays in cache
+template <class T>
+void conv_gemm(tensor_view<T> output,
+               tensor_view<T> input,
+               tensor_view<T> weights,
+               const conv_geometry& geo)
+{
+    auto rows   = geo.group_channels * geo.win_size;
+    auto tile   = std::min(geo.out_size, std::max<std::size_t>(16, (1u << 16u) / rows));
+    auto ntile  = (geo.out_size + tile - 1) / tile;
+    auto groups = geo.channels / geo.group_channels;
+    for(std::size_t n = 0; n < geo.batch; n++)
+    {
+        for(std::size_t g = 0; g < groups; g++)
+        {
+            T* x = input.data() + (n * geo.channels + g * geo.group_channels) * geo.in_size;
+            T* y = output.data() + (n * geo.filters + g * geo.group_filters) * geo.out_size;
+            matrix<T> w{weights.data() + g * geo.group_filters * rows, geo.group_filters, rows};
+            if(geo.pointwise)
+            {
+                matrix<T> b{x, geo.group_channels, geo.in_size};
+                matrix<T> c{y, geo.group_filters, geo.out_size};
+                c = w * b;
+                continue;
+            }
+            par_for(ntile, 1, [&](std::size_t t) {
+                auto first = t * tile;
+                auto last  = std::min(geo.out_size, first + tile);
+                auto cols  = last - first;
+                std::vector<T> col(rows * cols, T(0));
+                for(std::size_t c = 0; c < geo.group_channels; c++)
+                {
+                    const T* xc = x + c * geo.in_size;
+                    for(std::size_t kk = 0; kk < geo.win_size; kk++)
+                    {
+                        T* dst         = col.data() + (c * geo.win_size + kk) * cols;
+                        const auto& rs = geo.runs[kk];
+                        auto start     = std::upper_bound(
+                            rs.begin(), rs.end(), first, [](std::size_t i, const conv_run& run) {
+                                return i < run.out + run.n;
+                            });
+                        for(auto run = start; run != rs.end() and run->out < last; ++run)
+                        {
+                            auto lo = std::max(run->out, first);
+                            auto hi = std::min(run->out + run->n, last);
+                            for(auto j = lo; j < hi; j++)
+                                dst[j - first] = xc[run->in + (j - run->out) * geo.step];
+                        }
+                    }
+                }
+                matrix<T> b{col.data(), rows, cols};
+                matrix<T> c{y + first, geo.group_filters, cols, geo.out_size};
+                c = w * b;
+            });
+        }
+    }
+}
+
+// The weights as [filters, window, channels], the order the nhwc kernel reads
+// them in, which propagate_layout stores constant weights in
+template <class T>
+T* nhwc_weights(tensor_view<T> weights, const conv_geometry& geo, std::vector<T>& buffer)
+{
+    if(is_channels_last(weights.get_shape()))
+        return weights.data();
+    assert(weights.get_shape().standard());
+    buffer.resize(weights.size());
+    for(std::size_t k = 0; k < geo.filters; k++)
+    {
+        for(std::size_t c = 0; c < geo.group_channels; c++)
+        {
+            for(std::size_t kk = 0; kk < geo.win_size; kk++)
+                buffer[(k * geo.win_size + kk) * geo.group_channels + c] =
+                    weights.data()[(k * geo.group_channels + c) * geo.win_size + kk];
+        }
+    }
+    return buffer.data();
+}
+
+// Lower to a gemm of tiles of the im2col matrix of an input stored with the
+// channels last, where every row of the matrix copies the channels of the
+// pixels of a window. The output is written with the channels last, or in
+// the standard layout when it is a result of the program.
+template <class T>
+void conv_gemm_nhwc(tensor_view<T> output,
+                    tensor_view<T> input,
+                    tensor_view<T> weights,
+                    const conv_geometry& geo)
+{
+    std::vector<T> buffer;
+    auto* wp      = nhwc_weights(weights, geo, buffer);
+    auto gc       = geo.group_channels;
+    auto gf       = geo.group_filters;
+    auto rows     = gc * geo.win_size;
+    auto tile     = std::min(geo.out_size, std::max<std::size_t>(16, (1u << 16u) / rows));
+    auto ntile    = (geo.out_size + tile - 1) / tile;
+    auto groups   = geo.channels / gc;
+    bool nhwc_out = is_channels_last(output.get_shape());
+    // Write the product of the rows of b, one for each pixel starting at
+    // first, with the weights of group g
+    auto write = [&](T* y, matrix<T>& b, const matrix<T>& w, std::size_t first, std::size_t g) {
+        if(nhwc_out)
+        {
+            matrix<T> c{y + first * geo.filters + g * gf, b.rows(), gf, geo.filters};
+            c = b * blaze::trans(w);
+        }
+        else
+        {
+            matrix<T> c{y + g * gf * geo.out_size + first, gf, b.rows(), geo.out_size};
+            c = w * blaze::trans(b);
+        }
+    };
+    for(std::size_t n = 0; n < geo.batch; n++)
+    {
+        T* x = input.data() + n * geo.channels * geo.in_size;
+        T* y = output.data() + n * geo.filters * geo.out_size;
+        for(std::size_t g = 0; g < groups; g++)
+        {
+            matrix<T> w{wp + g * gf * rows, gf, rows};
+            if(geo.pointwise)
+            {
+                matrix<T> b{x + g * gc, geo.in_size, gc, geo.channels};
+                write(y, b, w, 0, g);
+                continue;
+            }
+            par_for(ntile, 1, [&](std::size_t t) {
+                auto first = t * tile;
+                auto last  = std::min(geo.out_size, first + tile);
+                std::vector<T> col((last - first) * rows, T(0));
+                for(std::size_t kk = 0; kk < geo.win_size; kk++)
+                {
+                    const auto& rs = geo.runs[kk];
+                    auto start     = std::upper_bound(
+                        rs.begin(), rs.end(), first, [](std::size_t i, const conv_run& run) {
+                            return i < run.out + run.n;
+                        });
+                    for(auto run = start; run != rs.end() and run->out < last; ++run)
+                    {
+                        auto lo = std::max(run->out, first);
+                        auto hi = std::min(run->out + run->n, last);
+                        for(auto j = lo; j < hi; j++)
+                        {
+                            const T* xp =
+                                x + (run->in + (j - run->out) * geo.step) * geo.channels + g * gc;
+                            std::copy(xp, xp + gc, col.data() + (j - first) * rows + kk * gc);
+                        }
+                    }
+                }
+                matrix<T> b{col.data(), last - first, rows};
+                write(y, b, w, first, g);
+            });
+        }
+    }
+}
+
+template <class T>
+void conv_compute(tensor_view<T> output,
+                  tensor_view<T> input,
+                  tensor_view<T> weights,
+                  const conv_geometry& geo,
+                  std::true_type)
+{
+    if(is_channels_last(input.get_shape()))
+        conv_gemm_nhwc(output, input, weights, geo);
+    // Depthwise and other small windows do not have enough work for a gemm
+    else if(geo.group_channels * geo.win_size < 16)
+        conv_direct(output, input, weights, geo);
+    else
+        conv_gemm(output, input, weights, geo);
+}
+
+template <class T, class U>
+void conv_compute(tensor_view<T> output,
+                  tensor_view<U> input,
+                  tensor_view<U> weights,
+                  const conv_geometry& geo,
+                  std::false_type)
+{
+    conv_direct(output, input, weights, geo);
+}
+
+static void convolution_geo(const argument& result,
+                            const argument& input,
+                            const argument& weights,
+                            const conv_geometry& geo)
+{
+    visit_quantize(result, input, weights)([&](auto output, auto x, auto w) {
+        assert(x.get_shape().standard() or is_channels_last(x.get_shape()));
+        assert(w.get_shape().standard() or is_channels_last(w.get_shape()));
+        using type       = typename decltype(output)::value_type;
+        using input_type = typename decltype(x)::value_type;
+        conv_compute(output,
+                     x,
+                     w,
+                     geo,
+                     std::integral_constant<bool,
+                                            std::is_same<type, float>{} and
+                                                std::is_same<input_type, float>{}>{});
+    });
+}
+
+template <class Op>
+void convolution_tpl(const argument& result,
+                     const argument& input,
+                     const argument& weights,
+                     const Op& op,
+                     const conv_geometry* geo)
+{
+    if(geo != nullptr and geo->matches(input.get_shape(), weights.get_shape(), result.get_shape()))
+    {
+        convolution_geo(result, input, weights, *geo);
+        return;
+    }
+    conv_geometry local{input.get_shape(), weights.get_shape(), result.get_shape(), op};
+    convolution_geo(result, input, weights, local);
+}
+
+std::shared_ptr<const conv_geometry> make_conv_geometry(const shape& input,
+                                                        const shape& weights,
+                                                        const shape& output,
+                                                        const op::convolution& op)
+{
+    return std::make_shared<conv_geometry>(input, weights, output, op);
+}
+
+std::shared_ptr<const conv_geometry> make_conv_geometry(const shape& input,
+                                                        const shape& weights,
+                                                        const shape& output,
+                                                        const op::quant_convolution& op)
+{
+    return std::make_shared<conv_geometry>(input, weights, output, op);
+}
+
+void convolution(const argument& result,
+                 const argument& input,
+                 const argument& weights,
+                 const op::convolution& op,
+                 const conv_geometry* geo)
+{
+    convolution_tpl(result, input, weights, op, geo);
+}
+
+void convolution(const argument& result,
+                 const argument& input,
+                 const argument& weights,
+                 const op::quant_convolution& op,
+                 const conv_geometry* geo)
+{
+    convolution_tpl(result, input, weights, op, geo);
+}
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
@@ -0,0 +1,101 @@
+#include <migraphx/cpu/eliminate_contiguous.hpp>
+#include <migraphx/cpu/gemm.hpp>
+#include <migraphx/program.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/iterator_for.hpp>
+#include <migraphx/ranges.hpp>
+#include <algorithm>
+#include <unordered_set>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace cpu {
+
+bool is_elementwise(const std::string& name)
+{
+    static const std::unordered_set<std::string> names = {
+        "cpu::pointwise", "cpu::abs", "cpu::acos", "cpu::acosh", "cpu::asin", "cpu::asinh",
+        "cpu::atan", "cpu::atanh", "cpu::ceil", "cpu::cos", "cpu::cosh", "cpu::erf", "cpu::exp",
+        "cpu::floor", "cpu::log", "cpu::neg", "cpu::recip", "cpu::relu", "cpu::round",
+        "cpu::rsqrt", "cpu::sigmoid", "cpu::sign", "cpu::sin", "cpu::sinh", "cpu::sqrt",
+        "cpu::tan", "cpu::tanh", "cpu::gelu", "cpu::gelu_tanh", "cpu::elu", "cpu::leaky_relu",
+        "cpu::convert", "cpu::add", "cpu::div", "cpu::max", "cpu::min", "cpu::mul", "cpu::pow",
+        "cpu::prelu", "cpu::sqdiff", "cpu::sub"};
+    return contains(names, name);
+}
+
+static bool is_reduction(const std::string& name)
+{
+    return contains({"cpu::reduce_max",
+                     "cpu::reduce_mean",
+                     "cpu::reduce_min",
+                     "cpu::reduce_prod",
+                     "cpu::reduce_sum"},
+                    name);
+}
+
+// The operators run by cpu::op that only make a view of their input
+static bool is_view(instruction_ref ins)
+{
+    if(ins->name() != "cpu::op")
+        return false;
+    return contains({"transpose", "slice", "broadcast", "multibroadcast"},
+                    ins->get_operator().to_value().at("name").get_string());
+}
+
+bool reads_strided_input(instruction_ref ins, std::size_t i, const shape& s)
+{
+    const auto& name = ins->name();
+    // The last input is the memory of the result
+    if(i + 1 >= ins->inputs().size())
+        return false;
+    // These kernels read every element through the strides of their inputs
+    if(is_elementwise(name) or is_reduction(name) or
+       contains({"cpu::concat", "cpu::contiguous"}, name))
+        return true;
+    // softmax gathers each row of a strided input into its result
+    if(contains({"cpu::softmax", "cpu::logsoftmax"}, name))
+        return true;
+    // The matrices of A and B can have any strides across the batch, like
+    // the heads of attention split by a transpose, or be transposed
+    if(name == "cpu::dot")
+        return i < 2 and has_leading_dim(s);
+    return false;
+}
+
+// Whether every reader of ins reads it when it is stored as s, where the
+// readers of a view read it with the strides the view gets from s
+static bool all_read_strided(instruction_ref ins, const shape& s)
+{
+    return std::all_of(ins->outputs().begin(), ins->outputs().end(), [&](auto output) {
+        // The views take a single input
+        if(is_view(output))
+            return not output->outputs().empty() and
+                   all_read_strided(output, output->get_operator().compute_shape({s}));
+        const auto& inputs = output->inputs();
+        for(std::size_t i = 0; i < inputs.size(); i++)
+        {
+            if(inputs[i] == ins and not reads_strided_input(output, i, s))
+                return false;
+        }
+        return true;
+    });
+}
+
+void eliminate_contiguous::apply(program& p) const
+{
+    for(auto ins : iterator_for(p))
+    {
+        if(ins->name() != "cpu::contiguous" or ins->outputs().empty())
+            continue;
+        if(ins->inputs().back()->name() != "cpu::allocate")
+            continue;
+        auto input = ins->inputs().front();
+        if(all_read_strided(ins, input->get_shape()))
+            p.replace_instruction(ins, input);
+    }
+}
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
@@ -0,0 +1,164 @@
+#include <migraphx/cpu/fuse_gelu.hpp>
+#include <migraphx/cpu/gelu.hpp>
+#include <migraphx/program.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/matcher.hpp>
+#include <migraphx/register_op.hpp>
+#include <migraphx/ranges.hpp>
+#include <migraphx/env.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace cpu {
+
+MIGRAPHX_DECLARE_ENV_VAR(MIGRAPHX_DISABLE_FAST_GELU)
+
+MIGRAPHX_REGISTER_OP(gelu)
+MIGRAPHX_REGISTER_OP(gelu_tanh)
+
+// Whether ins is a constant, which can be broadcast, with every element close
+// to x
+static bool is_value(instruction_ref ins, double x)
+{
+    if(not ins->can_eval())
+        return false;
+    auto a = ins->eval();
+    if(a.empty())
+        return false;
+    bool result = false;
+    a.visit([&](auto v) {
+        result = std::all_of(v.strided_begin(), v.strided_end(), [&](double y) {
+            return std::abs(y - x) <= 1e-4 * std::abs(x);
+        });
+    });
+    return result;
+}
+
+static auto has_value(double x)
+{
+    return match::make_basic_pred_matcher([=](instruction_ref ins) { return is_value(ins, x); });
+}
+
+// The input of a binary operator that is not x
+static instruction_ref other_input(instruction_ref ins, instruction_ref x)
+{
+    auto&& inputs = ins->inputs();
+    return inputs.front() == x ? inputs.back() : inputs.front();
+}
+
+static bool is_mul_of(instruction_ref ins, instruction_ref x, double y)
+{
+    return ins->name() == "mul" and contains(ins->inputs(), x) and is_value(other_input(ins, x), y);
+}
+
+// x * x * x in any order, or pow(x, 3)
+static bool is_cube(instruction_ref ins, instruction_ref x)
+{
+    if(ins->name() == "pow")
+        return ins->inputs().front() == x and is_value(ins->inputs().back(), 3.0);
+    if(ins->name() != "mul" or not contains(ins->inputs(), x))
+        return false;
+    auto square = other_input(ins, x);
+    return square->name() == "mul" and
+           std::all_of(square->inputs().begin(), square->inputs().end(), [&](auto input) {
+               return input == x;
+           });
+}
+
+// Find the instruction that multiplies y by x and 0.5 in any order. This is
+// the end of the program when there is none.
+static instruction_ref find_half_product(const program& p, instruction_ref y, instruction_ref x)
+{
+    if(y->outputs().size() != 1)
+        return p.end();
+    auto m1 = y->outputs().front();
+    if(m1->name() != "mul")
+        return p.end();
+    auto a = other_input(m1, y);
+    // y * (x * 0.5)
+    if(is_mul_of(a, x, 0.5))
+        return m1;
+    // y * x * 0.5 or y * 0.5 * x
+    if(m1->outputs().size() != 1)
+        return p.end();
+    auto m2 = m1->outputs().front();
+    if(m2->name() != "mul")
+        return p.end();
+    auto b = other_input(m2, m1);
+    if((a == x and is_value(b, 0.5)) or (b == x and is_value(a, 0.5)))
+        return m2;
+    return p.end();
+}
+
+// Replace 0.5 * x * (1 + f) with op applied to x
+template <class Op>
+static void replace_gelu(program& p, instruction_ref f, instruction_ref x, const Op& op)
+{
+    if(f->outputs().size() != 1)
+        return;
+    auto add = f->outputs().front();
+    if(add->name() != "add" or not is_value(other_input(add, f), 1.0))
+        return;
+    auto ins = find_half_product(p, add, x);
+    if(ins == p.end())
+        return;
+    if(ins->get_shape().lens() != x->get_shape().lens() or
+       ins->get_shape().type() != x->get_shape().type())
+        return;
+    p.replace_instruction(ins, op, x);
+}
+
+struct find_gelu_erf
+{
+    auto matcher() const
+    {
+        return match::name("erf")(match::used_once(),
+                                  match::arg(0)(match::any_of(
+                                      match::name("mul")(match::either_arg(0, 1)(
+                                          has_value(M_SQRT1_2), match::any().bind("x"))),
+                                      match::name("div")(match::args(match::any().bind("x"),
+                                                                     has_value(M_SQRT2))))));
+    }
+
+    void apply(program& p, match::matcher_result r) const
+    {
+        replace_gelu(p, r.result, r.instructions["x"], gelu{});
+    }
+};
+
+struct find_gelu_tanh
+{
+    auto matcher() const
+    {
+        return match::name("tanh")(
+            match::used_once(),
+            match::arg(0)(match::name("mul")(match::either_arg(0, 1)(
+                has_value(std::sqrt(M_2_PI)),
+                match::name("add")(match::either_arg(0, 1)(
+                    match::name("mul")(match::either_arg(0, 1)(has_value(0.044715),
+                                                               match::any().bind("cube"))),
+                    match::any().bind("x")))))));
+    }
+
+    void apply(program& p, match::matcher_result r) const
+    {
+        auto x = r.instructions["x"];
+        if(not is_cube(r.instructions["cube"], x))
+            return;
+        if(enabled(MIGRAPHX_DISABLE_FAST_GELU{}))
+            replace_gelu(p, r.result, x, gelu_tanh{});
+        else
+            replace_gelu(p, r.result, x, gelu{});
+    }
+};
+
+void fuse_gelu::apply(program& p) const
+{
+    match::find_matches(p, find_gelu_erf{}, find_gelu_tanh{});
+}
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
@@ -0,0 +1,76 @@
+#include <migraphx/cpu/fuse_pointwise.hpp>
+#include <migraphx/cpu/pointwise.hpp>
+#include <migraphx/program.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/iterator_for.hpp>
+#include <migraphx/functional.hpp>
+#include <migraphx/ranges.hpp>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace cpu {
+
+// The chain is evaluated in the type of its output, so every input needs to
+// have the same type
+static bool is_fusible(instruction_ref ins)
+{
+    if(not is_pointwise(ins->get_operator()))
+        return false;
+    return std::all_of(ins->inputs().begin(), ins->inputs().end(), [&](auto input) {
+        return input->get_shape().type() == ins->get_shape().type();
+    });
+}
+
+void fuse_pointwise::apply(program& p) const
+{
+    std::unordered_set<instruction_ref> fused;
+    for(auto ins : reverse_iterator_for(p))
+    {
+        if(contains(fused, ins) or not is_fusible(ins))
+            continue;
+        // Collect the instructions of the chain so the inputs of an
+        // instruction come before it. An instruction joins the chain when
+        // the chain is its only user.
+        std::vector<instruction_ref> chain;
+        std::unordered_set<instruction_ref> members;
+        std::vector<instruction_ref> inputs;
+        std::unordered_map<instruction_ref, std::size_t> values;
+        fix([&](auto self, instruction_ref x) -> void {
+            members.insert(x);
+            for(auto input : x->inputs())
+            {
+                if(contains(members, input) or contains(values, input))
+                    continue;
+                if(is_fusible(input) and input->outputs().size() == 1)
+                {
+                    self(input);
+                }
+                else
+                {
+                    values[input] = inputs.size();
+                    inputs.push_back(input);
+                }
+            }
+            chain.push_back(x);
+        })(ins);
+        if(chain.size() < 2)
+            continue;
+
+        pointwise op;
+        for(auto x : chain)
+        {
+            for(auto input : x->inputs())
+                op.op_inputs.push_back(values.at(input));
+            values[x] = inputs.size() + op.ops.size();
+            op.ops.push_back(x->get_operator());
+        }
+        fused.insert(chain.begin(), chain.end());
+        p.replace_instruction(ins, op, inputs);
+    }
+}
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
@@ -1,8 +1,11 @@
 #include <migraphx/cpu/gemm.hpp>
 #include <migraphx/dfor.hpp>
+#include <migraphx/par_for.hpp>
 #include <migraphx/requires.hpp>
 #include <migraphx/shape_for_each.hpp>
 #include <blaze/math/CustomMatrix.h>
+#include <cassert>
+#include <vector>
 
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
@@ -45,8 +48,13 @@ struct is_fast_gemm_type<float> : std::true_type
 };
 
 template <class T, class F>
-void migemm_impl(
-    tensor_view<T> cmat, tensor_view<T> amat, tensor_view<T> bmat, F alpha, F beta, std::true_type)
+void migemm_impl(tensor_view<T> cmat,
+                 tensor_view<T> amat,
+                 tensor_view<T> bmat,
+                 F alpha,
+                 F beta,
+                 std::true_type,
+                 bool serial = false)
 {
     visit_mat(amat, [&](const auto& a) {
         visit_mat(bmat, [&](const auto& b) {
@@ -56,15 +64,25 @@ void migemm_impl(
             // compute A * B if alpha is 0.0
             if(alpha != 0.0)
             {
-                c = c + alpha * a * b;
+                // Blaze is kept on this thread when the caller already runs
+                // several products in parallel
+                if(serial)
+                    c = c + alpha * blaze::serial(a * b);
+                else
+                    c = c + alpha * a * b;
             }
         });
     });
 }
 
 template <class T, class F>
-void migemm_impl(
-    tensor_view<T> cmat, tensor_view<T> amat, tensor_view<T> bmat, F alpha, F beta, std::false_type)
+void migemm_impl(tensor_view<T> cmat,
+                 tensor_view<T> amat,
+                 tensor_view<T> bmat,
+                 F alpha,
+                 F beta,
+                 std::false_type,
+                 bool = false)
 {
     std::size_t n_dims = cmat.get_shape().lens().size();
     std::size_t dim_0  = n_dims - 2;
@@ -87,20 +105,93 @@ void migemm_impl(
     });
 }
 
+// The offset of each matrix in the batch dimensions of a tensor
+static std::vector<std::size_t> batch_offsets(const shape& s)
+{
+    const auto& lens    = s.lens();
+    const auto& strides = s.strides();
+    std::vector<std::size_t> result;
+    shape batch{s.type(), {lens.begin(), lens.end() - 2}, {strides.begin(), strides.end() - 2}};
+    shape_for_each(batch, [&](const auto& idx) {
+        result.push_back(batch.index(idx.begin(), idx.end()));
+    });
+    return result;
+}
+
+// The matrix at offset in the last two dimensions of a tensor, which like
+// any tensor_view does not keep the data of x alive
+template <class T>
+static tensor_view<T> batch_slice(tensor_view<T> x, std::size_t offset)
+{
+    const auto& s       = x.get_shape();
+    const auto& lens    = s.lens();
+    const auto& strides = s.strides();
+    return {{s.type(), {lens.end() - 2, lens.end()}, {strides.end() - 2, strides.end()}},
+            x.data() + offset};
+}
+
+bool has_leading_dim(const shape& s)
+{
+    const auto& lens    = s.lens();
+    const auto& strides = s.strides();
+    auto n              = lens.size();
+    if(n < 2)
+        return false;
+    // The matrix is transposed when its columns are further apart than its
+    // rows, ignoring a broadcast dimension
+    bool transposed =
+        strides[n - 2] != 0 and strides[n - 1] != 0 and strides[n - 2] < strides[n - 1];
+    if(transposed)
+        return strides[n - 2] == 1 and strides[n - 1] >= lens[n - 2];
+    return strides[n - 1] == 1 and strides[n - 2] >= lens[n - 1];
+}
+
+template <class T, class F>
+void migemm_slice(
+    tensor_view<T> cmat, tensor_view<T> amat, tensor_view<T> bmat, F alpha, F beta, bool serial)
+{
+    if(has_leading_dim(amat.get_shape()) and has_leading_dim(bmat.get_shape()) and
+       has_leading_dim(cmat.get_shape()) and not cmat.get_shape().transposed())
+        migemm_impl(cmat, amat, bmat, alpha, beta, is_fast_gemm_type<T>{}, serial);
+    else
+        migemm_impl(cmat, amat, bmat, alpha, beta, std::false_type{});
+}
+
 template <class T, class F>
 void migemm_impl(tensor_view<T> cmat, tensor_view<T> amat, tensor_view<T> bmat, F alpha, F beta)
 {
-    auto lens = amat.get_shape().lens();
-    bool batch_mul =
-        std::accumulate(
-            lens.rbegin() + 2, lens.rend(), std::size_t{1}, std::multiplies<std::size_t>()) == 1;
-    if(batch_mul)
+    if(cmat.get_shape().lens().size() == 2)
     {
-        migemm_impl(cmat, amat, bmat, alpha, beta, is_fast_gemm_type<T>{});
+        migemm_slice(cmat, amat, bmat, alpha, beta, false);
+        return;
+    }
+    // Each matrix of the batch is multiplied on its own. A and B can be
+    // broadcast across the batch, in which case their offsets repeat.
+    auto c_offsets = batch_offsets(cmat.get_shape());
+    auto a_offsets = batch_offsets(amat.get_shape());
+    auto b_offsets = batch_offsets(bmat.get_shape());
+    assert(a_offsets.size() == c_offsets.size());
+    assert(b_offsets.size() == c_offsets.size());
+    auto n = c_offsets.size();
+    // With fewer matrices than threads, each product is parallelized by
+    // blaze instead
+    bool serial = not is_fast_gemm_type<T>{} or n >= get_thread_pool().size();
+    auto f      = [&](std::size_t i) {
+        migemm_slice(batch_slice(cmat, c_offsets[i]),
+                     batch_slice(amat, a_offsets[i]),
+                     batch_slice(bmat, b_offsets[i]),
+                     alpha,
+                     beta,
+                     serial);
+    };
+    if(serial)
+    {
+        par_for(n, 1, f);
     }
     else
     {
-        migemm_impl(cmat, amat, bmat, alpha, beta, std::false_type{});
+        for(std::size_t i = 0; i < n; i++)
+            f(i);
     }
 }
 
@@ -0,0 +1,100 @@
+#ifndef MIGRAPHX_GUARD_RTGLIB_CPU_ALLOCATE_HPP
+#define MIGRAPHX_GUARD_RTGLIB_CPU_ALLOCATE_HPP
+
+#include <migraphx/argument.hpp>
+#include <migraphx/check_shapes.hpp>
+#include <migraphx/reflect.hpp>
+#include <migraphx/cpu/context.hpp>
+#include <migraphx/config.hpp>
+#include <string>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace cpu {
+
+/// Output buffer of a kernel, which memory_coloring replaces with a load from
+/// the scratch memory
+struct cpu_allocate
+{
+    shape s;
+
+    template <class Self, class F>
+    static auto reflect(Self& self, F f)
+    {
+        return pack(f(self.s, "shape"));
+    }
+
+    std::string name() const { return "cpu::allocate"; }
+    shape compute_shape(const std::vector<shape>& inputs) const
+    {
+        check_shapes{inputs}.has(0);
+        return s;
+    }
+    argument compute(context&, const shape& output_shape, const std::vector<argument>&) const
+    {
+        return argument{output_shape, allocate_aligned};
+    }
+};
+
+/// Output buffer of a kernel whose result is returned from the program. It is
+/// allocated on every run, so the caller can hold on to the results of
+/// previous runs.
+struct cpu_allocate_output
+{
+    shape s;
+
+    template <class Self, class F>
+    static auto reflect(Self& self, F f)
+    {
+        return pack(f(self.s, "shape"));
+    }
+
+    std::string name() const { return "cpu::allocate_output"; }
+    shape compute_shape(const std::vector<shape>& inputs) const
+    {
+        check_shapes{inputs}.has(0);
+        return s;
+    }
+    argument compute(context&, const shape& output_shape, const std::vector<argument>&) const
+    {
+        return argument{output_shape, allocate_aligned};
+    }
+};
+
+/// Memory that is allocated once when the program is finalized and then
+/// reused by every run. It is stored in the context, and a copy of the
+/// program allocates its own the first time it runs.
+struct cpu_allocate_memory
+{
+    shape s;
+    std::string id{};
+
+    template <class Self, class F>
+    static auto reflect(Self& self, F f)
+    {
+        return pack(f(self.s, "shape"), f(self.id, "id"));
+    }
+
+    std::string name() const { return "cpu::allocate_memory"; }
+    shape compute_shape(const std::vector<shape>& inputs) const
+    {
+        check_shapes{inputs}.has(0);
+        return s;
+    }
+
+    argument compute(context& ctx, const shape&, const std::vector<argument>&) const
+    {
+        return ctx.get_preallocation(id, s);
+    }
+
+    void finalize(context& ctx, const shape&, const std::vector<shape>&) const
+    {
+        ctx.get_preallocation(id, s);
+    }
+};
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+
+#endif
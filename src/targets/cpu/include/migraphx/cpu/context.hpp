@@ -1,15 +1,99 @@
 #ifndef MIGRAPHX_GUARD_RTGLIB_CONTEXT_HPP
 #define MIGRAPHX_GUARD_RTGLIB_CONTEXT_HPP
 
+#include <migraphx/argument.hpp>
+#include <migraphx/env.hpp>
 #include <migraphx/config.hpp>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
 namespace cpu {
 
+MIGRAPHX_DECLARE_ENV_VAR(MIGRAPHX_CPU_STREAMS)
+
+/**
+ * @brief A worker thread that runs the tasks pushed to it in order
+ *
+ * The thread is started by the first task. An exception thrown by a task is
+ * rethrown by the next call to `wait`.
+ */
+struct stream
+{
+    stream() = default;
+    stream(const stream&) = delete;
+    stream& operator=(const stream&) = delete;
+    ~stream();
+
+    void push(std::function<void()> f);
+    /// Wait for all of the tasks pushed so far to finish
+    void wait();
+
+    private:
+    void work();
+
+    std::mutex m;
+    std::condition_variable cv;
+    std::deque<std::function<void()>> tasks;
+    bool busy                = false;
+    bool stop                = false;
+    std::exception_ptr error = nullptr;
+    std::thread thread;
+};
+
+/// Counts how many times it has been recorded and how many of those records
+/// have been reached, so a stream waits for the last record of the same run
+struct event
+{
+    /// Signal the event when the tasks pushed to s so far are finished
+    void record(stream& s);
+    /// Make s wait for the last record of the event
+    void wait(stream& s);
+
+    private:
+    std::mutex m;
+    std::condition_variable cv;
+    std::size_t recorded  = 0;
+    std::size_t completed = 0;
+};
+
 struct context
 {
-    void finish() const {}
+    explicit context(std::size_t n = value_of(MIGRAPHX_CPU_STREAMS{}, 1));
+    // A copy waits for the work pushed to x, and then has its own streams,
+    // events and preallocated buffers, so the copies can run at the same time
+    context(const context& x);
+    context& operator=(const context& x);
+
+    /// The buffer preallocated as id for the shape s, like the scratch memory
+    /// planned by memory_coloring. Each copy of the context, and so each copy
+    /// of a program, allocates it once.
+    argument get_preallocation(const std::string& id, const shape& s);
+
+    std::size_t nstreams() const { return streams.size(); }
+    stream& get_stream() { return *streams.at(current_stream); }
+    void set_stream(std::size_t n) { current_stream = n; }
+
+    void create_events(std::size_t num_of_events);
+    event& get_event(std::size_t i) const { return *events.at(i); }
+
+    /// Wait for the tasks of every stream to finish
+    void finish() const;
+
+    private:
+    std::size_t current_stream = 0;
+    std::vector<std::shared_ptr<stream>> streams;
+    std::vector<std::shared_ptr<event>> events;
+    std::unordered_map<std::string, argument> preallocations;
 };
 
 } // namespace cpu
@@ -0,0 +1,44 @@
+#ifndef MIGRAPHX_GUARD_RTGLIB_CPU_CONVOLUTION_HPP
+#define MIGRAPHX_GUARD_RTGLIB_CPU_CONVOLUTION_HPP
+
+#include <migraphx/argument.hpp>
+#include <migraphx/op/convolution.hpp>
+#include <migraphx/op/quant_convolution.hpp>
+#include <migraphx/config.hpp>
+#include <memory>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace cpu {
+
+struct conv_geometry;
+
+/// Precompute the padding and bounds checks of a convolution for the shapes
+/// of its arguments, so they are not rebuilt on every call
+std::shared_ptr<const conv_geometry> make_conv_geometry(const shape& input,
+                                                        const shape& weights,
+                                                        const shape& output,
+                                                        const op::convolution& op);
+std::shared_ptr<const conv_geometry> make_conv_geometry(const shape& input,
+                                                        const shape& weights,
+                                                        const shape& output,
+                                                        const op::quant_convolution& op);
+
+/// The geometry is only used when it was made for the shapes of the
+/// arguments, otherwise it is computed for this call
+void convolution(const argument& result,
+                 const argument& input,
+                 const argument& weights,
+                 const op::convolution& op,
+                 const conv_geometry* geo = nullptr);
+void convolution(const argument& result,
+                 const argument& input,
+                 const argument& weights,
+                 const op::quant_convolution& op,
+                 const conv_geometry* geo = nullptr);
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+
+#endif
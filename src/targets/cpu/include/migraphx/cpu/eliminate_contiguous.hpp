@@ -0,0 +1,40 @@
+#ifndef MIGRAPHX_GUARD_RTGLIB_CPU_ELIMINATE_CONTIGUOUS_HPP
+#define MIGRAPHX_GUARD_RTGLIB_CPU_ELIMINATE_CONTIGUOUS_HPP
+
+#include <string>
+#include <migraphx/instruction_ref.hpp>
+#include <migraphx/shape.hpp>
+#include <migraphx/config.hpp>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+struct program;
+
+namespace cpu {
+
+/// Whether the kernel evaluates each element on its own, reading its inputs
+/// and writing its result in any layout
+bool is_elementwise(const std::string& name);
+
+/// Whether the cpu kernel ins reads its input i when it is stored as s,
+/// instead of a standard copy of it
+bool reads_strided_input(instruction_ref ins, std::size_t i, const shape& s);
+
+/**
+ * Remove the copies auto_contiguous makes of transposed, sliced and
+ * broadcast tensors when the kernels reading them, or reading views of them,
+ * can read the tensors where they are, as declared by reads_strided_input.
+ * This runs after the lowering, so the kernels and their allocations are
+ * known. The results of the program are still copied.
+ */
+struct eliminate_contiguous
+{
+    std::string name() const { return "cpu::eliminate_contiguous"; }
+    void apply(program& p) const;
+};
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef MIGRAPHX_GUARD_RTGLIB_CPU_FUSE_GELU_HPP
+#define MIGRAPHX_GUARD_RTGLIB_CPU_FUSE_GELU_HPP
+
+#include <string>
+#include <migraphx/config.hpp>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+struct program;
+
+namespace cpu {
+
+/**
+ * Replace the operators computing gelu with the erf or the tanh formula by a
+ * gelu operator. Like the gpu, the tanh formula is replaced by the erf
+ * formula unless MIGRAPHX_DISABLE_FAST_GELU is set.
+ */
+struct fuse_gelu
+{
+    std::string name() const { return "cpu::fuse_gelu"; }
+    void apply(program& p) const;
+};
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef MIGRAPHX_GUARD_RTGLIB_CPU_FUSE_POINTWISE_HPP
+#define MIGRAPHX_GUARD_RTGLIB_CPU_FUSE_POINTWISE_HPP
+
+#include <string>
+#include <migraphx/config.hpp>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+struct program;
+
+namespace cpu {
+
+/**
+ * Replace chains of elementwise operators with a pointwise operator, so the
+ * chain is evaluated in one pass without allocating the intermediate results.
+ */
+struct fuse_pointwise
+{
+    std::string name() const { return "cpu::fuse_pointwise"; }
+    void apply(program& p) const;
+};
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef MIGRAPHX_GUARD_RTGLIB_CPU_GELU_HPP
+#define MIGRAPHX_GUARD_RTGLIB_CPU_GELU_HPP
+
+#include <migraphx/op/unary.hpp>
+#include <migraphx/cpu/math.hpp>
+#include <migraphx/config.hpp>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace cpu {
+
+/// x * 0.5 * (1 + erf(x / sqrt(2)))
+struct gelu : op::unary<gelu>
+{
+    auto apply() const
+    {
+        return [](auto x) { return fast_gelu(x); };
+    }
+};
+
+/// 0.5 * x * (1 + tanh(sqrt(2 / pi) * (x + 0.044715 * x^3)))
+struct gelu_tanh : op::unary<gelu_tanh>
+{
+    auto apply() const
+    {
+        return [](auto x) { return fast_gelu_tanh(x); };
+    }
+};
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+
+#endif
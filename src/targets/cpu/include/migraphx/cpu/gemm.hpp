@@ -8,6 +8,11 @@ namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
 namespace cpu {
 
+/// Whether the rows or the columns of the matrices in the last two dimensions
+/// of s are packed, which blaze needs to multiply them in place. Otherwise
+/// migemm falls back to a loop.
+bool has_leading_dim(const shape& s);
+
 void migemm(
     const argument& c_arg, const argument& a_arg, const argument& b_arg, float alpha, float beta);
 void migemm(const argument& c_arg,
@@ -16,6 +21,26 @@ void migemm(const argument& c_arg,
             int32_t alpha,
             int32_t beta);
 
+/// Computes alpha * A * B + beta * C into C for int8 A and B, accumulating in int32
+void quant_gemm(const argument& c_arg,
+                const argument& a_arg,
+                const argument& b_arg,
+                int32_t alpha,
+                int32_t beta);
+
+/// Packs B of quant_gemm in the layout read by the int8 kernels, so constant
+/// weights are only packed once
+argument quant_gemm_pack_b(const argument& b_arg);
+
+/// quant_gemm with B packed by quant_gemm_pack_b, where b_shape is the shape
+/// of B before it was packed
+void quant_gemm_packed(const argument& c_arg,
+                       const argument& a_arg,
+                       const argument& packed_b,
+                       const shape& b_shape,
+                       int32_t alpha,
+                       int32_t beta);
+
 } // namespace cpu
 } // namespace MIGRAPHX_INLINE_NS
 } // namespace migraphx
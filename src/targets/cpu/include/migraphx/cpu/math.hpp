@@ -0,0 +1,265 @@
+#ifndef MIGRAPHX_GUARD_RTGLIB_CPU_MATH_HPP
+#define MIGRAPHX_GUARD_RTGLIB_CPU_MATH_HPP
+
+#include <migraphx/operators.hpp>
+#include <migraphx/config.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace cpu {
+
+// Approximations of the transcendental functions for float. They have no
+// branches or calls, so loops over them can be vectorized by the compiler.
+// The other types use the standard library.
+//
+// The comment of each function has the largest error measured against the
+// double precision result, over a sample of every 97th float.
+
+inline float bit_cast_float(int32_t x)
+{
+    float result;
+    std::memcpy(&result, &x, sizeof(result));
+    return result;
+}
+
+inline int32_t bit_cast_int(float x)
+{
+    int32_t result;
+    std::memcpy(&result, &x, sizeof(result));
+    return result;
+}
+
+// Round to the nearest integer for |x| < 2^22
+inline float round_nearest(float x)
+{
+    const float magic = 12582912.0f; // 1.5 * 2^23
+    return (x + magic) - magic;
+}
+
+// 2^n for an integer n in [-254, 256], split into two factors so both are
+// normal floats
+inline float scale_pow2(float y, int32_t n)
+{
+    auto n1 = n / 2;
+    auto n2 = n - n1;
+    return y * bit_cast_float((n1 + 127) << 23) * bit_cast_float((n2 + 127) << 23);
+}
+
+// At most 1 ulp
+inline float fast_exp(float x)
+{
+    const float log2e = 1.44269504088896341f;
+    // ln(2) split in two, so fx * ln(2) is exact
+    const float ln2_hi = 0.693359375f;
+    const float ln2_lo = -2.12194440e-4f;
+    // nan is replaced before the clamp, since converting it to an integer is
+    // undefined, and selected again at the end
+    bool nan = x != x;
+    // Below this the result is 0, above it is infinity
+    float xc = std::max(std::min(nan ? 0.0f : x, 88.8f), -104.0f);
+    float fx = round_nearest(xc * log2e);
+    float r  = (xc - fx * ln2_hi) - fx * ln2_lo;
+    float p  = 1.9875691500e-4f;
+    p        = p * r + 1.3981999507e-3f;
+    p        = p * r + 8.3334519073e-3f;
+    p        = p * r + 4.1665795894e-2f;
+    p        = p * r + 1.6666665459e-1f;
+    p        = p * r + 5.0000001201e-1f;
+    float y  = p * r * r + r + 1.0f;
+    return nan ? x : scale_pow2(y, static_cast<int32_t>(fx));
+}
+
+// At most 0.8 ulp
+inline float fast_log(float x)
+{
+    const float sqrt_half = 0.707106781186547524f;
+    const float ln2_hi    = 0.693359375f;
+    const float ln2_lo    = -2.12194440e-4f;
+    // Scale denormals to normal floats
+    bool denormal = x < std::numeric_limits<float>::min();
+    float xs      = denormal ? x * 8388608.0f : x; // 2^23
+    auto bits     = bit_cast_int(xs);
+    // The mantissa in [0.5, 1) and the exponent
+    float e = static_cast<float>((bits >> 23) - 126) - (denormal ? 23.0f : 0.0f);
+    float m = bit_cast_float((bits & 0x007fffff) | 0x3f000000);
+    bool lo = m < sqrt_half;
+    e       = lo ? e - 1.0f : e;
+    m       = lo ? m + m - 1.0f : m - 1.0f;
+    float z = m * m;
+    float p = 7.0376836292e-2f;
+    p       = p * m - 1.1514610310e-1f;
+    p       = p * m + 1.1676998740e-1f;
+    p       = p * m - 1.2420140846e-1f;
+    p       = p * m + 1.4249322787e-1f;
+    p       = p * m - 1.6668057665e-1f;
+    p       = p * m + 2.0000714765e-1f;
+    p       = p * m - 2.4999993993e-1f;
+    p       = p * m + 3.3333331174e-1f;
+    float y = p * m * z + e * ln2_lo - 0.5f * z;
+    y       = m + y + e * ln2_hi;
+    // Handle zero, negative numbers, infinity and nan
+    y = x == 0.0f ? -std::numeric_limits<float>::infinity() : y;
+    y = x < 0.0f ? std::numeric_limits<float>::quiet_NaN() : y;
+    return x == std::numeric_limits<float>::infinity() or x != x ? x : y;
+}
+
+// At most 1.3 ulp
+inline float fast_tanh(float x)
+{
+    float a = std::abs(x);
+    // Small values use a polynomial, since 1 - 2 / (exp(2x) + 1) loses the
+    // low bits
+    float z     = x * x;
+    float p     = -5.70498872745e-3f;
+    p           = p * z + 2.06390887954e-2f;
+    p           = p * z - 5.37397155531e-2f;
+    p           = p * z + 1.33314422036e-1f;
+    p           = p * z - 3.33332819422e-1f;
+    float small = p * z * x + x;
+    float large = 1.0f - 2.0f / (fast_exp(a + a) + 1.0f);
+    large       = x < 0.0f ? -large : large;
+    return a < 0.625f ? small : large;
+}
+
+// At most 2.5 ulp
+inline float fast_sigmoid(float x) { return 1.0f / (1.0f + fast_exp(-x)); }
+
+// At most 2.8 ulp
+inline float fast_erf(float x)
+{
+    const float two_over_sqrt_pi = 1.12837916709551257f;
+    float a                      = std::abs(x);
+    // The Taylor series for small values
+    float z     = x * x;
+    float p     = 1.0f / 76204800.0f;
+    p           = p * -z + 1.0f / 6894720.0f;
+    p           = p * -z + 1.0f / 685440.0f;
+    p           = p * -z + 1.0f / 75600.0f;
+    p           = p * -z + 1.0f / 9360.0f;
+    p           = p * -z + 1.0f / 1320.0f;
+    p           = p * -z + 1.0f / 216.0f;
+    p           = p * -z + 1.0f / 42.0f;
+    p           = p * -z + 1.0f / 10.0f;
+    p           = p * -z + 1.0f / 3.0f;
+    p           = p * -z + 1.0f;
+    float small = two_over_sqrt_pi * p * x;
+    // 1 - erfc(x) from Numerical Recipes, with a relative error in erfc below
+    // 1.2e-7
+    float t = 1.0f / (1.0f + 0.5f * a);
+    float q = 0.17087277f;
+    q       = q * t - 0.82215223f;
+    q       = q * t + 1.48851587f;
+    q       = q * t - 1.13520398f;
+    q       = q * t + 0.27886807f;
+    q       = q * t - 0.18628806f;
+    q       = q * t + 0.09678418f;
+    q       = q * t + 0.37409196f;
+    q       = q * t + 1.00002368f;
+    q       = q * t - 1.26551223f;
+    float large = 1.0f - t * fast_exp(q - a * a);
+    large       = x < 0.0f ? -large : large;
+    return a < 1.0f ? small : large;
+}
+
+// The exact gelu: x * 0.5 * (1 + erf(x / sqrt(2)))
+// The error is at most 1.5e-7 times max(1, |gelu(x)|), since 1 + erf(x)
+// cancels for negative x
+inline float fast_gelu(float x)
+{
+    return x * 0.5f * (1.0f + fast_erf(x * static_cast<float>(M_SQRT1_2)));
+}
+
+// The tanh approximation of gelu:
+// 0.5 * x * (1 + tanh(sqrt(2 / pi) * (x + 0.044715 * x^3)))
+// The error is at most 1.2e-7 times max(1, |gelu(x)|)
+inline float fast_gelu_tanh(float x)
+{
+    const float sqrt_2_over_pi = 0.797884560802865356f;
+    return 0.5f * x * (1.0f + fast_tanh(sqrt_2_over_pi * (x + 0.044715f * x * x * x)));
+}
+
+template <class T>
+auto fast_exp(T x)
+{
+    return std::exp(x);
+}
+
+template <class T>
+auto fast_log(T x)
+{
+    return std::log(x);
+}
+
+template <class T>
+auto fast_tanh(T x)
+{
+    return std::tanh(x);
+}
+
+template <class T>
+auto fast_sigmoid(T x)
+{
+    return 1.f / (1.f + std::exp(-x));
+}
+
+template <class T>
+auto fast_erf(T x)
+{
+    return std::erf(x);
+}
+
+template <class T>
+auto fast_gelu(T x)
+{
+    return x * 0.5 * (1 + std::erf(x * M_SQRT1_2));
+}
+
+template <class T>
+auto fast_gelu_tanh(T x)
+{
+    return 0.5 * x * (1 + std::tanh(std::sqrt(M_2_PI) * (x + 0.044715 * x * x * x)));
+}
+
+/// The function to evaluate an elementwise operator with on the cpu, which
+/// uses the approximations above where there is one
+template <class Op>
+auto fast_apply(const Op& op)
+{
+    return op.apply();
+}
+
+inline auto fast_apply(const op::exp&)
+{
+    return [](auto x) { return fast_exp(x); };
+}
+
+inline auto fast_apply(const op::log&)
+{
+    return [](auto x) { return fast_log(x); };
+}
+
+inline auto fast_apply(const op::tanh&)
+{
+    return [](auto x) { return fast_tanh(x); };
+}
+
+inline auto fast_apply(const op::sigmoid&)
+{
+    return [](auto x) { return fast_sigmoid(x); };
+}
+
+inline auto fast_apply(const op::erf&)
+{
+    return [](auto x) { return fast_erf(x); };
+}
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+
+#endif
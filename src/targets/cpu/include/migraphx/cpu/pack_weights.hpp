@@ -0,0 +1,29 @@
+#ifndef MIGRAPHX_GUARD_RTGLIB_CPU_PACK_WEIGHTS_HPP
+#define MIGRAPHX_GUARD_RTGLIB_CPU_PACK_WEIGHTS_HPP
+
+#include <string>
+#include <migraphx/config.hpp>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+struct program;
+
+namespace cpu {
+
+/**
+ * Evaluate the constant weights of dot, convolution and the recurrent
+ * operators into literals stored in the layout their cpu kernels read, so
+ * transposes and copies of the weights are not computed on every run. The
+ * int8 weights of quant_dot are packed further by the lowering.
+ */
+struct pack_weights
+{
+    std::string name() const { return "cpu::pack_weights"; }
+    void apply(program& p) const;
+};
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef MIGRAPHX_GUARD_RTGLIB_CPU_POINTWISE_HPP
+#define MIGRAPHX_GUARD_RTGLIB_CPU_POINTWISE_HPP
+
+#include <migraphx/argument.hpp>
+#include <migraphx/operation.hpp>
+#include <migraphx/reflect.hpp>
+#include <migraphx/config.hpp>
+#include <string>
+#include <vector>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace cpu {
+
+/**
+ * A chain of elementwise operators evaluated in one pass over the data.
+ * Every operator takes its inputs from `op_inputs` in order, where an index
+ * below the number of inputs refers to an input of the instruction and the
+ * indices after it to the results of the earlier operators. The result of
+ * the last operator is the output.
+ */
+struct pointwise
+{
+    std::vector<operation> ops;
+    std::vector<std::size_t> op_inputs;
+
+    template <class Self, class F>
+    static auto reflect(Self& self, F f)
+    {
+        return pack(f(self.ops, "ops"), f(self.op_inputs, "op_inputs"));
+    }
+
+    std::string name() const { return "pointwise"; }
+    shape compute_shape(const std::vector<shape>& inputs) const;
+    argument compute(const shape& output_shape, const std::vector<argument>& args) const;
+    void compute_to(const argument& result, const std::vector<argument>& args) const;
+};
+
+/// Whether the operator can be evaluated by pointwise
+bool is_pointwise(const operation& op);
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+
+#endif
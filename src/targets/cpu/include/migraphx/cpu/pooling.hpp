@@ -0,0 +1,18 @@
+#ifndef MIGRAPHX_GUARD_RTGLIB_CPU_POOLING_HPP
+#define MIGRAPHX_GUARD_RTGLIB_CPU_POOLING_HPP
+
+#include <migraphx/argument.hpp>
+#include <migraphx/op/pooling.hpp>
+#include <migraphx/config.hpp>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace cpu {
+
+void pooling(const argument& result, const argument& input, const op::pooling& op);
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef MIGRAPHX_GUARD_RTGLIB_CPU_PREALLOCATE_PARAM_HPP
+#define MIGRAPHX_GUARD_RTGLIB_CPU_PREALLOCATE_PARAM_HPP
+
+#include <string>
+#include <migraphx/config.hpp>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+struct program;
+
+namespace cpu {
+
+/**
+ * Replace a parameter with memory that is allocated when the program is
+ * finalized, so the scratch parameter from memory_coloring does not need to
+ * be passed to eval.
+ */
+struct preallocate_param
+{
+    std::string param{};
+    std::string name() const { return "cpu::preallocate_param"; }
+    void apply(program& p) const;
+};
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef MIGRAPHX_GUARD_RTGLIB_CPU_PROPAGATE_LAYOUT_HPP
+#define MIGRAPHX_GUARD_RTGLIB_CPU_PROPAGATE_LAYOUT_HPP
+
+#include <string>
+#include <migraphx/shape.hpp>
+#include <migraphx/config.hpp>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+struct program;
+
+namespace cpu {
+
+/// The shape with the lens of s, in NCHW order, stored with the channels
+/// last, as in NHWC
+shape channels_last(const shape& s);
+
+/// Whether s is stored with the channels last and without gaps
+bool is_channels_last(const shape& s);
+
+/**
+ * Run regions of convolutions, pooling, concat and elementwise kernels with
+ * the channels last when their input already is, like the inputs of tf
+ * models. The kernels then write their results with the channels last, the
+ * copies between them are removed, and the kernels that need the standard
+ * layout read a copy made at the boundary of the region. This runs after
+ * the lowering, as the layout is chosen by the allocations of the kernels.
+ */
+struct propagate_layout
+{
+    std::string name() const { return "cpu::propagate_layout"; }
+    void apply(program& p) const;
+};
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+
+#endif
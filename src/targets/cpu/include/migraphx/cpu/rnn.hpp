@@ -0,0 +1,42 @@
+#ifndef MIGRAPHX_GUARD_RTGLIB_CPU_RNN_HPP
+#define MIGRAPHX_GUARD_RTGLIB_CPU_RNN_HPP
+
+#include <migraphx/argument.hpp>
+#include <migraphx/shape.hpp>
+#include <migraphx/op/rnn.hpp>
+#include <migraphx/op/gru.hpp>
+#include <migraphx/op/lstm.hpp>
+#include <migraphx/config.hpp>
+#include <vector>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace cpu {
+
+/// The number of states stored after the hidden states of every step: the
+/// last hidden state and, for lstm, the last cell state
+template <class Op>
+std::size_t rnn_last_states(const Op&)
+{
+    return 1;
+}
+
+inline std::size_t rnn_last_states(const op::lstm&) { return 2; }
+
+/// The layout of W and R, with the lens [directions, gates * hidden_size, k],
+/// that the kernels read without a copy: the matrix of each direction is
+/// stored transposed
+shape rnn_weights_shape(const shape& s);
+
+/// Evaluate a recurrent operator on the inputs in args, which are empty when
+/// they are not used. The result has the shape of the output of the operator,
+/// with rnn_last_states(op) more elements in the first dimension.
+void rnn(const argument& result, const std::vector<argument>& args, const op::rnn& op);
+void rnn(const argument& result, const std::vector<argument>& args, const op::gru& op);
+void rnn(const argument& result, const std::vector<argument>& args, const op::lstm& op);
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef MIGRAPHX_GUARD_RTGLIB_CPU_SCHEDULE_MODEL_HPP
+#define MIGRAPHX_GUARD_RTGLIB_CPU_SCHEDULE_MODEL_HPP
+
+#include <migraphx/config.hpp>
+#include <migraphx/instruction_ref.hpp>
+#include <vector>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+
+struct program;
+struct operation;
+
+namespace cpu {
+
+/**
+ * Schedule the branches of a program on the streams of the context. Every
+ * stream is a worker thread that runs its kernels in order, so the small
+ * operators of a wide graph run at the same time.
+ */
+struct schedule_model
+{
+    std::size_t streams = 0;
+    std::size_t concurrency() const;
+    void sched(program& p, instruction_ref ins, std::size_t n) const;
+    void wait(program& p, instruction_ref ins, std::size_t wait_id) const;
+    void record(program& p, instruction_ref ins, std::size_t wait_id) const;
+    std::size_t weight(const operation& op) const;
+};
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef MIGRAPHX_GUARD_RTGLIB_CPU_SOFTMAX_HPP
+#define MIGRAPHX_GUARD_RTGLIB_CPU_SOFTMAX_HPP
+
+#include <migraphx/argument.hpp>
+#include <migraphx/op/softmax.hpp>
+#include <migraphx/op/logsoftmax.hpp>
+#include <migraphx/config.hpp>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace cpu {
+
+void softmax(const argument& result, const argument& input, const op::softmax& op);
+void softmax(const argument& result, const argument& input, const op::logsoftmax& op);
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+
+#endif
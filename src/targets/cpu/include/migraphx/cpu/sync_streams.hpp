@@ -0,0 +1,27 @@
+#ifndef MIGRAPHX_GUARD_RTGLIB_CPU_SYNC_STREAMS_HPP
+#define MIGRAPHX_GUARD_RTGLIB_CPU_SYNC_STREAMS_HPP
+
+#include <string>
+#include <migraphx/config.hpp>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+struct program;
+
+namespace cpu {
+
+/**
+ * Wait for the streams at the end of a program that was scheduled on more
+ * than one stream, so its results are ready when eval returns.
+ */
+struct sync_streams
+{
+    std::string name() const { return "cpu::sync_streams"; }
+    void apply(program& p) const;
+};
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+
+#endif
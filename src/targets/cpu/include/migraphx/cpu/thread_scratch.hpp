@@ -0,0 +1,31 @@
+#ifndef MIGRAPHX_GUARD_RTGLIB_CPU_THREAD_SCRATCH_HPP
+#define MIGRAPHX_GUARD_RTGLIB_CPU_THREAD_SCRATCH_HPP
+
+#include <migraphx/config.hpp>
+#include <cstddef>
+#include <vector>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace cpu {
+
+/**
+ * A buffer of at least n elements owned by the calling thread. It is
+ * allocated once and reused by every later call on that thread, so a kernel
+ * must only hold it inside one task of par_for, which never runs another
+ * task until it returns.
+ */
+template <class T>
+T* thread_scratch(std::size_t n)
+{
+    thread_local std::vector<T> buffer;
+    if(buffer.size() < n)
+        buffer.resize(n);
+    return buffer.data();
+}
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+
+#endif
@@ -19,13 +19,25 @@
 #include <migraphx/op/argmax.hpp>
 #include <migraphx/op/argmin.hpp>
 #include <migraphx/op/rnn_var_sl_last_output.hpp>
+#include <migraphx/operators.hpp>
 #include <migraphx/shape_for_each.hpp>
 #include <migraphx/iterator_for.hpp>
 #include <migraphx/par_dfor.hpp>
+#include <migraphx/ranges.hpp>
 #include <migraphx/clamp.hpp>
 #include <migraphx/cpu/gemm.hpp>
+#include <migraphx/cpu/convolution.hpp>
+#include <migraphx/cpu/pooling.hpp>
+#include <migraphx/cpu/softmax.hpp>
+#include <migraphx/cpu/rnn.hpp>
+#include <migraphx/cpu/allocate.hpp>
+#include <migraphx/cpu/pointwise.hpp>
+#include <migraphx/cpu/gelu.hpp>
+#include <migraphx/cpu/math.hpp>
 #include <migraphx/register_op.hpp>
+#include <migraphx/serialize.hpp>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <iostream>
 
@@ -47,6 +59,15 @@ typename std::conditional_t<std::is_integral<T>{}, std::make_signed<T>, std::ena
     return x;
 }
 
+// The kernels write their result in the layout of the memory they are given,
+// which propagate_layout can change from the standard layout
+static shape allocated_shape(const shape& s, const shape& alloc)
+{
+    if(s.type() == alloc.type() and s.lens() == alloc.lens())
+        return alloc;
+    return s;
+}
+
 //
 // cpu implemenataion of batch norm for inference
 //
@@ -75,11 +96,19 @@ struct cpu_batch_norm_inference
 
     std::string name() const { return "cpu::batch_norm_inference"; }
 
-    shape compute_shape(const std::vector<shape>& inputs) const { return op.compute_shape(inputs); }
+    shape compute_shape(std::vector<shape> inputs) const
+    {
+        inputs.pop_back();
+        return op.compute_shape(inputs);
+    }
+    std::ptrdiff_t output_alias(const std::vector<shape>& shapes) const
+    {
+        return shapes.size() - 1;
+    }
 
     argument compute(context&, const shape& output_shape, std::vector<argument> args) const
     {
-        argument output{output_shape};
+        argument output = args.back();
 
         double epsilon           = op.epsilon;
         auto input               = args[0];
@@ -136,10 +165,18 @@ struct cpu_lrn
     }
 
     std::string name() const { return "cpu::lrn"; }
-    shape compute_shape(const std::vector<shape>& inputs) const { return op.compute_shape(inputs); }
+    shape compute_shape(std::vector<shape> inputs) const
+    {
+        inputs.pop_back();
+        return op.compute_shape(inputs);
+    }
+    std::ptrdiff_t output_alias(const std::vector<shape>& shapes) const
+    {
+        return shapes.size() - 1;
+    }
     argument compute(context&, shape output_shape, std::vector<argument> args) const
     {
-        argument result{output_shape};
+        argument result = args.back();
         visit_all(result, args[0])([&](auto output, auto input) {
             int n_batch         = output_shape.lens()[0];
             int channels        = output_shape.lens()[1];
@@ -170,21 +207,6 @@ struct cpu_lrn
 };
 MIGRAPHX_REGISTER_OP(cpu_lrn)
 
-template <class V, class T, class... Ts>
-void visit_quantize_impl(V&& v, T&& x, Ts&&... xs)
-{
-    x.visit([&](auto y) { visit_all(xs...)([&](auto... ys) { v(y, ys...); }); });
-}
-
-template <class T, class... Ts>
-auto visit_quantize(T&& x, Ts&&... xs)
-{
-    return [&](auto v) {
-        // Workaround for https://gcc.gnu.org/bugzilla/show_bug.cgi?id=70100
-        visit_quantize_impl(v, x, xs...);
-    };
-}
-
 template <class Op>
 struct cpu_convolution : auto_register_op<cpu_convolution<Op>>
 {
@@ -193,6 +215,8 @@ struct cpu_convolution : auto_register_op<cpu_convolution<Op>>
     cpu_convolution(Op pop) : op(std::move(pop)) {}
 
     Op op;
+    // Built when the program is finalized, it is not part of the operator
+    std::shared_ptr<const conv_geometry> geo = nullptr;
 
     template <class Self, class F>
     static auto reflect(Self& self, F f)
@@ -201,65 +225,26 @@ struct cpu_convolution : auto_register_op<cpu_convolution<Op>>
     }
 
     std::string name() const { return "cpu::" + op.name(); }
-    shape compute_shape(const std::vector<shape>& inputs) const { return op.compute_shape(inputs); }
+    shape compute_shape(std::vector<shape> inputs) const
+    {
+        auto alloc = inputs.back();
+        inputs.pop_back();
+        return allocated_shape(op.compute_shape(inputs), alloc);
+    }
+    std::ptrdiff_t output_alias(const std::vector<shape>& shapes) const
+    {
+        return shapes.size() - 1;
+    }
     argument compute(context&, shape output_shape, std::vector<argument> args) const
     {
-        argument result{output_shape};
-        visit_quantize(result, args[0], args[1])([&](auto output, auto input, auto weights) {
-            auto in_lens = input.get_shape().lens();
-
-            auto wei_lens = weights.get_shape().lens();
-            auto wei_n    = wei_lens[0];
-            auto wei_c    = wei_lens[1];
-            std::vector<std::size_t> win_size(wei_lens.begin() + 1, wei_lens.end());
-
-            par_for(output_shape.elements(), [&](auto i) {
-                auto idx_o = output_shape.multi(i);
-                auto w     = idx_o[1];
-                auto n_dim = idx_o.size();
-
-                std::vector<std::ptrdiff_t> win_start;
-                for(std::size_t dim = 2; dim < n_dim; ++dim)
-                {
-                    auto d_2 = dim - 2;
-                    win_start.push_back(std::ptrdiff_t(idx_o[dim] * op.stride[d_2]) -
-                                        std::ptrdiff_t(op.padding[d_2]));
-                }
-                const auto group_id = w / (wei_n / op.group);
-
-                shape win_shape{output_shape.type(), win_size};
-
-                double acc = 0.0;
-                shape_for_each(win_shape, [&](auto idx_win) {
-                    auto k           = idx_win[0];
-                    const auto in_ch = group_id * wei_c + k;
-                    std::vector<std::ptrdiff_t> idx(idx_o.begin(), idx_o.end());
-                    idx[1] = in_ch;
-                    std::transform(idx_win.begin() + 1,
-                                   idx_win.end(),
-                                   win_start.begin(),
-                                   idx.begin() + 2,
-                                   [](std::ptrdiff_t ii, std::ptrdiff_t jj) { return ii + jj; });
-                    std::vector<std::ptrdiff_t> idx_wei(idx_o.size());
-                    idx_wei[0] = w;
-                    std::copy(idx_win.begin(), idx_win.end(), idx_wei.begin() + 1);
-                    if(std::all_of(idx.begin() + 2, idx.end(), [&](auto ii) { return ii >= 0; }) and
-                       std::equal(idx.begin(),
-                                  idx.end(),
-                                  in_lens.begin(),
-                                  in_lens.end(),
-                                  std::less<std::ptrdiff_t>{}))
-                    {
-                        acc +=
-                            input(idx.begin(), idx.end()) * weights(idx_wei.begin(), idx_wei.end());
-                    }
-                });
-
-                output[i] = acc;
-            });
-        });
+        argument result = args.back();
+        convolution(result, args[0], args[1], op, geo.get());
         return result;
     }
+    void finalize(context&, const shape&, const std::vector<shape>& inputs)
+    {
+        geo = make_conv_geometry(inputs[0], inputs[1], inputs.back(), op);
+    }
 };
 
 template <class Op>
@@ -278,10 +263,18 @@ struct cpu_deconvolution : auto_register_op<cpu_deconvolution<Op>>
     }
 
     std::string name() const { return "cpu::" + op.name(); }
-    shape compute_shape(const std::vector<shape>& inputs) const { return op.compute_shape(inputs); }
+    shape compute_shape(std::vector<shape> inputs) const
+    {
+        inputs.pop_back();
+        return op.compute_shape(inputs);
+    }
+    std::ptrdiff_t output_alias(const std::vector<shape>& shapes) const
+    {
+        return shapes.size() - 1;
+    }
     argument compute(context&, shape output_shape, std::vector<argument> args) const
     {
-        argument result{output_shape};
+        argument result = args.back();
         visit_all(result, args[0], args[1])([&](auto output, auto input, auto weights) {
             using type = typename decltype(output)::value_type;
 
@@ -366,11 +359,19 @@ struct cpu_im2col
     }
 
     static std::string name() { return "cpu::im2col"; }
-    shape compute_shape(const std::vector<shape>& inputs) const { return op.compute_shape(inputs); }
+    shape compute_shape(std::vector<shape> inputs) const
+    {
+        inputs.pop_back();
+        return op.compute_shape(inputs);
+    }
+    std::ptrdiff_t output_alias(const std::vector<shape>& shapes) const
+    {
+        return shapes.size() - 1;
+    }
 
     argument compute(context&, const shape& output_shape, std::vector<argument> args) const
     {
-        argument result{output_shape};
+        argument result    = args.back();
         auto input_shape   = args[0].get_shape();
         auto weights_shape = args[1].get_shape();
         visit_all(result, args[0])([&](auto col, auto input) {
@@ -421,25 +422,11 @@ MIGRAPHX_REGISTER_OP(cpu_im2col)
 struct max_pool
 {
     static std::string name() { return "max"; }
-    static double start() { return std::numeric_limits<double>::lowest(); }
-
-    static double apply(double x, double y)
-    {
-        double m = std::max(x, y);
-        return (m);
-    }
-
-    static double final(double x, double) { return (x); }
 };
 
 struct avg_pool
 {
     static std::string name() { return "average"; }
-    static double start() { return 0.0; }
-
-    static double apply(double x, double y) { return x + y; }
-
-    static double final(double x, double y) { return x / y; }
 };
 
 template <class Op>
@@ -458,53 +445,20 @@ struct cpu_pooling : auto_register_op<cpu_pooling<Op>>
     }
 
     std::string name() const { return "cpu::pooling_" + Op::name(); }
-    shape compute_shape(const std::vector<shape>& inputs) const { return op.compute_shape(inputs); }
-    argument compute(context&, const shape& output_shape, std::vector<argument> args) const
+    shape compute_shape(std::vector<shape> inputs) const
     {
-        argument result{output_shape};
-        visit_all(result, args[0])([&](auto output, auto input) {
-            using type   = typename decltype(output)::value_type;
-            auto in_s    = input.get_shape();
-            auto in_lens = in_s.lens();
-            std::vector<std::size_t> vec_len(in_lens.begin() + 2, in_lens.end());
-
-            par_for(output_shape.elements(), [&](auto i) {
-                auto idx_o = output_shape.multi(i);
-                auto n_dim = idx_o.size();
-                std::vector<std::size_t> win_start;
-                std::vector<std::size_t> win_size;
-                for(std::size_t dim = 2; dim < n_dim; ++dim)
-                {
-                    auto d_2  = dim - 2;
-                    int start = static_cast<int>(idx_o[dim] * op.stride[d_2]) -
-                                static_cast<int>(op.padding[d_2]);
-                    int end = std::min(start + op.lengths[d_2], in_lens[dim]);
-                    start   = std::max(start, 0);
-                    win_start.push_back(start);
-                    win_size.push_back(end - start);
-                }
-
-                shape win_shape{output_shape.type(), win_size};
-                auto pool_size = win_shape.elements();
-                double acc     = Op::start();
-                shape_for_each(win_shape, [&](auto idx_w) {
-                    auto idx = idx_o;
-                    std::transform(idx_w.begin(),
-                                   idx_w.end(),
-                                   win_start.begin(),
-                                   idx.begin() + 2,
-                                   [](auto ii, auto jj) { return ii + jj; });
-                    if(std::all_of(idx.begin() + 2, idx.end(), [&](auto ii) { return ii >= 0; }) and
-                       idx < in_lens)
-                    {
-                        acc = Op::apply(acc, input[in_s.index(idx)]);
-                    }
-                });
-
-                output[i] = type(Op::final(acc, pool_size));
-            });
-        });
-
+        auto alloc = inputs.back();
+        inputs.pop_back();
+        return allocated_shape(op.compute_shape(inputs), alloc);
+    }
+    std::ptrdiff_t output_alias(const std::vector<shape>& shapes) const
+    {
+        return shapes.size() - 1;
+    }
+    argument compute(context&, const shape&, std::vector<argument> args) const
+    {
+        argument result = args.back();
+        pooling(result, args[0], op);
         return result;
     }
 };
@@ -518,11 +472,17 @@ struct cpu_op
         return migraphx::reflect(self.op, f);
     }
     std::string name() const { return "cpu::op"; }
+    value to_value() const { return migraphx::to_value(op); }
+    void from_value(const value& v) { op = migraphx::from_value<operation>(v); }
     shape compute_shape(const std::vector<shape>& inputs) const { return op.compute_shape(inputs); }
     argument compute(context&, const shape& output_shape, const std::vector<argument>& args) const
     {
         return op.compute(output_shape, args);
     }
+    std::ptrdiff_t output_alias(const std::vector<shape>& shapes) const
+    {
+        return op.output_alias(shapes);
+    }
     friend std::ostream& operator<<(std::ostream& os, const cpu_op& x)
     {
         os << "cpu::" << x.op;
@@ -542,24 +502,42 @@ struct cpu_pad
     }
 
     std::string name() const { return "cpu::pad"; }
-    shape compute_shape(const std::vector<shape>& inputs) const { return op.compute_shape(inputs); }
+    shape compute_shape(std::vector<shape> inputs) const
+    {
+        inputs.pop_back();
+        return op.compute_shape(inputs);
+    }
+    std::ptrdiff_t output_alias(const std::vector<shape>& shapes) const
+    {
+        return shapes.size() - 1;
+    }
     argument compute(context&, const shape& output_shape, std::vector<argument> args) const
     {
         assert(output_shape.standard());
-        argument result{output_shape};
+        argument result = args.back();
         result.visit([&](auto output) {
             using type = typename decltype(output)::value_type;
             std::fill(output.begin(), output.end(), pad_clamp<type>(op.value));
         });
 
+        // Copy a row of the last dimension at a time, so the offsets are only
+        // computed once per row
         visit_all(result, args[0])([&](auto output, auto input) {
-            shape_for_each(input.get_shape(), [&](const auto& idx) {
-                std::vector<std::size_t> new_idx(idx.size());
+            const auto& s = input.get_shape();
+            auto lens     = s.lens();
+            auto n        = lens.back();
+            auto stride   = s.strides().back();
+            lens.back()   = 1;
+            std::vector<std::size_t> new_idx(lens.size());
+            shape_for_each(shape{s.type(), lens}, [&](const auto& idx) {
                 std::transform(
                     idx.begin(), idx.end(), op.pads.begin(), new_idx.begin(), [](auto i, auto j) {
                         return i + j;
                     });
-                output(new_idx.begin(), new_idx.end()) = input(idx.begin(), idx.end());
+                auto* x = &input(idx.begin(), idx.end());
+                auto* y = &output(new_idx.begin(), new_idx.end());
+                for(std::size_t i = 0; i < n; i++)
+                    y[i] = x[i * stride];
             });
         });
 
@@ -578,8 +556,9 @@ struct cpu_gemm
         return migraphx::reflect(self.op, f);
     }
     std::string name() const { return "cpu::dot"; }
-    shape compute_shape(const std::vector<shape>& inputs) const
+    shape compute_shape(std::vector<shape> inputs) const
     {
+        inputs.pop_back();
         if(inputs.size() == 3)
         {
             auto c_shape = inputs.at(2);
@@ -587,13 +566,17 @@ struct cpu_gemm
         }
         return op.compute_shape(inputs);
     }
+    std::ptrdiff_t output_alias(const std::vector<shape>& shapes) const
+    {
+        return shapes.size() - 1;
+    }
 
     argument compute(context&, const shape& output_shape, std::vector<argument> args) const
     {
-        argument result{output_shape};
+        argument result = args.back();
         // 3 inputs, it is alpha * A * B + beta * C, then
         // A and B are matrices, and C is of the same shape as A * B
-        if(args.size() == 3)
+        if(args.size() == 4)
         {
             // no need to consider the value of args[2]
             if(op.beta == 0.0f)
@@ -612,7 +595,8 @@ struct cpu_gemm
             return result;
         }
 
-        // 2 input arguments
+        // 2 input arguments, the output buffer is not initialized
+        result.visit([&](auto output) { std::fill(output.begin(), output.end(), 0); });
         migemm(result, args[0], args[1], op.alpha, 0.0f);
 
         return result;
@@ -631,8 +615,9 @@ struct cpu_quant_gemm
     }
 
     std::string name() const { return "cpu::quant_dot"; }
-    shape compute_shape(const std::vector<shape>& inputs) const
+    shape compute_shape(std::vector<shape> inputs) const
     {
+        inputs.pop_back();
         if(inputs.size() == 3)
         {
             auto c_shape = inputs.at(2);
@@ -640,52 +625,79 @@ struct cpu_quant_gemm
         }
         return op.compute_shape(inputs);
     }
+    std::ptrdiff_t output_alias(const std::vector<shape>& shapes) const
+    {
+        return shapes.size() - 1;
+    }
 
-    argument compute(context&, const shape& output_shape, std::vector<argument> args) const
+    argument compute(context&, const shape&, std::vector<argument> args) const
     {
-        argument result{output_shape};
+        argument result = args.back();
         // 3 inputs, it is alpha * A * B + beta * C, then
         // A and B are matrices, and C is of the same shape to A * B
+        if(args.size() == 4 and op.beta != 0)
+        {
+            visit_all(result, args[2])([&](auto output, auto input) {
+                std::copy(input.begin(), input.end(), output.begin());
+            });
+            quant_gemm(result, args[0], args[1], op.alpha, op.beta);
+            return result;
+        }
 
-        // first, convert the args[0] and args[1] from int8_t to int32_t
-        argument arg_0{{shape::int32_type, {args.at(0).get_shape().lens()}}};
-        argument arg_1{{shape::int32_type, {args.at(1).get_shape().lens()}}};
-        arg_0.visit([&](auto output) {
-            args.at(0).visit(
-                [&](auto input) { std::copy(input.begin(), input.end(), output.begin()); });
-        });
+        // The output buffer is not read when beta is 0
+        quant_gemm(result, args[0], args[1], op.alpha, int32_t{0});
+        return result;
+    }
+};
+MIGRAPHX_REGISTER_OP(cpu_quant_gemm)
 
-        arg_1.visit([&](auto output) {
-            args.at(1).visit(
-                [&](auto input) { std::copy(input.begin(), input.end(), output.begin()); });
-        });
+// quant_dot with a constant B, which was packed for the kernels when the
+// program was compiled
+struct cpu_quant_gemm_packed
+{
+    op::quant_dot op;
+    shape b_shape;
 
-        if(args.size() == 3)
-        {
-            // no need to consider the value of args[2]
-            if(op.beta == 0)
-            {
-                result.visit([&](auto output) { std::fill(output.begin(), output.end(), 0); });
-            }
-            else
-            {
-                visit_all(result, args[2])([&](auto output, auto input) {
-                    std::copy(input.begin(), input.end(), output.begin());
-                });
-            }
+    template <class Self, class F>
+    static auto reflect(Self& self, F f)
+    {
+        return pack(
+            f(self.op.alpha, "alpha"), f(self.op.beta, "beta"), f(self.b_shape, "b_shape"));
+    }
 
-            migemm(result, arg_0, arg_1, op.alpha, op.beta);
+    std::string name() const { return "cpu::quant_dot_packed"; }
+    shape compute_shape(std::vector<shape> inputs) const
+    {
+        inputs.pop_back();
+        inputs.at(1) = b_shape;
+        if(inputs.size() == 3)
+        {
+            auto c_shape = inputs.at(2);
+            check_shapes{{c_shape}}.not_broadcasted();
+        }
+        return op.compute_shape(inputs);
+    }
+    std::ptrdiff_t output_alias(const std::vector<shape>& shapes) const
+    {
+        return shapes.size() - 1;
+    }
 
+    argument compute(context&, const shape&, std::vector<argument> args) const
+    {
+        argument result = args.back();
+        if(args.size() == 4 and op.beta != 0)
+        {
+            visit_all(result, args[2])([&](auto output, auto input) {
+                std::copy(input.begin(), input.end(), output.begin());
+            });
+            quant_gemm_packed(result, args[0], args[1], b_shape, op.alpha, op.beta);
             return result;
         }
-
-        // 2 input arguments
-        migemm(result, arg_0, arg_1, op.alpha, int32_t{0});
-
+        quant_gemm_packed(result, args[0], args[1], b_shape, op.alpha, int32_t{0});
         return result;
     }
 };
-MIGRAPHX_REGISTER_OP(cpu_gemm)
+MIGRAPHX_REGISTER_OP(cpu_quant_gemm_packed)
 
 struct leaky_relu_op
 {
@@ -729,23 +741,98 @@ struct cpu_unary : auto_register_op<cpu_unary<Op>>
     std::string name() const { return op.name(); }
     shape compute_shape(const std::vector<shape>& inputs) const
     {
-        check_shapes{inputs}.has(1);
-        auto s = inputs.at(0);
-        return {s.type(), s.lens()};
+        check_shapes{inputs}.has(2);
+        return inputs.back();
+    }
+    std::ptrdiff_t output_alias(const std::vector<shape>& shapes) const
+    {
+        return shapes.size() - 1;
     }
 
     argument compute(context&, const shape& output_shape, std::vector<argument> args) const
     {
-        argument result{output_shape};
+        // The number of elements evaluated by one task
+        const std::size_t block_size = 4096;
+        argument result              = args.back();
         visit_all(result, args[0])([&](auto output, auto input) {
-            assert(input.get_shape().standard());
-            std::transform(input.begin(), input.end(), output.begin(), op.fcn());
+            auto f        = op.fcn();
+            auto n        = output_shape.elements();
+            auto blocks   = (n + block_size - 1) / block_size;
+            const auto& s = input.get_shape();
+            // Both tensors have the same layout without gaps, so they can be
+            // evaluated like standard tensors
+            if(s.packed() and s.strides() == output_shape.strides())
+            {
+                par_for(blocks, [&](auto i) {
+                    auto first = i * block_size;
+                    auto last  = std::min(n, first + block_size);
+                    std::transform(
+                        input.data() + first, input.data() + last, output.data() + first, f);
+                });
+            }
+            else
+            {
+                par_for(blocks, [&](auto i) {
+                    auto first = i * block_size;
+                    auto last  = std::min(n, first + block_size);
+                    std::transform(input.strided_begin() + first,
+                                   input.strided_begin() + last,
+                                   output.strided_begin() + first,
+                                   f);
+                });
+            }
         });
 
         return result;
     }
 };
 
+// Evaluates a reference unary operator with the cpu math functions
+template <class Op>
+struct unary_kernel
+{
+    Op op;
+    std::string name() const { return "cpu::" + op.name(); }
+    auto fcn() const { return fast_apply(op); }
+};
+
+// Runs a reference operator that can write its result to the memory it is
+// given, instead of allocating it on every run
+template <class Op>
+struct cpu_out_op : auto_register_op<cpu_out_op<Op>>
+{
+    cpu_out_op() = default;
+
+    cpu_out_op(Op pop) : op(std::move(pop)) {}
+
+    Op op;
+
+    template <class Self, class F>
+    static auto reflect(Self& self, F f)
+    {
+        return migraphx::reflect(self.op, f);
+    }
+
+    std::string name() const { return "cpu::" + op.name(); }
+    shape compute_shape(std::vector<shape> inputs) const
+    {
+        auto alloc = inputs.back();
+        inputs.pop_back();
+        return allocated_shape(op.compute_shape(inputs), alloc);
+    }
+    std::ptrdiff_t output_alias(const std::vector<shape>& shapes) const
+    {
+        return shapes.size() - 1;
+    }
+    argument compute(context&, const shape&, std::vector<argument> args) const
+    {
+        argument result = args.back();
+        args.pop_back();
+        op.compute_to(result, args);
+        return result;
+    }
+};
+
 template <class Op>
 struct cpu_softmax : auto_register_op<cpu_softmax<Op>>
 {
@@ -762,51 +849,60 @@ struct cpu_softmax : auto_register_op<cpu_softmax<Op>>
     }
 
     std::string name() const { return "cpu::" + op.name(); }
-    shape compute_shape(const std::vector<shape>& inputs) const { return op.compute_shape(inputs); }
-    argument compute(context&, const shape& output_shape, std::vector<argument> args) const
+    shape compute_shape(std::vector<shape> inputs) const
     {
-        argument result{output_shape};
-        auto batch_lens    = output_shape.lens();
-        int64_t tuned_axis = (op.axis < 0) ? op.axis + args[0].get_shape().lens().size() : op.axis;
-        std::size_t n_dims = batch_lens[tuned_axis];
-        batch_lens[tuned_axis] = 1;
-        shape batch_shape{shape::int32_type, batch_lens};
+        inputs.pop_back();
+        // The kernel reads the input in any layout
+        inputs.front() = shape{inputs.front().type(), inputs.front().lens()};
+        return op.compute_shape(inputs);
+    }
+    std::ptrdiff_t output_alias(const std::vector<shape>& shapes) const
+    {
+        return shapes.size() - 1;
+    }
+    argument compute(context&, const shape&, std::vector<argument> args) const
+    {
+        argument result = args.back();
+        softmax(result, args[0], op);
+        return result;
+    }
+};
 
-        visit_all(result, args[0])([&](auto output, auto input) {
-            using value_type = typename decltype(input)::value_type;
-            std::vector<value_type> batch_max(batch_shape.elements(),
-                                              std::numeric_limits<value_type>::lowest());
-            std::vector<value_type> batch_sum(batch_shape.elements(), value_type(0));
-            par_for(batch_shape.elements(), [&](auto i) {
-                auto idx = batch_shape.multi(i);
-                for(std::size_t j = 0; j < n_dims; ++j)
-                {
-                    idx[tuned_axis] = j;
-                    batch_max[i]    = std::max(batch_max[i], input(idx.begin(), idx.end()));
-                }
+// Runs a recurrent operator without unrolling its steps. The output holds the
+// hidden states followed by the last states, which are sliced out of it.
+template <class Op>
+struct cpu_rnn : auto_register_op<cpu_rnn<Op>>
+{
+    cpu_rnn() = default;
 
-                for(std::size_t j = 0; j < n_dims; ++j)
-                {
-                    idx[tuned_axis]   = j;
-                    std::size_t index = output_shape.index(idx);
-                    output[index]     = std::exp(input[index] - batch_max[i]);
-                }
+    cpu_rnn(Op pop) : op(std::move(pop)) {}
 
-                for(std::size_t j = 0; j < n_dims; ++j)
-                {
-                    idx[tuned_axis] = j;
-                    batch_sum[i] += output(idx.begin(), idx.end());
-                }
+    Op op;
 
-                for(std::size_t j = 0; j < n_dims; ++j)
-                {
-                    idx[tuned_axis] = j;
-                    output(idx.begin(), idx.end()) =
-                        op.output()(output(idx.begin(), idx.end()), batch_sum[i]);
-                }
-            });
-        });
+    template <class Self, class F>
+    static auto reflect(Self& self, F f)
+    {
+        return migraphx::reflect(self.op, f);
+    }
 
+    std::string name() const { return "cpu::" + op.name(); }
+    shape compute_shape(std::vector<shape> inputs) const
+    {
+        inputs.pop_back();
+        auto s    = op.compute_shape(inputs);
+        auto lens = s.lens();
+        lens[0] += rnn_last_states(op);
+        return {s.type(), lens};
+    }
+    std::ptrdiff_t output_alias(const std::vector<shape>& shapes) const
+    {
+        return shapes.size() - 1;
+    }
+    argument compute(context&, const shape&, std::vector<argument> args) const
+    {
+        argument result = args.back();
+        args.pop_back();
+        rnn(result, args, op);
         return result;
     }
 };
@@ -825,12 +921,17 @@ struct cpu_rnn_var_sl_last_output
 
     shape compute_shape(std::vector<shape> inputs) const
     {
+        inputs.pop_back();
         return op.compute_shape(std::move(inputs));
     }
+    std::ptrdiff_t output_alias(const std::vector<shape>& shapes) const
+    {
+        return shapes.size() - 1;
+    }
 
     argument compute(const shape& output_shape, std::vector<argument> args) const
     {
-        argument result{output_shape};
+        argument result    = args.back();
         auto out_comp_lens = args[0].get_shape().lens();
         out_comp_lens[0]   = 1;
         shape out_comp_s{output_shape.type(), out_comp_lens};
@@ -858,10 +959,30 @@ struct cpu_rnn_var_sl_last_output
 };
 MIGRAPHX_REGISTER_OP(cpu_rnn_var_sl_last_output)
 
+MIGRAPHX_REGISTER_OP(cpu_allocate)
+MIGRAPHX_REGISTER_OP(cpu_allocate_output)
+
 struct cpu_apply
 {
     program* prog;
     std::unordered_map<std::string, std::function<void(instruction_ref)>> apply_map{};
+    std::unordered_set<instruction_ref> prog_outputs{};
+
+    void create_outputs()
+    {
+        if(prog->begin() == prog->end())
+            return;
+        auto last = std::prev(prog->end());
+        if(last->name() == "@return")
+        {
+            for(auto ins : last->inputs())
+                prog_outputs.insert(instruction::get_output_alias(ins));
+        }
+        else
+        {
+            prog_outputs.insert(instruction::get_output_alias(last));
+        }
+    }
 
     template <class T>
     auto simple_op()
@@ -875,15 +996,47 @@ struct cpu_apply
         return [this](instruction_ref ins) { apply_extend_op<T, Op>(ins); };
     }
 
+    template <class Op>
+    auto rnn_op()
+    {
+        return [this](instruction_ref ins) { apply_rnn<Op>(ins); };
+    }
+
+    // Lower operators that can write their result to an allocation
+    template <class... Ops>
+    void add_out_ops()
+    {
+        each_args(
+            [&](auto op) {
+                using op_type        = decltype(op);
+                apply_map[op.name()] = extend_op<cpu_out_op<op_type>, op_type>();
+            },
+            Ops{}...);
+    }
+
+    // Lower unary operators to the parallel cpu_unary kernel
+    template <class... Ops>
+    void add_unary_ops()
+    {
+        each_args(
+            [&](auto op) {
+                using op_type        = decltype(op);
+                apply_map[op.name()] = extend_op<cpu_unary<unary_kernel<op_type>>, op_type>();
+            },
+            Ops{}...);
+    }
+
     void init()
     {
+        create_outputs();
+
         apply_map["batch_norm_inference"] =
             extend_op<cpu_batch_norm_inference, op::batch_norm_inference>();
         apply_map["convolution"] = extend_op<cpu_convolution<op::convolution>, op::convolution>();
         apply_map["deconvolution"] =
             extend_op<cpu_deconvolution<op::deconvolution>, op::deconvolution>();
         apply_map["dot"]       = extend_op<cpu_gemm, op::dot>();
-        apply_map["quant_dot"] = extend_op<cpu_quant_gemm, op::quant_dot>();
+        apply_map["quant_dot"] = [this](instruction_ref ins) { apply_quant_dot(ins); };
         apply_map["quant_convolution"] =
             extend_op<cpu_convolution<op::quant_convolution>, op::quant_convolution>();
         apply_map["elu"]        = extend_op<cpu_unary<elu_op>, op::elu>();
@@ -893,8 +1046,64 @@ struct cpu_apply
         apply_map["lrn"]        = extend_op<cpu_lrn, op::lrn>();
         apply_map["pad"]        = extend_op<cpu_pad, op::pad>();
         apply_map["softmax"]    = extend_op<cpu_softmax<op::softmax>, op::softmax>();
+        apply_map["pointwise"]  = extend_op<cpu_out_op<pointwise>, pointwise>();
         apply_map["rnn_var_sl_last_output"] =
             extend_op<cpu_rnn_var_sl_last_output, op::rnn_var_sl_last_output>();
+        apply_map["rnn"]  = rnn_op<op::rnn>();
+        apply_map["gru"]  = rnn_op<op::gru>();
+        apply_map["lstm"] = rnn_op<op::lstm>();
+
+        add_unary_ops<op::abs,
+                      op::acos,
+                      op::acosh,
+                      op::asin,
+                      op::asinh,
+                      op::atan,
+                      op::atanh,
+                      op::ceil,
+                      op::cos,
+                      op::cosh,
+                      op::erf,
+                      op::exp,
+                      op::floor,
+                      op::log,
+                      op::neg,
+                      op::recip,
+                      op::relu,
+                      op::round,
+                      op::rsqrt,
+                      op::sigmoid,
+                      op::sign,
+                      op::sin,
+                      op::sinh,
+                      op::sqrt,
+                      op::tan,
+                      op::tanh,
+                      gelu,
+                      gelu_tanh>();
+        add_out_ops<op::convert>();
+        add_out_ops<op::add,
+                    op::div,
+                    op::max,
+                    op::min,
+                    op::mul,
+                    op::pow,
+                    op::prelu,
+                    op::sqdiff,
+                    op::sub>();
+        add_out_ops<op::argmax,
+                    op::argmin,
+                    op::clip,
+                    op::concat,
+                    op::contiguous,
+                    op::gather,
+                    op::reduce_max,
+                    op::reduce_mean,
+                    op::reduce_min,
+                    op::reduce_prod,
+                    op::reduce_sum,
+                    op::rnn_var_sl_shift_output,
+                    op::rnn_var_sl_shift_sequence>();
     }
 
     void apply()
@@ -917,6 +1126,15 @@ struct cpu_apply
         }
     }
 
+    // The results of the program get their own buffer on every run, everything
+    // else is planned into the scratch memory by memory_coloring
+    instruction_ref insert_allocation(instruction_ref ins, const shape& s)
+    {
+        if(prog_outputs.count(ins) > 0)
+            return prog->insert_instruction(ins, cpu_allocate_output{s});
+        return prog->insert_instruction(ins, cpu_allocate{s});
+    }
+
     void apply_cpu_op(instruction_ref ins)
     {
         prog->replace_instruction(ins, cpu_op{ins->get_operator()}, ins->inputs());
@@ -931,17 +1149,77 @@ struct cpu_apply
     template <class T, class Op>
     void apply_extend_op(instruction_ref ins)
     {
-        auto&& op = any_cast<Op>(ins->get_operator());
-        prog->replace_instruction(ins, T{op}, ins->inputs());
+        auto&& op   = any_cast<Op>(ins->get_operator());
+        auto inputs = ins->inputs();
+        inputs.push_back(insert_allocation(ins, ins->get_shape()));
+        prog->replace_instruction(ins, T{op}, inputs);
+    }
+
+    // A constant B, which pack_weights turned into a literal, is packed for
+    // the int8 kernels once instead of on every run
+    void apply_quant_dot(instruction_ref ins)
+    {
+        auto&& op   = any_cast<op::quant_dot>(ins->get_operator());
+        auto inputs = ins->inputs();
+        auto b      = inputs.at(1);
+        inputs.push_back(insert_allocation(ins, ins->get_shape()));
+        if(b->name() != "@literal")
+        {
+            prog->replace_instruction(ins, cpu_quant_gemm{op}, inputs);
+            return;
+        }
+        auto packed = quant_gemm_pack_b(b->get_literal().get_argument());
+        inputs[1]   = prog->add_literal(literal{packed.get_shape(), packed.data()});
+        prog->replace_instruction(ins, cpu_quant_gemm_packed{op, b->get_shape()}, inputs);
+    }
+
+    // The last hidden state and, for lstm, the last cell state are the rows
+    // after the hidden states in the output of the kernel, so the operators
+    // returning them become views of it
+    template <class Op>
+    void apply_rnn(instruction_ref ins)
+    {
+        auto&& op         = any_cast<Op>(ins->get_operator());
+        auto seq_len      = static_cast<int64_t>(ins->get_shape().lens()[0]);
+        auto last_outputs = find_all(ins->outputs(), [](auto output) {
+            return contains({"rnn_last_hs_output", "rnn_last_cell_output"}, output->name());
+        });
+        auto lens = ins->get_shape().lens();
+        lens[0] += rnn_last_states(op);
+        shape s{ins->get_shape().type(), lens};
+        bool is_output = prog_outputs.count(ins) > 0 or
+                         std::any_of(last_outputs.begin(), last_outputs.end(), [&](auto output) {
+                             return prog_outputs.count(output) > 0;
+                         });
+        auto alloc = is_output ? prog->insert_instruction(ins, cpu_allocate_output{s})
+                               : prog->insert_instruction(ins, cpu_allocate{s});
+        auto inputs = ins->inputs();
+        inputs.push_back(alloc);
+        auto result = prog->insert_instruction(ins, cpu_rnn<Op>{op}, inputs);
+        for(auto output : last_outputs)
+        {
+            auto row   = seq_len + (output->name() == "rnn_last_cell_output" ? 1 : 0);
+            auto state = prog->insert_instruction(
+                output, cpu_op{op::slice{{0}, {row}, {row + 1}}}, result);
+            prog->replace_instruction(output, cpu_op{op::squeeze{{0}}}, state);
+        }
+        prog->replace_instruction(ins, cpu_op{op::slice{{0}, {0}, {seq_len}}}, result);
     }
 
     void apply_pooling(instruction_ref ins)
     {
-        auto&& op = any_cast<op::pooling>(ins->get_operator());
+        auto&& op   = any_cast<op::pooling>(ins->get_operator());
+        auto inputs = ins->inputs();
         if(op.mode == "max")
-            prog->replace_instruction(ins, cpu_pooling<max_pool>{op}, ins->inputs());
+        {
+            inputs.push_back(insert_allocation(ins, ins->get_shape()));
+            prog->replace_instruction(ins, cpu_pooling<max_pool>{op}, inputs);
+        }
         else if(op.mode == "average")
-            prog->replace_instruction(ins, cpu_pooling<avg_pool>{op}, ins->inputs());
+        {
+            inputs.push_back(insert_allocation(ins, ins->get_shape()));
+            prog->replace_instruction(ins, cpu_pooling<avg_pool>{op}, inputs);
+        }
     }
 };
 
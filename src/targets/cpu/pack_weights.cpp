@@ -0,0 +1,89 @@
+#include <migraphx/cpu/pack_weights.hpp>
+#include <migraphx/cpu/rnn.hpp>
+#include <migraphx/program.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/iterator_for.hpp>
+#include <migraphx/literal.hpp>
+#include <migraphx/ranges.hpp>
+#include <unordered_map>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace cpu {
+
+// The operators whose weights, in input 1, are read as standard tensors
+static bool has_standard_weights(const std::string& name)
+{
+    return contains({"convolution", "deconvolution", "quant_convolution", "dot", "quant_dot"},
+                    name);
+}
+
+// The recurrent operators, whose weights W and R are inputs 1 and 2
+static bool has_rnn_weights(const std::string& name)
+{
+    return contains({"rnn", "gru", "lstm"}, name);
+}
+
+struct weights_packer
+{
+    program* prog;
+    // The literals already added for each constant, so weights shared by
+    // several operators are only evaluated once
+    std::unordered_map<instruction_ref, instruction_ref> standard{};
+    std::unordered_map<instruction_ref, instruction_ref> transposed{};
+
+    // The constant w as a literal with the shape s, which only changes the
+    // layout of w
+    instruction_ref pack(instruction_ref w,
+                         const shape& s,
+                         std::unordered_map<instruction_ref, instruction_ref>& packed)
+    {
+        if(w->name() == "@literal" and w->get_shape() == s)
+            return w;
+        if(contains(packed, w))
+            return packed.at(w);
+        literal l;
+        w->eval().visit([&](auto x) { l = literal{s, x.to_vector()}; });
+        auto result = prog->add_literal(l);
+        packed.emplace(w, result);
+        return result;
+    }
+
+    void apply()
+    {
+        for(auto ins : iterator_for(*prog))
+        {
+            std::vector<std::size_t> weights;
+            if(has_standard_weights(ins->name()))
+                weights = {1};
+            else if(has_rnn_weights(ins->name()))
+                weights = {1, 2};
+            else
+                continue;
+            auto inputs  = ins->inputs();
+            bool changed = false;
+            for(auto i : weights)
+            {
+                auto w        = inputs.at(i);
+                const auto& s = w->get_shape();
+                // A broadcast is left as it is, since evaluating it would copy
+                // the weights for every batch
+                if(not w->can_eval() or s.broadcasted())
+                    continue;
+                auto p        = has_rnn_weights(ins->name())
+                             ? pack(w, rnn_weights_shape(s), transposed)
+                             : pack(w, shape{s.type(), s.lens()}, standard);
+                changed   = changed or p != w;
+                inputs[i] = p;
+            }
+            if(changed)
+                prog->replace_instruction(ins, ins->get_operator(), inputs);
+        }
+    }
+};
+
+void pack_weights::apply(program& p) const { weights_packer{&p}.apply(); }
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
@@ -0,0 +1,312 @@
+#include <migraphx/cpu/pointwise.hpp>
+#include <migraphx/cpu/gelu.hpp>
+#include <migraphx/cpu/math.hpp>
+#include <migraphx/cpu/thread_scratch.hpp>
+#include <migraphx/check_shapes.hpp>
+#include <migraphx/functional.hpp>
+#include <migraphx/operators.hpp>
+#include <migraphx/par_for.hpp>
+#include <migraphx/permutation.hpp>
+#include <migraphx/reduce_dims.hpp>
+#include <migraphx/register_op.hpp>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <unordered_map>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace cpu {
+
+// The number of elements evaluated at once, small enough for the values of
+// every operator to stay in the cache
+const std::size_t pointwise_block = 1024;
+
+// Calls f(offset, stride, k, count) for the elements first to first + n of s
+// in the order of their indices, split into runs of count elements that lie
+// in one row of the last dimension, where k is the position of the run from
+// first. The offset of a run is only computed once per row.
+template <class F>
+static void for_each_row(const shape& s, std::size_t first, std::size_t n, F f)
+{
+    const auto& lens    = s.lens();
+    const auto& strides = s.strides();
+    auto row_len        = lens.back();
+    auto stride         = strides.back();
+    auto row            = first / row_len;
+    auto col            = first % row_len;
+    for(std::size_t k = 0; k < n; row++, col = 0)
+    {
+        auto offset = col * stride;
+        auto r      = row;
+        for(std::size_t d = lens.size() - 1; d > 0; d--)
+        {
+            offset += (r % lens[d - 1]) * strides[d - 1];
+            r /= lens[d - 1];
+        }
+        auto count = std::min(n - k, row_len - col);
+        f(offset, stride, k, count);
+        k += count;
+    }
+}
+
+template <class F>
+static void each_pointwise_op(F f)
+{
+    each_args(f,
+              op::abs{},
+              op::acos{},
+              op::acosh{},
+              op::asin{},
+              op::asinh{},
+              op::atan{},
+              op::atanh{},
+              op::ceil{},
+              op::convert{},
+              op::cos{},
+              op::cosh{},
+              op::erf{},
+              op::exp{},
+              op::floor{},
+              op::log{},
+              op::neg{},
+              op::recip{},
+              op::relu{},
+              op::round{},
+              op::rsqrt{},
+              op::sigmoid{},
+              op::sign{},
+              op::sin{},
+              op::sinh{},
+              op::sqrt{},
+              op::tan{},
+              op::tanh{},
+              gelu{},
+              gelu_tanh{},
+              op::add{},
+              op::div{},
+              op::max{},
+              op::min{},
+              op::mul{},
+              op::pow{},
+              op::prelu{},
+              op::sqdiff{},
+              op::sub{});
+}
+
+template <class Op>
+using is_unary = std::is_base_of<op::unary<Op>, Op>;
+
+// Evaluates an operator on n elements from the inputs in x
+template <class T>
+using pointwise_kernel = std::function<void(const T* const* x, T* out, std::size_t n)>;
+
+template <class T, class Op, MIGRAPHX_REQUIRES(is_unary<Op>{})>
+static pointwise_kernel<T> make_kernel(const Op& op)
+{
+    return [op](const T* const* x, T* out, std::size_t n) {
+        auto f        = fast_apply(op);
+        const auto* a = x[0];
+        for(std::size_t i = 0; i < n; i++)
+            out[i] = f(a[i]);
+    };
+}
+
+template <class T, class Op, MIGRAPHX_REQUIRES(not is_unary<Op>{})>
+static pointwise_kernel<T> make_kernel(const Op& op)
+{
+    return [op](const T* const* x, T* out, std::size_t n) {
+        auto f        = fast_apply(op);
+        const auto* a = x[0];
+        const auto* b = x[1];
+        for(std::size_t i = 0; i < n; i++)
+            out[i] = f(a[i], b[i]);
+    };
+}
+
+template <class T>
+struct pointwise_entry
+{
+    std::size_t arity = 0;
+    std::function<pointwise_kernel<T>(const operation&)> make;
+};
+
+template <class T>
+static const std::unordered_map<std::string, pointwise_entry<T>>& pointwise_table()
+{
+    static const auto table = [] {
+        std::unordered_map<std::string, pointwise_entry<T>> result;
+        each_pointwise_op([&](auto op) {
+            using op_type     = decltype(op);
+            result[op.name()] = {is_unary<op_type>{} ? 1 : 2, [](const operation& x) {
+                                     return make_kernel<T>(any_cast<op_type>(x));
+                                 }};
+        });
+        return result;
+    }();
+    return table;
+}
+
+bool is_pointwise(const operation& op) { return pointwise_table<float>().count(op.name()) > 0; }
+
+shape pointwise::compute_shape(const std::vector<shape>& inputs) const
+{
+    check_shapes{inputs, *this}.same_type().same_dims();
+    if(inputs.empty() or ops.empty())
+        MIGRAPHX_THROW("POINTWISE: needs inputs and operators");
+    const auto& table = pointwise_table<float>();
+    std::size_t n     = 0;
+    for(std::size_t i = 0; i < ops.size(); i++)
+    {
+        auto it = table.find(ops[i].name());
+        if(it == table.end())
+            MIGRAPHX_THROW("POINTWISE: unsupported operator: " + ops[i].name());
+        // Each operator can only use the inputs and the earlier results
+        for(std::size_t j = 0; j < it->second.arity; j++, n++)
+        {
+            if(n >= op_inputs.size() or op_inputs[n] >= inputs.size() + i)
+                MIGRAPHX_THROW("POINTWISE: invalid inputs for operator " + ops[i].name());
+        }
+    }
+    if(n != op_inputs.size())
+        MIGRAPHX_THROW("POINTWISE: wrong number of operator inputs");
+    return {inputs.front().type(), inputs.front().lens()};
+}
+
+argument pointwise::compute(const shape& output_shape, const std::vector<argument>& args) const
+{
+    argument result{output_shape};
+    compute_to(result, args);
+    return result;
+}
+
+void pointwise::compute_to(const argument& result, const std::vector<argument>& args) const
+{
+    // A result stored in another order without gaps, like nhwc, is evaluated
+    // in the order of its memory, with the dimensions of all the tensors
+    // permuted the same way
+    const auto& s = result.get_shape();
+    if(s.packed() and not s.standard())
+    {
+        auto perm = find_permutation(s);
+        auto ps   = reorder_shape(s, perm);
+        if(ps.standard())
+        {
+            std::vector<argument> pargs;
+            std::transform(
+                args.begin(), args.end(), std::back_inserter(pargs), [&](const auto& arg) {
+                    return arg.reshape(reorder_shape(arg.get_shape(), perm));
+                });
+            this->compute_to(result.reshape(ps), pargs);
+            return;
+        }
+    }
+    result.visit([&](auto output) {
+        using type        = typename decltype(output)::value_type;
+        const auto& table = pointwise_table<type>();
+        std::vector<pointwise_kernel<type>> kernels;
+        std::vector<std::size_t> starts;
+        std::vector<std::size_t> arities;
+        std::size_t start = 0;
+        for(auto&& op : ops)
+        {
+            const auto& e = table.at(op.name());
+            kernels.push_back(e.make(op));
+            starts.push_back(start);
+            arities.push_back(e.arity);
+            start += e.arity;
+        }
+
+        const auto& output_shape = result.get_shape();
+        std::vector<const type*> inputs;
+        std::transform(args.begin(), args.end(), std::back_inserter(inputs), [](const auto& arg) {
+            return arg.template get<type>().data();
+        });
+        // The other inputs are gathered into a block in the order of the output
+        std::vector<bool> direct;
+        std::transform(args.begin(), args.end(), std::back_inserter(direct), [](const auto& arg) {
+            return arg.get_shape().standard();
+        });
+        bool direct_output = output_shape.standard();
+        // The dimensions that are contiguous in every tensor are merged, so
+        // the rows to gather and scatter are as long as possible
+        std::vector<shape> shapes = {output_shape};
+        std::transform(args.begin(), args.end(), std::back_inserter(shapes), [](const auto& arg) {
+            return arg.get_shape();
+        });
+        shapes = reduce_dims(shapes);
+
+        auto n        = output_shape.elements();
+        auto nvalues  = args.size() + ops.size();
+        auto nblocks  = (n + pointwise_block - 1) / pointwise_block;
+        par_for(nblocks, [&](std::size_t i) {
+            auto first = i * pointwise_block;
+            auto len   = std::min(pointwise_block, n - first);
+            auto* buf  = thread_scratch<type>(nvalues * pointwise_block);
+            auto* v    = thread_scratch<const type*>(nvalues);
+            for(std::size_t j = 0; j < args.size(); j++)
+            {
+                if(direct[j])
+                {
+                    v[j] = inputs[j] + first;
+                    continue;
+                }
+                auto* x = buf + j * pointwise_block;
+                for_each_row(
+                    shapes[j + 1], first, len, [&](auto offset, auto stride, auto k, auto count) {
+                        const type* src = inputs[j] + offset;
+                        if(stride == 1)
+                        {
+                            std::copy(src, src + count, x + k);
+                        }
+                        else if(stride == 0)
+                        {
+                            std::fill(x + k, x + k + count, *src);
+                        }
+                        else
+                        {
+                            for(std::size_t e = 0; e < count; e++)
+                                x[k + e] = src[e * stride];
+                        }
+                    });
+                v[j] = x;
+            }
+            for(std::size_t m = 0; m < ops.size(); m++)
+            {
+                auto k    = args.size() + m;
+                auto* out = buf + k * pointwise_block;
+                if(m == ops.size() - 1 and direct_output)
+                    out = output.data() + first;
+                const type* x[2] = {v[op_inputs[starts[m]]], nullptr};
+                if(arities[m] > 1)
+                    x[1] = v[op_inputs[starts[m] + 1]];
+                kernels[m](x, out, len);
+                v[k] = out;
+            }
+            if(not direct_output)
+            {
+                const type* y = v[nvalues - 1];
+                for_each_row(
+                    shapes[0], first, len, [&](auto offset, auto stride, auto k, auto count) {
+                        type* dst = output.data() + offset;
+                        if(stride == 1)
+                        {
+                            std::copy(y + k, y + k + count, dst);
+                        }
+                        else
+                        {
+                            for(std::size_t e = 0; e < count; e++)
+                                dst[e * stride] = y[k + e];
+                        }
+                    });
+            }
+        });
+    });
+}
+
+MIGRAPHX_REGISTER_OP(pointwise)
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
@@ -0,0 +1,282 @@
+#include <migraphx/cpu/pooling.hpp>
+#include <migraphx/cpu/propagate_layout.hpp>
+#include <migraphx/cpu/thread_scratch.hpp>
+#include <migraphx/par_for.hpp>
+#include <migraphx/tensor_view.hpp>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace cpu {
+
+// The smallest number of input elements a thread pools
+constexpr std::size_t min_pool_work = 4096;
+// The number of neighbouring channels a thread pools when they are stored last
+constexpr std::size_t channel_block = 64;
+
+struct max_pooling
+{
+    template <class T>
+    static T start()
+    {
+        return std::numeric_limits<T>::lowest();
+    }
+
+    template <class T>
+    static T apply(T x, T y)
+    {
+        return std::max(x, y);
+    }
+
+    template <class T>
+    static T final(T x, std::size_t)
+    {
+        return x;
+    }
+};
+
+struct avg_pooling
+{
+    template <class T>
+    static T start()
+    {
+        return T(0);
+    }
+
+    template <class T>
+    static T apply(T x, T y)
+    {
+        return x + y;
+    }
+
+    template <class T>
+    static T final(T x, std::size_t n)
+    {
+        return x / T(n);
+    }
+};
+
+// Float and double are pooled in their own type, the other types in double
+template <class T>
+using pool_type = std::conditional_t<std::is_same<T, float>{} or std::is_same<T, double>{},
+                                     T,
+                                     double>;
+
+// The input elements [start, end) of a window
+struct pool_window
+{
+    std::size_t start;
+    std::size_t end;
+};
+
+// The windows of one dimension, clipped to the input
+static std::vector<pool_window> make_windows(
+    std::size_t len, std::size_t out_len, std::size_t k, std::size_t stride, std::size_t pad)
+{
+    std::vector<pool_window> windows(out_len);
+    for(std::size_t i = 0; i < out_len; i++)
+    {
+        auto start = static_cast<std::ptrdiff_t>(i * stride) - static_cast<std::ptrdiff_t>(pad);
+        auto end   = std::min<std::ptrdiff_t>(start + k, len);
+        start      = std::max<std::ptrdiff_t>(start, 0);
+        windows[i] = {std::size_t(start), std::size_t(std::max(start, end))};
+    }
+    return windows;
+}
+
+// Pool the middle dimension of x, viewed as [outer, len, inner], into y,
+// viewed as [outer, windows.size(), inner]. The innermost loop runs over
+// neighbouring elements.
+template <class Mode, class T>
+static void pool_dim(const T* x,
+                     T* y,
+                     std::size_t outer,
+                     std::size_t len,
+                     std::size_t inner,
+                     const std::vector<pool_window>& windows)
+{
+    auto out_len = windows.size();
+    for(std::size_t o = 0; o < outer; o++)
+    {
+        const auto* xo = x + o * len * inner;
+        auto* yo       = y + o * out_len * inner;
+        for(std::size_t i = 0; i < out_len; i++)
+        {
+            auto* yi = yo + i * inner;
+            auto w   = windows[i];
+            if(inner == 1)
+            {
+                T acc = Mode::template start<T>();
+                for(auto j = w.start; j < w.end; j++)
+                    acc = Mode::apply(acc, xo[j]);
+                yi[0] = Mode::final(acc, w.end - w.start);
+                continue;
+            }
+            std::fill(yi, yi + inner, Mode::template start<T>());
+            for(auto j = w.start; j < w.end; j++)
+            {
+                const auto* xj = xo + j * inner;
+                for(std::size_t k = 0; k < inner; k++)
+                    yi[k] = Mode::apply(yi[k], xj[k]);
+            }
+            for(std::size_t k = 0; k < inner; k++)
+                yi[k] = Mode::final(yi[k], w.end - w.start);
+        }
+    }
+}
+
+template <class Mode>
+static void pooling_impl(const argument& result, const argument& input, const op::pooling& op)
+{
+    const auto& in_s  = input.get_shape();
+    const auto& lens  = in_s.lens();
+    const auto& olens = result.get_shape().lens();
+    auto ndim         = lens.size() - 2;
+    auto planes       = lens[0] * lens[1];
+    std::vector<std::size_t> plane_lens(lens.begin() + 2, lens.end());
+    std::vector<std::size_t> plane_strides(in_s.strides().begin() + 2, in_s.strides().end());
+    shape plane_s{in_s.type(), plane_lens, plane_strides};
+    auto plane_size = plane_s.elements();
+    auto out_size   = std::accumulate(
+        olens.begin() + 2, olens.end(), std::size_t{1}, std::multiplies<std::size_t>{});
+    if(planes * plane_size * out_size == 0)
+        return;
+    auto grain = (min_pool_work + plane_size - 1) / plane_size;
+
+    // The window covers the whole input, so every plane is a single reduction
+    bool global = out_size == 1;
+    for(std::size_t d = 0; d < ndim; d++)
+        global = global and op.padding[d] == 0 and op.lengths[d] == plane_lens[d];
+
+    std::vector<std::vector<pool_window>> windows;
+    for(std::size_t d = 0; d < ndim; d++)
+        windows.push_back(make_windows(
+            plane_lens[d], olens[d + 2], op.lengths[d], op.stride[d], op.padding[d]));
+
+    visit_all(result, input)([&](auto output, auto x) {
+        using type     = typename decltype(output)::value_type;
+        using acc_type = pool_type<type>;
+        auto* y        = output.data();
+        auto plane_at  = [&](std::size_t i) {
+            const auto& strides = in_s.strides();
+            return x.data() + (i / lens[1]) * strides[0] + (i % lens[1]) * strides[1];
+        };
+        auto reduce = [](auto first, auto last) {
+            return std::accumulate(
+                first, last, Mode::template start<acc_type>(), [](acc_type a, auto b) {
+                    return Mode::apply(a, acc_type(b));
+                });
+        };
+        // With the channels last, the channels of a pixel are the innermost
+        // dimension that every dimension is pooled over
+        if(is_channels_last(in_s) and is_channels_last(result.get_shape()))
+        {
+            auto channels    = lens[1];
+            auto cblocks     = (channels + channel_block - 1) / channel_block;
+            auto size        = plane_size;
+            auto buffer_size = plane_size;
+            for(std::size_t d = 0; d < ndim; d++)
+            {
+                size        = size / plane_lens[d] * olens[d + 2];
+                buffer_size = std::max(buffer_size, size);
+            }
+            buffer_size *= channel_block;
+            par_for(lens[0] * cblocks, 1, [&](std::size_t i) {
+                auto n         = i / cblocks;
+                auto first     = (i % cblocks) * channel_block;
+                auto cn        = std::min(channel_block, channels - first);
+                auto* a        = thread_scratch<acc_type>(2 * buffer_size);
+                auto* b        = a + buffer_size;
+                const auto* xn = x.data() + n * in_s.strides()[0] + first;
+                for(std::size_t p = 0; p < plane_size; p++)
+                {
+                    const auto* xp = xn + p * channels;
+                    std::transform(xp, xp + cn, a + p * cn, [](auto e) { return acc_type(e); });
+                }
+                std::size_t outer = 1;
+                std::size_t inner = plane_size * cn;
+                for(std::size_t d = 0; d < ndim; d++)
+                {
+                    inner /= plane_lens[d];
+                    pool_dim<Mode>(a, b, outer, plane_lens[d], inner, windows[d]);
+                    outer *= olens[d + 2];
+                    std::swap(a, b);
+                }
+                auto* yn = y + n * result.get_shape().strides()[0] + first;
+                for(std::size_t p = 0; p < out_size; p++)
+                {
+                    std::transform(
+                        a + p * cn, a + (p + 1) * cn, yn + p * channels, [](auto e) {
+                            return type(e);
+                        });
+                }
+            });
+            return;
+        }
+        if(global)
+        {
+            par_for(planes, grain, [&](std::size_t i) {
+                acc_type acc;
+                if(plane_s.standard())
+                {
+                    acc = reduce(plane_at(i), plane_at(i) + plane_size);
+                }
+                else
+                {
+                    auto v = make_view(plane_s, plane_at(i));
+                    acc    = reduce(v.strided_begin(), v.strided_end());
+                }
+                y[i] = type(Mode::final(acc, plane_size));
+            });
+            return;
+        }
+
+        // The dimensions are pooled one after the other, which is exact for
+        // max and for the average, as the size of a clipped window is the
+        // product of its sizes in each dimension. Each thread has two buffers
+        // large enough for the plane pooled along any number of dimensions,
+        // which are kept for the later calls on the thread.
+        std::size_t buffer_size = plane_size;
+        std::size_t size        = plane_size;
+        for(std::size_t d = 0; d < ndim; d++)
+        {
+            size        = size / plane_lens[d] * olens[d + 2];
+            buffer_size = std::max(buffer_size, size);
+        }
+        par_for(planes, grain, [&](std::size_t i) {
+            auto* a = thread_scratch<acc_type>(2 * buffer_size);
+            auto* b = a + buffer_size;
+            auto v  = make_view(plane_s, plane_at(i));
+            std::transform(v.strided_begin(), v.strided_end(), a, [](auto e) {
+                return acc_type(e);
+            });
+            std::size_t outer = 1;
+            std::size_t inner = plane_size;
+            for(std::size_t d = 0; d < ndim; d++)
+            {
+                inner /= plane_lens[d];
+                pool_dim<Mode>(a, b, outer, plane_lens[d], inner, windows[d]);
+                outer *= olens[d + 2];
+                std::swap(a, b);
+            }
+            std::transform(a, a + out_size, y + i * out_size, [](auto e) { return type(e); });
+        });
+    });
+}
+
+void pooling(const argument& result, const argument& input, const op::pooling& op)
+{
+    if(op.mode == "max")
+        pooling_impl<max_pooling>(result, input, op);
+    else
+        pooling_impl<avg_pooling>(result, input, op);
+}
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
@@ -0,0 +1,30 @@
+#include <migraphx/cpu/preallocate_param.hpp>
+#include <migraphx/cpu/allocate.hpp>
+#include <migraphx/program.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/iterator_for.hpp>
+#include <migraphx/register_op.hpp>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace cpu {
+
+MIGRAPHX_REGISTER_OP(cpu_allocate_memory)
+
+void preallocate_param::apply(program& p) const
+{
+    for(auto ins : iterator_for(p))
+    {
+        if(ins->name() != "@param")
+            continue;
+        std::string id = any_cast<builtin::param>(ins->get_operator()).parameter;
+        if(id != param)
+            continue;
+        auto r = p.insert_instruction(ins, cpu_allocate_memory{ins->get_shape(), id});
+        p.replace_instruction(ins, r);
+    }
+}
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
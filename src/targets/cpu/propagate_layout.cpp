@@ -0,0 +1,189 @@
+#include <migraphx/cpu/propagate_layout.hpp>
+#include <migraphx/cpu/allocate.hpp>
+#include <migraphx/cpu/eliminate_contiguous.hpp>
+#include <migraphx/program.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/iterator_for.hpp>
+#include <migraphx/literal.hpp>
+#include <migraphx/permutation.hpp>
+#include <migraphx/register_op.hpp>
+#include <migraphx/ranges.hpp>
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <unordered_map>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace cpu {
+
+// The order of the dimensions in memory: the batch, the spatial dimensions
+// and then the channels
+static std::vector<int64_t> channels_last_permutation(std::size_t n)
+{
+    std::vector<int64_t> perm(n);
+    std::iota(perm.begin() + 1, perm.end() - 1, 2);
+    perm.back() = 1;
+    return perm;
+}
+
+shape channels_last(const shape& s)
+{
+    auto perm = channels_last_permutation(s.lens().size());
+    return reorder_shape({s.type(), reorder_dims(s.lens(), perm)}, invert_permutation(perm));
+}
+
+bool is_channels_last(const shape& s)
+{
+    return s.lens().size() > 2 and not s.standard() and s == channels_last(s);
+}
+
+static bool is_pooling(const std::string& name)
+{
+    return contains({"cpu::pooling_max", "cpu::pooling_average"}, name);
+}
+
+// The convolutions the gemm of the nhwc kernel is used for, which like the
+// standard layout leaves the small windows of depthwise convolutions alone
+static bool is_nhwc_convolution(instruction_ref ins)
+{
+    if(ins->name() != "cpu::convolution")
+        return false;
+    const auto& s = ins->inputs().front()->get_shape();
+    const auto& w = ins->inputs().at(1)->get_shape().lens();
+    if(s.type() != shape::float_type or s.lens().size() != 4)
+        return false;
+    return std::accumulate(w.begin() + 1, w.end(), std::size_t{1}, std::multiplies<>{}) >= 16;
+}
+
+// A transpose that is copied, like the transposes back to nhwc of tf models,
+// which is standard when its input is stored with the channels last
+static bool is_copied_transpose(instruction_ref ins)
+{
+    if(ins->name() != "cpu::op" or
+       ins->get_operator().to_value().at("name").get_string() != "transpose")
+        return false;
+    return std::all_of(ins->outputs().begin(), ins->outputs().end(), [](auto output) {
+        return output->name() == "cpu::contiguous";
+    });
+}
+
+// The kernels that can read input when it is stored with the channels last
+static bool reads_any_layout(instruction_ref ins, instruction_ref input)
+{
+    if(is_pooling(ins->name()) or is_copied_transpose(ins))
+        return true;
+    if(is_nhwc_convolution(ins))
+        return ins->inputs().front() == input and ins->inputs().at(1) != input;
+    auto s             = channels_last(input->get_shape());
+    const auto& inputs = ins->inputs();
+    for(std::size_t i = 0; i < inputs.size(); i++)
+    {
+        if(inputs[i] == input and not reads_strided_input(ins, i, s))
+            return false;
+    }
+    return true;
+}
+
+struct layout_propagation
+{
+    program* prog;
+    // The weights already stored with the channels last
+    std::unordered_map<instruction_ref, instruction_ref> weights{};
+
+    bool all_read_any_layout(instruction_ref ins) const
+    {
+        return std::all_of(ins->outputs().begin(), ins->outputs().end(), [&](auto output) {
+            return reads_any_layout(output, ins);
+        });
+    }
+
+    // Whether the kernel has its result written with the channels last
+    bool has_channels_last_output(instruction_ref ins) const
+    {
+        auto inputs = ins->inputs();
+        inputs.pop_back();
+        auto channels_last_input = [](auto input) {
+            return is_channels_last(input->get_shape());
+        };
+        if(is_nhwc_convolution(ins) or is_pooling(ins->name()))
+            return channels_last_input(inputs.front());
+        if(ins->name() == "cpu::concat")
+            return std::all_of(inputs.begin(), inputs.end(), channels_last_input);
+        // Scalars and biases are read in any layout, so the other inputs decide
+        if(is_elementwise(ins->name()))
+            return std::any_of(inputs.begin(), inputs.end(), channels_last_input) and
+                   std::all_of(inputs.begin(), inputs.end(), [&](auto input) {
+                       return channels_last_input(input) or input->get_shape().broadcasted();
+                   });
+        return false;
+    }
+
+    // A copy is not needed when the input is already standard, or when it is
+    // stored with the channels last and all the kernels reading the copy can
+    // read that layout
+    void remove_copy(instruction_ref ins)
+    {
+        auto input = ins->inputs().front();
+        if(ins->inputs().back()->name() != "cpu::allocate")
+            return;
+        const auto& s = input->get_shape();
+        if(s.standard() or (is_channels_last(s) and all_read_any_layout(ins)))
+            prog->replace_instruction(ins, input);
+    }
+
+    // The weights of the nhwc kernel are stored as [filters, window, channels]
+    void pack_weights(instruction_ref ins)
+    {
+        auto w = ins->inputs().at(1);
+        if(w->name() != "@literal" or is_channels_last(w->get_shape()))
+            return;
+        if(not contains(weights, w))
+        {
+            literal l;
+            w->eval().visit(
+                [&](auto x) { l = literal{channels_last(w->get_shape()), x.to_vector()}; });
+            weights.emplace(w, prog->add_literal(l));
+        }
+        instruction::replace_argument(ins, w, weights.at(w));
+    }
+
+    void set_channels_last(instruction_ref ins)
+    {
+        auto alloc = ins->inputs().back();
+        if(alloc->name() != "cpu::allocate")
+            return;
+        // The kernels that need the standard layout read a copy, which is
+        // made before the layout changes so their shapes stay valid
+        auto outputs = ins->outputs();
+        for(auto output : outputs)
+        {
+            if(reads_any_layout(output, ins))
+                continue;
+            auto copy_alloc = prog->insert_instruction(output, cpu_allocate{ins->get_shape()});
+            auto copy =
+                prog->insert_instruction(output, load_op("cpu::contiguous"), ins, copy_alloc);
+            instruction::replace_argument(output, ins, copy);
+        }
+        if(ins->name() == "cpu::convolution")
+            pack_weights(ins);
+        prog->replace_instruction(alloc, cpu_allocate{channels_last(alloc->get_shape())});
+    }
+
+    void apply()
+    {
+        for(auto ins : iterator_for(*prog))
+        {
+            if(ins->name() == "cpu::contiguous")
+                remove_copy(ins);
+            else if(has_channels_last_output(ins))
+                set_channels_last(ins);
+        }
+    }
+};
+
+void propagate_layout::apply(program& p) const { layout_propagation{&p}.apply(); }
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
@@ -0,0 +1,423 @@
+#include <migraphx/cpu/gemm.hpp>
+#include <migraphx/errors.hpp>
+#include <migraphx/par_for.hpp>
+#include <migraphx/shape_for_each.hpp>
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define MIGRAPHX_CPU_X86_KERNELS 1
+#include <immintrin.h>
+#else
+#define MIGRAPHX_CPU_X86_KERNELS 0
+#endif
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace cpu {
+
+// Each microkernel computes a tile of tile_m rows by tile_n columns of C
+constexpr std::size_t tile_m = 4;
+constexpr std::size_t tile_n = 16;
+// The inner dimension is padded to a multiple of this
+constexpr std::size_t k_align = 4;
+
+enum class int8_isa
+{
+    generic,
+    avx2,
+    avx512_vnni
+};
+
+static int8_isa get_int8_isa()
+{
+#if MIGRAPHX_CPU_X86_KERNELS
+    static const int8_isa isa = [] {
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx512vnni"))
+            return int8_isa::avx512_vnni;
+        if(__builtin_cpu_supports("avx2"))
+            return int8_isa::avx2;
+        return int8_isa::generic;
+    }();
+    return isa;
+#else
+    return int8_isa::generic;
+#endif
+}
+
+// The number of consecutive k values each kernel multiplies at once
+static std::size_t group_size(int8_isa isa) { return isa == int8_isa::avx2 ? 2 : 4; }
+
+// The vnni instructions multiply unsigned by signed bytes, so A is shifted
+// by 128 and the sum of the columns of B times 128 is subtracted afterwards
+static bool shifts_a(int8_isa isa) { return isa == int8_isa::avx512_vnni; }
+
+// The last two dimensions of a tensor as a strided matrix
+struct matrix_layout
+{
+    std::size_t rows       = 0;
+    std::size_t cols       = 0;
+    std::size_t row_stride = 0;
+    std::size_t col_stride = 0;
+    std::vector<std::size_t> batch_offsets;
+};
+
+static matrix_layout make_layout(const shape& s)
+{
+    const auto& lens    = s.lens();
+    const auto& strides = s.strides();
+    auto n              = lens.size();
+    matrix_layout m;
+    m.rows       = lens[n - 2];
+    m.cols       = lens[n - 1];
+    m.row_stride = strides[n - 2];
+    m.col_stride = strides[n - 1];
+    if(n == 2)
+    {
+        m.batch_offsets.push_back(0);
+        return m;
+    }
+    shape batch{s.type(), {lens.begin(), lens.end() - 2}, {strides.begin(), strides.end() - 2}};
+    shape_for_each(batch, [&](const auto& idx) {
+        m.batch_offsets.push_back(batch.index(idx.begin(), idx.end()));
+    });
+    return m;
+}
+
+// Pack tile_m rows of A starting at row, so every group of k values of a row
+// is followed by the same group of the next row
+static void pack_a(int8_t* dst,
+                   const int8_t* a,
+                   const matrix_layout& m,
+                   std::size_t row,
+                   std::size_t k,
+                   std::size_t group,
+                   bool shift)
+{
+    for(std::size_t kk = 0; kk < k; kk += group)
+    {
+        for(std::size_t i = 0; i < tile_m; i++)
+        {
+            for(std::size_t t = 0; t < group; t++)
+            {
+                int8_t x = 0;
+                if(row + i < m.rows and kk + t < m.cols)
+                    x = a[(row + i) * m.row_stride + (kk + t) * m.col_stride];
+                if(shift)
+                    x = static_cast<int8_t>(static_cast<uint8_t>(x) ^ 0x80u);
+                *dst++ = x;
+            }
+        }
+    }
+}
+
+// Pack tile_n columns of B starting at col, so every group of k values of a
+// column is followed by the same group of the next column. The sum of each
+// column is stored in sums.
+static void pack_b(int8_t* dst,
+                   int32_t* sums,
+                   const int8_t* b,
+                   const matrix_layout& m,
+                   std::size_t col,
+                   std::size_t k,
+                   std::size_t group)
+{
+    for(std::size_t kk = 0; kk < k; kk += group)
+    {
+        for(std::size_t j = 0; j < tile_n; j++)
+        {
+            for(std::size_t t = 0; t < group; t++)
+            {
+                int8_t x = 0;
+                if(col + j < m.cols and kk + t < m.rows)
+                    x = b[(kk + t) * m.row_stride + (col + j) * m.col_stride];
+                sums[j] += x;
+                *dst++ = x;
+            }
+        }
+    }
+}
+
+using int8_kernel = void (*)(const int8_t*, const int8_t*, std::size_t, int32_t*);
+
+static void int8_kernel_generic(const int8_t* a, const int8_t* b, std::size_t k, int32_t* c)
+{
+    const std::size_t group = 4;
+    std::fill(c, c + tile_m * tile_n, 0);
+    for(std::size_t kk = 0; kk < k; kk += group, a += tile_m * group, b += tile_n * group)
+    {
+        for(std::size_t i = 0; i < tile_m; i++)
+        {
+            for(std::size_t j = 0; j < tile_n; j++)
+            {
+                int32_t s = 0;
+                for(std::size_t t = 0; t < group; t++)
+                    s += int32_t{a[i * group + t]} * int32_t{b[j * group + t]};
+                c[i * tile_n + j] += s;
+            }
+        }
+    }
+}
+
+#if MIGRAPHX_CPU_X86_KERNELS
+// pmaddubsw saturates the sum of two products to 16 bits, so the bytes are
+// sign extended and multiplied with pmaddwd, which adds pairs of products
+// exactly into 32 bits
+__attribute__((target("avx2"))) static void
+int8_kernel_avx2(const int8_t* a, const int8_t* b, std::size_t k, int32_t* c)
+{
+    const std::size_t group = 2;
+    __m256i acc0[tile_m];
+    __m256i acc1[tile_m];
+    for(std::size_t i = 0; i < tile_m; i++)
+        acc0[i] = acc1[i] = _mm256_setzero_si256();
+    for(std::size_t kk = 0; kk < k; kk += group, a += tile_m * group, b += tile_n * group)
+    {
+        auto b0 = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b)));
+        auto b1 = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + 16)));
+        for(std::size_t i = 0; i < tile_m; i++)
+        {
+            auto lo = static_cast<uint16_t>(int16_t{a[i * group]});
+            auto hi = static_cast<uint16_t>(int16_t{a[i * group + 1]});
+            auto x  = _mm256_set1_epi32(static_cast<int32_t>(lo | (uint32_t{hi} << 16u)));
+            acc0[i] = _mm256_add_epi32(acc0[i], _mm256_madd_epi16(x, b0));
+            acc1[i] = _mm256_add_epi32(acc1[i], _mm256_madd_epi16(x, b1));
+        }
+    }
+    for(std::size_t i = 0; i < tile_m; i++)
+    {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(c + i * tile_n), acc0[i]);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(c + i * tile_n + 8), acc1[i]);
+    }
+}
+
+__attribute__((target("avx512f,avx512vnni"))) static void
+int8_kernel_avx512_vnni(const int8_t* a, const int8_t* b, std::size_t k, int32_t* c)
+{
+    const std::size_t group = 4;
+    __m512i acc[tile_m];
+    for(auto& x : acc)
+        x = _mm512_setzero_si512();
+    for(std::size_t kk = 0; kk < k; kk += group, a += tile_m * group, b += tile_n * group)
+    {
+        auto y = _mm512_loadu_si512(b);
+        for(std::size_t i = 0; i < tile_m; i++)
+        {
+            int32_t x = 0;
+            std::memcpy(&x, a + i * group, sizeof(x));
+            acc[i] = _mm512_dpbusd_epi32(acc[i], _mm512_set1_epi32(x), y);
+        }
+    }
+    for(std::size_t i = 0; i < tile_m; i++)
+        _mm512_storeu_si512(c + i * tile_n, acc[i]);
+}
+#endif
+
+static int8_kernel get_int8_kernel(int8_isa isa)
+{
+#if MIGRAPHX_CPU_X86_KERNELS
+    if(isa == int8_isa::avx512_vnni)
+        return &int8_kernel_avx512_vnni;
+    if(isa == int8_isa::avx2)
+        return &int8_kernel_avx2;
+#endif
+    (void)isa;
+    return &int8_kernel_generic;
+}
+
+// The sizes of the tiles of B packed for a product
+struct packed_b_layout
+{
+    std::size_t k         = 0;
+    std::size_t col_tiles = 0;
+    std::size_t tiles     = 0;
+    std::size_t tile_len  = 0;
+
+    explicit packed_b_layout(const matrix_layout& bm)
+        : k((bm.rows + k_align - 1) / k_align * k_align),
+          col_tiles((bm.cols + tile_n - 1) / tile_n),
+          tiles(bm.batch_offsets.size() * col_tiles),
+          tile_len(tile_n * k)
+    {
+    }
+
+    std::size_t sums() const { return tiles * tile_n; }
+    std::size_t bytes() const { return tiles * tile_len; }
+};
+
+static void pack_all_b(int8_t* packed,
+                       int32_t* sums,
+                       const int8_t* b,
+                       const matrix_layout& bm,
+                       const packed_b_layout& pb,
+                       std::size_t group)
+{
+    std::fill(sums, sums + pb.sums(), 0);
+    par_for(pb.tiles, [&](auto i) {
+        pack_b(packed + i * pb.tile_len,
+               sums + i * tile_n,
+               b + bm.batch_offsets[i / pb.col_tiles],
+               bm,
+               (i % pb.col_tiles) * tile_n,
+               pb.k,
+               group);
+    });
+}
+
+// The product with B already packed for the kernels of isa
+static void quant_gemm_packed_b(const argument& c_arg,
+                                const argument& a_arg,
+                                const int8_t* packed_b,
+                                const int32_t* sums,
+                                const matrix_layout& bm,
+                                int8_isa isa,
+                                int32_t alpha,
+                                int32_t beta)
+{
+    auto am = make_layout(a_arg.get_shape());
+    auto cm = make_layout(c_arg.get_shape());
+    packed_b_layout pb{bm};
+    assert(am.cols == bm.rows);
+    assert(cm.rows == am.rows and cm.cols == bm.cols);
+    assert(am.batch_offsets.size() == cm.batch_offsets.size());
+    assert(bm.batch_offsets.size() == cm.batch_offsets.size());
+
+    auto kernel = get_int8_kernel(isa);
+    auto group  = group_size(isa);
+    auto shift  = shifts_a(isa);
+
+    const auto* a   = reinterpret_cast<const int8_t*>(a_arg.data());
+    auto* c         = reinterpret_cast<int32_t*>(c_arg.data());
+    auto k          = pb.k;
+    auto batches    = cm.batch_offsets.size();
+    auto row_tiles  = (cm.rows + tile_m - 1) / tile_m;
+    auto col_tiles  = pb.col_tiles;
+    auto a_tile_len = tile_m * k;
+    auto b_tile_len = pb.tile_len;
+
+    // Pack A once, so the kernels read it contiguously
+    std::vector<int8_t> packed_a(batches * row_tiles * a_tile_len);
+    par_for(batches * row_tiles, [&](auto i) {
+        pack_a(packed_a.data() + i * a_tile_len,
+               a + am.batch_offsets[i / row_tiles],
+               am,
+               (i % row_tiles) * tile_m,
+               k,
+               group,
+               shift);
+    });
+
+    par_for(batches * row_tiles * col_tiles, [&](auto i) {
+        auto batch    = i / (row_tiles * col_tiles);
+        auto row_tile = batch * row_tiles + (i / col_tiles) % row_tiles;
+        auto col_tile = batch * col_tiles + i % col_tiles;
+        std::array<int32_t, tile_m * tile_n> acc;
+        kernel(packed_a.data() + row_tile * a_tile_len,
+               packed_b + col_tile * b_tile_len,
+               k,
+               acc.data());
+
+        const auto* col_sums = sums + col_tile * tile_n;
+        auto row             = (row_tile - batch * row_tiles) * tile_m;
+        auto col             = (col_tile - batch * col_tiles) * tile_n;
+        auto rows            = std::min(tile_m, cm.rows - row);
+        auto cols            = std::min(tile_n, cm.cols - col);
+        auto* cb             = c + cm.batch_offsets[batch];
+        for(std::size_t ii = 0; ii < rows; ii++)
+        {
+            for(std::size_t jj = 0; jj < cols; jj++)
+            {
+                auto x = acc[ii * tile_n + jj];
+                if(shift)
+                    x -= 128 * col_sums[jj];
+                auto& y = cb[(row + ii) * cm.row_stride + (col + jj) * cm.col_stride];
+                y       = alpha * x + (beta == 0 ? 0 : beta * y);
+            }
+        }
+    });
+}
+
+void quant_gemm(const argument& c_arg,
+                const argument& a_arg,
+                const argument& b_arg,
+                int32_t alpha,
+                int32_t beta)
+{
+    auto bm  = make_layout(b_arg.get_shape());
+    auto isa = get_int8_isa();
+    packed_b_layout pb{bm};
+    std::vector<int8_t> packed_b(pb.bytes());
+    std::vector<int32_t> sums(pb.sums());
+    pack_all_b(packed_b.data(),
+               sums.data(),
+               reinterpret_cast<const int8_t*>(b_arg.data()),
+               bm,
+               pb,
+               group_size(isa));
+    quant_gemm_packed_b(c_arg, a_arg, packed_b.data(), sums.data(), bm, isa, alpha, beta);
+}
+
+// The packed B starts with the group size of the kernels it was packed for,
+// followed by the sums of its columns and its tiles
+argument quant_gemm_pack_b(const argument& b_arg)
+{
+    auto bm    = make_layout(b_arg.get_shape());
+    auto group = static_cast<int32_t>(group_size(get_int8_isa()));
+    packed_b_layout pb{bm};
+    argument result{
+        shape{shape::int8_type, {sizeof(int32_t) * (1 + pb.sums()) + pb.bytes()}}};
+    auto* data = result.data();
+    std::memcpy(data, &group, sizeof(group));
+    pack_all_b(reinterpret_cast<int8_t*>(data + sizeof(int32_t) * (1 + pb.sums())),
+               reinterpret_cast<int32_t*>(data + sizeof(int32_t)),
+               reinterpret_cast<const int8_t*>(b_arg.data()),
+               bm,
+               pb,
+               group);
+    return result;
+}
+
+// B may have been packed on a cpu with other kernels, so the kernels that
+// read its group size are used
+static int8_isa packed_isa(std::size_t group)
+{
+    auto isa = get_int8_isa();
+    if(group_size(isa) == group)
+        return isa;
+    if(group == group_size(int8_isa::generic))
+        return int8_isa::generic;
+    if(group == group_size(int8_isa::avx2) and isa == int8_isa::avx512_vnni)
+        return int8_isa::avx2;
+    MIGRAPHX_THROW("QUANT_GEMM: B was packed for kernels not supported by this cpu");
+}
+
+void quant_gemm_packed(const argument& c_arg,
+                       const argument& a_arg,
+                       const argument& packed_b,
+                       const shape& b_shape,
+                       int32_t alpha,
+                       int32_t beta)
+{
+    auto bm = make_layout(b_shape);
+    packed_b_layout pb{bm};
+    const char* data = packed_b.data();
+    int32_t group    = 0;
+    std::memcpy(&group, data, sizeof(group));
+    quant_gemm_packed_b(c_arg,
+                        a_arg,
+                        reinterpret_cast<const int8_t*>(data + sizeof(int32_t) * (1 + pb.sums())),
+                        reinterpret_cast<const int32_t*>(data + sizeof(int32_t)),
+                        bm,
+                        packed_isa(group),
+                        alpha,
+                        beta);
+}
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
@@ -0,0 +1,566 @@
+#include <migraphx/cpu/rnn.hpp>
+#include <migraphx/cpu/gemm.hpp>
+#include <migraphx/cpu/math.hpp>
+#include <migraphx/shape_for_each.hpp>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace cpu {
+
+// The position of each input of the recurrent operators
+enum rnn_arg
+{
+    rnn_arg_x,
+    rnn_arg_w,
+    rnn_arg_r,
+    rnn_arg_bias,
+    rnn_arg_seq_lens,
+    rnn_arg_initial_h,
+    rnn_arg_initial_c,
+    rnn_arg_peephole,
+    rnn_arg_count
+};
+
+// The activation functions of every direction, filled in from the ones given
+// in the same way as rewrite_rnn. repeat[n] lists the function used in each
+// place when n functions are given.
+static std::vector<operation> actv_funcs(const std::vector<operation>& funcs,
+                                         std::vector<operation> defaults,
+                                         const std::vector<std::vector<std::size_t>>& repeat)
+{
+    if(funcs.empty())
+        return defaults;
+    if(funcs.size() < repeat.size() and not repeat[funcs.size()].empty())
+    {
+        std::vector<operation> result;
+        const auto& idx = repeat[funcs.size()];
+        std::transform(idx.begin(), idx.end(), std::back_inserter(result), [&](auto i) {
+            return funcs.at(i);
+        });
+        return result;
+    }
+    return funcs;
+}
+
+static std::vector<operation> actv_funcs(const op::rnn& op)
+{
+    if(op.direction == op::rnn_direction::bidirectional)
+        return actv_funcs(op.actv_funcs, {op::tanh{}, op::tanh{}}, {{}, {0, 0}});
+    return actv_funcs(op.actv_funcs, {op::tanh{}}, {});
+}
+
+static std::vector<operation> actv_funcs(const op::gru& op)
+{
+    if(op.direction == op::rnn_direction::bidirectional)
+        return actv_funcs(op.actv_funcs,
+                          {op::sigmoid{}, op::tanh{}, op::sigmoid{}, op::tanh{}},
+                          {{}, {0, 0, 0, 0}, {0, 1, 0, 1}, {0, 1, 2, 0}});
+    return actv_funcs(op.actv_funcs, {op::sigmoid{}, op::tanh{}}, {{}, {0, 0}});
+}
+
+static std::vector<operation> actv_funcs(const op::lstm& op)
+{
+    if(op.direction == op::rnn_direction::bidirectional)
+        return actv_funcs(
+            op.actv_funcs,
+            {op::sigmoid{}, op::tanh{}, op::tanh{}, op::sigmoid{}, op::tanh{}, op::tanh{}},
+            {{},
+             {0, 0, 0, 0, 0, 0},
+             {0, 1, 1, 0, 1, 1},
+             {0, 1, 2, 0, 1, 2},
+             {0, 1, 2, 3, 3, 3},
+             {0, 1, 2, 3, 4, 4}});
+    return actv_funcs(
+        op.actv_funcs, {op::sigmoid{}, op::tanh{}, op::tanh{}}, {{}, {0, 0, 0}, {0, 1, 1}});
+}
+
+static bool is_reverse(op::rnn_direction direction, std::size_t d)
+{
+    return direction == op::rnn_direction::reverse or d == 1;
+}
+
+// Applies an activation function to n contiguous elements in place
+template <class T>
+using activation = std::function<void(T*, std::size_t)>;
+
+template <class T, class F>
+static activation<T> elementwise_activation(F f)
+{
+    return [=](T* x, std::size_t n) {
+        std::transform(x, x + n, x, [&](T v) { return static_cast<T>(f(v)); });
+    };
+}
+
+template <class T>
+static activation<T> make_activation(const operation& op)
+{
+    if(op.name() == "sigmoid")
+        return elementwise_activation<T>(fast_apply(op::sigmoid{}));
+    if(op.name() == "tanh")
+        return elementwise_activation<T>(fast_apply(op::tanh{}));
+    if(op.name() == "relu")
+        return elementwise_activation<T>(fast_apply(op::relu{}));
+    // Any other operator is evaluated with its reference implementation
+    return [=](T* x, std::size_t n) {
+        shape s{shape::get_type<T>{}, {n}};
+        auto y = op.compute(s, {argument{s, x}});
+        y.visit([&](auto v) { std::copy(v.begin(), v.end(), x); });
+    };
+}
+
+// c = a * b + beta * c for row-major matrices, where ldc, lda and ldb are the
+// distances between their rows
+template <class T>
+static void gemm(T* c,
+                 std::size_t ldc,
+                 T* a,
+                 std::size_t lda,
+                 T* b,
+                 std::size_t ldb,
+                 std::size_t m,
+                 std::size_t n,
+                 std::size_t k,
+                 float beta)
+{
+    // The old values are not read, so they are not multiplied with 0
+    if(beta == 0.0f)
+    {
+        for(std::size_t i = 0; i < m; i++)
+            std::fill(c + i * ldc, c + i * ldc + n, T(0));
+    }
+    shape::type_t t = shape::get_type<T>{};
+    migemm(argument{shape{t, {m, n}, {ldc, 1}}, c},
+           argument{shape{t, {m, k}, {lda, 1}}, a},
+           argument{shape{t, {k, n}, {ldb, 1}}, b},
+           1.0f,
+           beta);
+}
+
+// The elements of an input in standard order, which are only copied when the
+// input is not standard. The data is null when the input is not used.
+template <class T>
+struct input_data
+{
+    std::vector<T> storage{};
+    T* data = nullptr;
+
+    explicit input_data(const argument& a)
+    {
+        if(a.empty())
+            return;
+        auto v = a.get<T>();
+        if(v.get_shape().standard())
+        {
+            data = v.data();
+        }
+        else
+        {
+            storage = v.to_vector();
+            data    = storage.data();
+        }
+    }
+    input_data(const input_data&) = delete;
+    input_data& operator=(const input_data&) = delete;
+};
+
+shape rnn_weights_shape(const shape& s)
+{
+    const auto& lens = s.lens();
+    return {s.type(), lens, {lens[1] * lens[2], 1, lens[1]}};
+}
+
+// W or R with the matrix of each direction transposed, so its rows are
+// contiguous for the gemms. It is only copied when pack_weights has not
+// already stored it in this layout.
+template <class T>
+struct transposed_weights
+{
+    std::vector<T> storage{};
+    T* data = nullptr;
+
+    explicit transposed_weights(const argument& a)
+    {
+        auto v   = a.get<T>();
+        auto s   = rnn_weights_shape(v.get_shape());
+        if(v.get_shape() == s)
+        {
+            data = v.data();
+            return;
+        }
+        storage.resize(s.elements());
+        auto w = make_view(s, storage.data());
+        shape_for_each(s, [&](const auto& idx) {
+            w(idx.begin(), idx.end()) = v(idx.begin(), idx.end());
+        });
+        data = storage.data();
+    }
+    transposed_weights(const transposed_weights&) = delete;
+    transposed_weights& operator=(const transposed_weights&) = delete;
+};
+
+// The inputs and sizes shared by the recurrent operators, where gates is the
+// number of blocks of hidden_size rows in W and R
+template <class T>
+struct rnn_kernel
+{
+    input_data<T> x;
+    transposed_weights<T> w;
+    transposed_weights<T> r;
+    input_data<T> bias;
+    input_data<T> initial_h;
+    input_data<T> initial_c;
+    input_data<T> peephole;
+    std::size_t gates       = 1;
+    std::size_t seq_len     = 0;
+    std::size_t batch       = 0;
+    std::size_t input_size  = 0;
+    std::size_t directions  = 0;
+    std::size_t hidden_size = 0;
+    // The length of the sequence of each batch
+    std::vector<std::size_t> lens{};
+
+    rnn_kernel(const std::vector<argument>& args, std::size_t g)
+        : x(args[rnn_arg_x]),
+          w(args[rnn_arg_w]),
+          r(args[rnn_arg_r]),
+          bias(args[rnn_arg_bias]),
+          initial_h(args[rnn_arg_initial_h]),
+          initial_c(args[rnn_arg_initial_c]),
+          peephole(args[rnn_arg_peephole]),
+          gates(g)
+    {
+        const auto& xlens = args[rnn_arg_x].get_shape().lens();
+        const auto& rlens = args[rnn_arg_r].get_shape().lens();
+        seq_len           = xlens[0];
+        batch             = xlens[1];
+        input_size        = xlens[2];
+        directions        = rlens[0];
+        hidden_size       = rlens[2];
+        lens.resize(batch, seq_len);
+        if(not args[rnn_arg_seq_lens].empty())
+        {
+            args[rnn_arg_seq_lens].visit([&](auto sl) {
+                auto v = sl.template to_vector<std::int64_t>();
+                std::transform(v.begin(), v.begin() + batch, lens.begin(), [&](auto l) {
+                    return std::min<std::size_t>(std::max<std::int64_t>(l, 0), seq_len);
+                });
+            });
+        }
+    }
+
+    std::size_t gate_size() const { return gates * hidden_size; }
+
+    // The product of the inputs of every step with W^T in one gemm, with the
+    // biases added. Only the first rb_gates gates of the recurrent bias are
+    // added, as the others are used inside the cell.
+    std::vector<T> input_projection(std::size_t d, std::size_t rb_gates) const
+    {
+        auto n = gate_size();
+        auto m = seq_len * batch;
+        std::vector<T> result(m * n);
+        gemm(result.data(),
+             n,
+             x.data,
+             input_size,
+             w.data + d * n * input_size,
+             n,
+             m,
+             n,
+             input_size,
+             0.0f);
+        if(bias.data == nullptr)
+            return result;
+        const T* wb = bias.data + d * 2 * n;
+        const T* rb = wb + n;
+        for(std::size_t i = 0; i < m; i++)
+        {
+            T* row = result.data() + i * n;
+            std::transform(row, row + n, wb, row, std::plus<>{});
+            std::transform(row, row + rb_gates * hidden_size, rb, row, std::plus<>{});
+        }
+        return result;
+    }
+
+    // R^T of a direction, which has gate_size() contiguous columns
+    T* recurrent_weights(std::size_t d) const { return r.data + d * gate_size() * hidden_size; }
+
+    std::vector<T> initial_state(const input_data<T>& s, std::size_t d) const
+    {
+        auto n = batch * hidden_size;
+        std::vector<T> result(n, T(0));
+        if(s.data != nullptr)
+            std::copy(s.data + d * n, s.data + (d + 1) * n, result.begin());
+        return result;
+    }
+
+    // Run the steps of a direction, where step(t, h, c, hn, cn) computes the
+    // states after step t from the states h and c into hn and cn. The hidden
+    // states are written to the output, followed by the last hidden state
+    // and, when there is a cell state, the last cell state.
+    template <class Step>
+    void run(T* output,
+             std::size_t d,
+             bool reverse,
+             std::vector<T>& h,
+             std::vector<T>& c,
+             Step step) const
+    {
+        auto hs = hidden_size;
+        std::vector<T> hn(h.size());
+        std::vector<T> cn(c.size());
+        auto offset = [&](std::size_t t, std::size_t b) {
+            return ((t * directions + d) * batch + b) * hs;
+        };
+        for(std::size_t i = 0; i < seq_len; i++)
+        {
+            auto t = reverse ? seq_len - 1 - i : i;
+            step(t, h, c, hn, cn);
+            for(std::size_t b = 0; b < batch; b++)
+            {
+                T* out = output + offset(t, b);
+                // The states of a sequence stop changing after its last step
+                if(t >= lens[b])
+                {
+                    std::fill(out, out + hs, T(0));
+                    continue;
+                }
+                std::copy(hn.begin() + b * hs, hn.begin() + (b + 1) * hs, h.begin() + b * hs);
+                if(not c.empty())
+                    std::copy(cn.begin() + b * hs, cn.begin() + (b + 1) * hs, c.begin() + b * hs);
+                std::copy(hn.begin() + b * hs, hn.begin() + (b + 1) * hs, out);
+            }
+        }
+        std::copy(h.begin(), h.end(), output + offset(seq_len, 0));
+        if(not c.empty())
+            std::copy(c.begin(), c.end(), output + offset(seq_len + 1, 0));
+    }
+};
+
+static std::vector<argument> rnn_args(std::vector<argument> args)
+{
+    args.resize(rnn_arg_count);
+    return args;
+}
+
+// Ht = f(Xt*(Wi^T) + Ht-1*(Ri^T) + Wbi + Rbi)
+void rnn(const argument& result, const std::vector<argument>& inputs, const op::rnn& op)
+{
+    auto args  = rnn_args(inputs);
+    auto funcs = actv_funcs(op);
+    visit_all(result, args[rnn_arg_x])([&](auto output, auto) {
+        using type = typename decltype(output)::value_type;
+        rnn_kernel<type> k{args, 1};
+        auto hs = k.hidden_size;
+        auto n  = k.batch * hs;
+        for(std::size_t d = 0; d < k.directions; d++)
+        {
+            auto f  = make_activation<type>(funcs.at(d));
+            auto xw = k.input_projection(d, 1);
+            auto rw = k.recurrent_weights(d);
+            auto h  = k.initial_state(k.initial_h, d);
+            std::vector<type> c;
+            k.run(output.data(),
+                  d,
+                  is_reverse(op.direction, d),
+                  h,
+                  c,
+                  [&](auto t, auto& hp, auto&, auto& hn, auto&) {
+                      gemm(hn.data(), hs, hp.data(), hs, rw, hs, k.batch, hs, hs, 0.0f);
+                      const type* xt = xw.data() + t * n;
+                      std::transform(hn.begin(), hn.end(), xt, hn.begin(), std::plus<>{});
+                      f(hn.data(), n);
+                  });
+        }
+    });
+}
+
+// zt = f(Xt*(Wz^T) + Ht-1*(Rz^T) + Wbz + Rbz)
+// rt = f(Xt*(Wr^T) + Ht-1*(Rr^T) + Wbr + Rbr)
+// ht = g(Xt*(Wh^T) + (rt (.) Ht-1)*(Rh^T) + Rbh + Wbh), or when
+// linear_before_reset is set ht = g(Xt*(Wh^T) + (rt (.) (Ht-1*(Rh^T) + Rbh)) + Wbh)
+// Ht = (1 - zt) (.) ht + zt (.) Ht-1
+void rnn(const argument& result, const std::vector<argument>& inputs, const op::gru& op)
+{
+    auto args  = rnn_args(inputs);
+    auto funcs = actv_funcs(op);
+    visit_all(result, args[rnn_arg_x])([&](auto output, auto) {
+        using type = typename decltype(output)::value_type;
+        rnn_kernel<type> k{args, 3};
+        auto hs    = k.hidden_size;
+        auto gs    = k.gate_size();
+        auto n     = k.batch * hs;
+        bool lbr   = op.linear_before_reset != 0;
+        std::vector<type> hr(k.batch * gs);
+        std::vector<type> g(3 * n);
+        for(std::size_t d = 0; d < k.directions; d++)
+        {
+            auto f  = make_activation<type>(funcs.at(2 * d));
+            auto fh = make_activation<type>(funcs.at(2 * d + 1));
+            auto xw = k.input_projection(d, lbr ? 2 : 3);
+            auto rw = k.recurrent_weights(d);
+            auto h  = k.initial_state(k.initial_h, d);
+            // The recurrent bias of ht when it is used inside the cell
+            const type* rbh = (lbr and k.bias.data != nullptr)
+                                  ? k.bias.data + d * 2 * gs + gs + 2 * hs
+                                  : nullptr;
+            std::vector<type> c;
+            k.run(output.data(),
+                  d,
+                  is_reverse(op.direction, d),
+                  h,
+                  c,
+                  [&](auto t, auto& hp, auto&, auto& hn, auto&) {
+                      type* zt = g.data();
+                      type* rt = zt + n;
+                      type* ht = rt + n;
+                      const type* xt = xw.data() + t * k.batch * gs;
+                      gemm(hr.data(),
+                           gs,
+                           hp.data(),
+                           hs,
+                           rw,
+                           gs,
+                           k.batch,
+                           lbr ? gs : 2 * hs,
+                           hs,
+                           0.0f);
+                      for(std::size_t b = 0; b < k.batch; b++)
+                      {
+                          for(std::size_t j = 0; j < hs; j++)
+                          {
+                              auto i   = b * hs + j;
+                              auto row = b * gs;
+                              zt[i]    = xt[row + j] + hr[row + j];
+                              rt[i]   = xt[row + hs + j] + hr[row + hs + j];
+                          }
+                      }
+                      f(zt, n);
+                      f(rt, n);
+                      if(lbr)
+                      {
+                          for(std::size_t b = 0; b < k.batch; b++)
+                          {
+                              for(std::size_t j = 0; j < hs; j++)
+                              {
+                                  auto i    = b * hs + j;
+                                  auto row  = b * gs + 2 * hs;
+                                  type rh   = hr[row + j];
+                                  if(rbh != nullptr)
+                                      rh += rbh[j];
+                                  ht[i] = xt[row + j] + rt[i] * rh;
+                              }
+                          }
+                      }
+                      else
+                      {
+                          std::transform(rt, rt + n, hp.begin(), ht, std::multiplies<>{});
+                          gemm(hr.data() + 2 * hs,
+                               gs,
+                               ht,
+                               hs,
+                               rw + 2 * hs,
+                               gs,
+                               k.batch,
+                               hs,
+                               hs,
+                               0.0f);
+                          for(std::size_t b = 0; b < k.batch; b++)
+                          {
+                              for(std::size_t j = 0; j < hs; j++)
+                              {
+                                  auto row          = b * gs + 2 * hs;
+                                  ht[b * hs + j] = xt[row + j] + hr[row + j];
+                              }
+                          }
+                      }
+                      fh(ht, n);
+                      for(std::size_t i = 0; i < n; i++)
+                          hn[i] = (type(1) - zt[i]) * ht[i] + zt[i] * hp[i];
+                  });
+        }
+    });
+}
+
+// it = f(Xt*(Wi^T) + Ht-1*(Ri^T) + Pi (.) Ct-1 + Wbi + Rbi)
+// ft = f(Xt*(Wf^T) + Ht-1*(Rf^T) + Pf (.) Ct-1 + Wbf + Rbf)
+// ct = g(Xt*(Wc^T) + Ht-1*(Rc^T) + Wbc + Rbc)
+// Ct = ft (.) Ct-1 + it (.) ct
+// ot = f(Xt*(Wo^T) + Ht-1*(Ro^T) + Po (.) Ct + Wbo + Rbo)
+// Ht = ot (.) h(Ct)
+void rnn(const argument& result, const std::vector<argument>& inputs, const op::lstm& op)
+{
+    auto args  = rnn_args(inputs);
+    auto funcs = actv_funcs(op);
+    visit_all(result, args[rnn_arg_x])([&](auto output, auto) {
+        using type = typename decltype(output)::value_type;
+        rnn_kernel<type> k{args, 4};
+        auto hs = k.hidden_size;
+        auto gs = k.gate_size();
+        auto n  = k.batch * hs;
+        std::vector<type> hr(k.batch * gs);
+        std::vector<type> g(4 * n);
+        for(std::size_t d = 0; d < k.directions; d++)
+        {
+            auto f  = make_activation<type>(funcs.at(3 * d));
+            auto fc = make_activation<type>(funcs.at(3 * d + 1));
+            auto fh = make_activation<type>(funcs.at(3 * d + 2));
+            auto xw = k.input_projection(d, 4);
+            auto rw = k.recurrent_weights(d);
+            auto h  = k.initial_state(k.initial_h, d);
+            auto c  = k.initial_state(k.initial_c, d);
+            // The peephole weights in the order i, o, f
+            const type* p = k.peephole.data == nullptr ? nullptr : k.peephole.data + d * 3 * hs;
+            k.run(output.data(),
+                  d,
+                  is_reverse(op.direction, d),
+                  h,
+                  c,
+                  [&](auto t, auto& hp, auto& cp, auto& hn, auto& cn) {
+                      type* it = g.data();
+                      type* ot = it + n;
+                      type* ft = ot + n;
+                      type* ct = ft + n;
+                      const type* xt = xw.data() + t * k.batch * gs;
+                      gemm(hr.data(), gs, hp.data(), hs, rw, gs, k.batch, gs, hs, 0.0f);
+                      for(std::size_t b = 0; b < k.batch; b++)
+                      {
+                          for(std::size_t j = 0; j < hs; j++)
+                          {
+                              auto i   = b * hs + j;
+                              auto row = b * gs;
+                              it[i]    = xt[row + j] + hr[row + j];
+                              ot[i]    = xt[row + hs + j] + hr[row + hs + j];
+                              ft[i]    = xt[row + 2 * hs + j] + hr[row + 2 * hs + j];
+                              ct[i]    = xt[row + 3 * hs + j] + hr[row + 3 * hs + j];
+                              if(p != nullptr)
+                              {
+                                  it[i] += p[j] * cp[i];
+                                  ft[i] += p[2 * hs + j] * cp[i];
+                              }
+                          }
+                      }
+                      f(it, n);
+                      f(ft, n);
+                      fc(ct, n);
+                      for(std::size_t i = 0; i < n; i++)
+                          cn[i] = ft[i] * cp[i] + it[i] * ct[i];
+                      if(p != nullptr)
+                      {
+                          for(std::size_t i = 0; i < n; i++)
+                              ot[i] += p[hs + i % hs] * cn[i];
+                      }
+                      f(ot, n);
+                      std::copy(cn.begin(), cn.end(), hn.begin());
+                      fh(hn.data(), n);
+                      std::transform(ot, ot + n, hn.begin(), hn.begin(), std::multiplies<>{});
+                  });
+        }
+    });
+}
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
@@ -0,0 +1,223 @@
+#include <migraphx/cpu/schedule_model.hpp>
+#include <migraphx/cpu/context.hpp>
+#include <migraphx/register_op.hpp>
+#include <migraphx/ranges.hpp>
+#include <migraphx/serialize.hpp>
+#include <migraphx/program.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/operation.hpp>
+#include <migraphx/context.hpp>
+#include <algorithm>
+#include <iterator>
+#include <unordered_map>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace cpu {
+
+struct record_event
+{
+    std::size_t event = 0;
+    template <class Self, class F>
+    static auto reflect(Self& self, F f)
+    {
+        return pack(f(self.event, "event"));
+    }
+    std::string name() const { return "cpu::record_event"; }
+    shape compute_shape(const std::vector<shape>&) const { return {}; }
+
+    argument compute(context& ctx, const shape&, const std::vector<argument>&) const
+    {
+        ctx.get_event(event).record(ctx.get_stream());
+        return {};
+    }
+
+    void finalize(context& ctx, const shape&, const std::vector<shape>&)
+    {
+        ctx.create_events(event);
+    }
+};
+
+struct wait_event
+{
+    std::size_t event = 0;
+    template <class Self, class F>
+    static auto reflect(Self& self, F f)
+    {
+        return pack(f(self.event, "event"));
+    }
+    std::string name() const { return "cpu::wait_event"; }
+    shape compute_shape(const std::vector<shape>&) const { return {}; }
+
+    argument compute(context& ctx, const shape&, const std::vector<argument>&) const
+    {
+        ctx.get_event(event).wait(ctx.get_stream());
+        return {};
+    }
+};
+
+struct set_stream
+{
+    std::size_t stream = 0;
+    template <class Self, class F>
+    static auto reflect(Self& self, F f)
+    {
+        return pack(f(self.stream, "stream"));
+    }
+    std::string name() const { return "cpu::set_stream"; }
+    shape compute_shape(const std::vector<shape>&) const { return {}; }
+
+    argument compute(context& ctx, const shape&, const std::vector<argument>&) const
+    {
+        ctx.set_stream(stream);
+        return {};
+    }
+    void finalize(context& ctx, const shape&, const std::vector<shape>&) { ctx.set_stream(stream); }
+};
+
+// Run a kernel, which writes to its last argument, on the current stream and
+// return its output without waiting for it. Any other operator waits for the
+// stream to finish first.
+struct async_op
+{
+    operation op;
+    template <class Self, class F>
+    static auto reflect(Self& self, F f)
+    {
+        return migraphx::reflect(self.op, f);
+    }
+    std::string name() const { return "cpu::async"; }
+    value to_value() const { return migraphx::to_value(op); }
+    void from_value(const value& v) { op = migraphx::from_value<operation>(v); }
+    shape compute_shape(const std::vector<shape>& inputs) const { return op.compute_shape(inputs); }
+    argument compute(migraphx::context& ctx,
+                     const shape& output_shape,
+                     const std::vector<argument>& args) const
+    {
+        auto& s = any_cast<context>(ctx).get_stream();
+        std::vector<shape> shapes;
+        std::transform(args.begin(), args.end(), std::back_inserter(shapes), [](const auto& arg) {
+            return arg.get_shape();
+        });
+        auto alias = op.output_alias(shapes);
+        if(alias < 0 or alias + 1 != static_cast<std::ptrdiff_t>(shapes.size()))
+        {
+            s.wait();
+            return op.compute(ctx, output_shape, args);
+        }
+        auto x = op;
+        s.push([=, &ctx] { x.compute(ctx, output_shape, args); });
+        return args.back();
+    }
+    std::ptrdiff_t output_alias(const std::vector<shape>& shapes) const
+    {
+        return op.output_alias(shapes);
+    }
+    void
+    finalize(migraphx::context& ctx, const shape& output_shape, const std::vector<shape>& inputs)
+    {
+        op.finalize(ctx, output_shape, inputs);
+    }
+    friend std::ostream& operator<<(std::ostream& os, const async_op& x)
+    {
+        os << "async::" << x.op;
+        return os;
+    }
+};
+
+MIGRAPHX_REGISTER_OP(record_event)
+MIGRAPHX_REGISTER_OP(wait_event)
+MIGRAPHX_REGISTER_OP(set_stream)
+MIGRAPHX_REGISTER_OP(async_op)
+
+// The operators run by cpu::op that only make a view of their input, so they
+// can run before their input is computed. Other operators, like capture, read
+// their input.
+static bool is_view(const operation& op)
+{
+    if(op.name() != "cpu::op")
+        return false;
+    return contains({"as_shape",
+                     "broadcast",
+                     "flatten",
+                     "identity",
+                     "multibroadcast",
+                     "reshape",
+                     "scalar",
+                     "slice",
+                     "squeeze",
+                     "transpose",
+                     "unsqueeze"},
+                    op.to_value().at("name").get_string());
+}
+
+std::size_t schedule_model::concurrency() const { return streams; }
+void schedule_model::sched(program& p, instruction_ref ins, std::size_t n) const
+{
+    p.replace_instruction(ins, async_op{ins->get_operator()}, ins->inputs());
+    auto last_stream = std::find_if(std::make_reverse_iterator(ins),
+                                    std::make_reverse_iterator(p.begin()),
+                                    [&](auto&& i) { return i.name() == "cpu::set_stream"; });
+    if(last_stream != std::make_reverse_iterator(p.begin()))
+    {
+        auto&& op = any_cast<set_stream>(last_stream->get_operator());
+        // If the same stream was set earlier then skip
+        if(op.stream == n)
+            return;
+    }
+    p.insert_instruction(ins, set_stream{n});
+}
+
+void schedule_model::wait(program& p, instruction_ref ins, std::size_t wait_id) const
+{
+    p.insert_instruction(ins, wait_event{wait_id});
+}
+void schedule_model::record(program& p, instruction_ref ins, std::size_t wait_id) const
+{
+    p.insert_instruction(std::next(ins), record_event{wait_id});
+}
+
+static std::unordered_map<std::string, std::size_t> create_weight_map()
+{
+    // Buffers are not scheduled
+    return {{"cpu::allocate", 0},
+            {"cpu::allocate_output", 0},
+            {"cpu::allocate_memory", 0},
+            {"cpu::convolution", 8},
+            {"cpu::quant_convolution", 8},
+            {"cpu::deconvolution", 8},
+            {"cpu::dot", 4},
+            {"cpu::quant_dot", 4},
+            {"cpu::quant_dot_packed", 4},
+            {"cpu::pooling_max", 4},
+            {"cpu::pooling_average", 4},
+            {"cpu::lrn", 4},
+            {"cpu::rnn", 8},
+            {"cpu::gru", 8},
+            {"cpu::lstm", 8}};
+}
+
+static const std::unordered_map<std::string, std::size_t>& weight_map()
+{
+    static std::unordered_map<std::string, std::size_t> m = create_weight_map();
+    return m;
+}
+
+std::size_t schedule_model::weight(const operation& op) const
+{
+    // Views are not scheduled either, while the other operators run by
+    // cpu::op get a stream so they wait for the streams computing their input
+    if(is_view(op))
+        return 0;
+    if(op.name() == "cpu::op")
+        return 1;
+    if(weight_map().count(op.name()) == 0)
+    {
+        return 2;
+    }
+    return weight_map().at(op.name());
+}
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
@@ -0,0 +1,195 @@
+#include <migraphx/cpu/softmax.hpp>
+#include <migraphx/cpu/math.hpp>
+#include <migraphx/par_for.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <numeric>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace cpu {
+
+// A row is split into at most this many blocks
+constexpr std::size_t max_row_blocks = 64;
+// The smallest number of elements of a block of a row
+constexpr std::size_t min_row_block = 256;
+// The number of columns evaluated together when the axis is not the last one
+constexpr std::size_t column_tile = 64;
+
+// The softmax of a contiguous row in two passes. The first pass takes the
+// maximum of each block and adds the exponentials relative to the largest
+// maximum so far, rescaling the sum when a block has a larger one. The
+// exponentials are stored in y for softmax. The second pass divides them by
+// the sum, corrected for the maximum of their block, or subtracts the log of
+// the sum for logsoftmax.
+template <class T>
+static void softmax_row(const T* x, T* y, std::size_t n, bool log)
+{
+    auto block   = std::max(min_row_block, (n + max_row_blocks - 1) / max_row_blocks);
+    auto nblocks = (n + block - 1) / block;
+    std::array<T, max_row_blocks> maxes;
+    T m   = std::numeric_limits<T>::lowest();
+    T sum = T(0);
+    for(std::size_t b = 0; b < nblocks; b++)
+    {
+        auto first = b * block;
+        auto last  = std::min(n, first + block);
+        T bm       = x[first];
+        for(auto i = first; i < last; i++)
+            bm = std::max(bm, x[i]);
+        if(bm > m)
+        {
+            sum *= fast_exp(m - bm);
+            m = bm;
+        }
+        maxes[b] = m;
+        T s      = T(0);
+        if(log)
+        {
+            for(auto i = first; i < last; i++)
+                s += fast_exp(x[i] - m);
+        }
+        else
+        {
+            for(auto i = first; i < last; i++)
+            {
+                y[i] = fast_exp(x[i] - m);
+                s += y[i];
+            }
+        }
+        sum += s;
+    }
+    if(log)
+    {
+        T c = T(m + std::log(sum));
+        for(std::size_t i = 0; i < n; i++)
+            y[i] = x[i] - c;
+        return;
+    }
+    for(std::size_t b = 0; b < nblocks; b++)
+    {
+        auto first = b * block;
+        auto last  = std::min(n, first + block);
+        T scale    = T(fast_exp(maxes[b] - m) / sum);
+        for(auto i = first; i < last; i++)
+            y[i] *= scale;
+    }
+}
+
+// The softmax of w columns, when the elements of the axis are stride apart.
+// Every loop runs over neighbouring columns, so the accesses are contiguous.
+// x and y can be the same, as each element is read before it is written.
+template <class T>
+static void
+softmax_columns(const T* x, T* y, std::size_t n, std::size_t stride, std::size_t w, bool log)
+{
+    std::array<T, column_tile> m;
+    std::array<T, column_tile> sum;
+    std::fill(m.begin(), m.end(), std::numeric_limits<T>::lowest());
+    std::fill(sum.begin(), sum.end(), T(0));
+    for(std::size_t j = 0; j < n; j++)
+    {
+        const auto* xj = x + j * stride;
+        for(std::size_t k = 0; k < w; k++)
+            m[k] = std::max(m[k], xj[k]);
+    }
+    for(std::size_t j = 0; j < n; j++)
+    {
+        const auto* xj = x + j * stride;
+        auto* yj       = y + j * stride;
+        if(log)
+        {
+            for(std::size_t k = 0; k < w; k++)
+                sum[k] += fast_exp(xj[k] - m[k]);
+            continue;
+        }
+        for(std::size_t k = 0; k < w; k++)
+        {
+            yj[k] = fast_exp(xj[k] - m[k]);
+            sum[k] += yj[k];
+        }
+    }
+    if(log)
+    {
+        for(std::size_t k = 0; k < w; k++)
+            m[k] += std::log(sum[k]);
+        for(std::size_t j = 0; j < n; j++)
+        {
+            const auto* xj = x + j * stride;
+            auto* yj       = y + j * stride;
+            for(std::size_t k = 0; k < w; k++)
+                yj[k] = xj[k] - m[k];
+        }
+        return;
+    }
+    for(std::size_t k = 0; k < w; k++)
+        sum[k] = T(1) / sum[k];
+    for(std::size_t j = 0; j < n; j++)
+    {
+        auto* yj = y + j * stride;
+        for(std::size_t k = 0; k < w; k++)
+            yj[k] *= sum[k];
+    }
+}
+
+static void softmax_impl(const argument& result, const argument& input, int64_t axis, bool log)
+{
+    // The result is standard, so it is split into the dimensions before the
+    // axis, the axis and the dimensions after it. An input in another layout
+    // is gathered into the result a row or a tile at a time, which is then
+    // evaluated in place.
+    const auto& lens = result.get_shape().lens();
+    auto tuned_axis  = axis < 0 ? axis + lens.size() : axis;
+    auto outer       = std::accumulate(
+        lens.begin(), lens.begin() + tuned_axis, std::size_t{1}, std::multiplies<std::size_t>{});
+    auto n     = lens[tuned_axis];
+    auto inner = std::accumulate(
+        lens.begin() + tuned_axis + 1, lens.end(), std::size_t{1}, std::multiplies<std::size_t>{});
+    if(outer * n * inner == 0)
+        return;
+    bool gather = not input.get_shape().standard();
+    visit_all(result, input)([&](auto output, auto x) {
+        auto* y        = output.data();
+        const auto* xp = gather ? y : x.data();
+        auto load      = [&](std::size_t first, std::size_t len) {
+            std::copy(x.strided_begin() + first, x.strided_begin() + first + len, y + first);
+        };
+        if(inner == 1)
+        {
+            par_for(outer, [&](auto i) {
+                if(gather)
+                    load(i * n, n);
+                softmax_row(xp + i * n, y + i * n, n, log);
+            });
+            return;
+        }
+        auto tiles = (inner + column_tile - 1) / column_tile;
+        par_for(outer * tiles, [&](auto i) {
+            auto offset = (i / tiles) * n * inner + (i % tiles) * column_tile;
+            auto w      = std::min(column_tile, inner - (i % tiles) * column_tile);
+            if(gather)
+            {
+                for(std::size_t j = 0; j < n; j++)
+                    load(offset + j * inner, w);
+            }
+            softmax_columns(xp + offset, y + offset, n, inner, w, log);
+        });
+    });
+}
+
+void softmax(const argument& result, const argument& input, const op::softmax& op)
+{
+    softmax_impl(result, input, op.axis, false);
+}
+
+void softmax(const argument& result, const argument& input, const op::logsoftmax& op)
+{
+    softmax_impl(result, input, op.axis, true);
+}
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
@@ -0,0 +1,51 @@
+#include <migraphx/cpu/sync_streams.hpp>
+#include <migraphx/cpu/context.hpp>
+#include <migraphx/program.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/register_op.hpp>
+#include <algorithm>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace cpu {
+
+// Wait for every stream and return the input, if there is one
+struct finish_streams
+{
+    std::string name() const { return "cpu::finish_streams"; }
+    shape compute_shape(const std::vector<shape>& inputs) const
+    {
+        if(inputs.empty())
+            return {};
+        return inputs.front();
+    }
+    argument compute(context& ctx, const shape&, const std::vector<argument>& args) const
+    {
+        ctx.finish();
+        if(args.empty())
+            return {};
+        return args.front();
+    }
+    std::ptrdiff_t output_alias(const std::vector<shape>& shapes) const
+    {
+        return shapes.empty() ? -1 : 0;
+    }
+};
+MIGRAPHX_REGISTER_OP(finish_streams)
+
+void sync_streams::apply(program& p) const
+{
+    if(p.begin() == p.end() or std::none_of(p.begin(), p.end(), [](const instruction& ins) {
+           return ins.name() == "cpu::set_stream";
+       }))
+        return;
+    auto last = std::prev(p.end());
+    if(last->name() == "@return")
+        p.insert_instruction(last, finish_streams{});
+    else
+        p.add_instruction(finish_streams{}, last);
+}
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
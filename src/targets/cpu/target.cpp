@@ -1,11 +1,23 @@
 
 #include <migraphx/cpu/target.hpp>
+#include <migraphx/cpu/eliminate_contiguous.hpp>
+#include <migraphx/cpu/fuse_gelu.hpp>
+#include <migraphx/cpu/fuse_pointwise.hpp>
 #include <migraphx/cpu/lowering.hpp>
+#include <migraphx/cpu/pack_weights.hpp>
+#include <migraphx/cpu/preallocate_param.hpp>
+#include <migraphx/cpu/propagate_layout.hpp>
+#include <migraphx/cpu/schedule_model.hpp>
+#include <migraphx/cpu/sync_streams.hpp>
 #include <migraphx/pass.hpp>
 #include <migraphx/auto_contiguous.hpp>
-#include <migraphx/rewrite_rnn.hpp>
 #include <migraphx/dead_code_elimination.hpp>
+#include <migraphx/memory_coloring.hpp>
+#include <migraphx/schedule.hpp>
+#include <migraphx/simplify_reshapes.hpp>
+#include <migraphx/sink_transposes.hpp>
 #include <migraphx/generate.hpp>
+#include <migraphx/register_target.hpp>
 
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
@@ -13,18 +25,37 @@ namespace cpu {
 
 std::string target::name() const { return "cpu"; }
 
-std::vector<pass> target::get_passes(migraphx::context&, const compile_options&) const
+std::vector<pass> target::get_passes(migraphx::context& gctx, const compile_options&) const
 {
-    return {rewrite_rnn{},
+    auto nstreams = any_cast<context>(gctx).nstreams();
+    return {sink_transposes{},
+            simplify_reshapes{},
             dead_code_elimination{},
             auto_contiguous{},
             dead_code_elimination{},
+            fuse_gelu{},
+            dead_code_elimination{},
+            fuse_pointwise{},
+            dead_code_elimination{},
+            pack_weights{},
+            dead_code_elimination{},
             lowering{},
+            dead_code_elimination{},
+            eliminate_contiguous{},
+            dead_code_elimination{},
+            propagate_layout{},
+            dead_code_elimination{},
+            schedule{cpu::schedule_model{nstreams}, nstreams > 1},
+            memory_coloring{"cpu::allocate"},
+            sync_streams{},
+            preallocate_param{"scratch"},
             dead_code_elimination{}};
 }
 
 argument target::allocate(const shape& s) const { return fill_argument(s, 0); }
 
+MIGRAPHX_REGISTER_TARGET(target)
+
 } // namespace cpu
 } // namespace MIGRAPHX_INLINE_NS
 } // namespace migraphx
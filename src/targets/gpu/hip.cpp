@@ -101,7 +101,7 @@ hip_ptr write_to_gpu(const T& x)
 argument allocate_gpu(const shape& s, bool host)
 {
     auto p = share(allocate_gpu(s.bytes() + 1, host));
-    return {s, [p]() mutable { return reinterpret_cast<char*>(p.get()); }};
+    return {s, p};
 }
 
 argument register_on_gpu(const argument& arg)
@@ -125,9 +125,9 @@ argument from_gpu(const argument& arg)
     argument result;
     arg.visit([&](auto x) {
         using type = typename decltype(x)::value_type;
-        auto v     = read_from_gpu<type>(arg.data(), x.get_shape().bytes() / sizeof(type));
-        // cppcheck-suppress returnDanglingLifetime
-        result = {x.get_shape(), [v]() mutable { return v.data(); }};
+        auto v     = std::make_shared<std::vector<type>>(
+            read_from_gpu<type>(arg.data(), x.get_shape().bytes() / sizeof(type)));
+        result     = {x.get_shape(), std::shared_ptr<type>(v, v->data())};
     });
     return result;
 }
@@ -10,6 +10,7 @@
 #include <migraphx/auto_contiguous.hpp>
 #include <migraphx/dead_code_elimination.hpp>
 #include <migraphx/simplify_reshapes.hpp>
+#include <migraphx/sink_transposes.hpp>
 #include <migraphx/simplify_algebra.hpp>
 #include <migraphx/propagate_constant.hpp>
 #include <migraphx/eliminate_contiguous.hpp>
@@ -29,6 +30,7 @@
 #include <migraphx/decompose.hpp>
 #include <migraphx/remap.hpp>
 #include <migraphx/schedule.hpp>
+#include <migraphx/register_target.hpp>
 
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
@@ -44,6 +46,7 @@ std::vector<pass> target::get_passes(migraphx::context& gctx, const compile_opti
     {
         decompose{},
         dead_code_elimination{},
+        sink_transposes{},
         simplify_reshapes{},
         eliminate_identity{},
         eliminate_pad{},
@@ -101,6 +104,8 @@ argument target::copy_from(const argument& arg) const { return gpu::from_gpu(arg
 
 argument target::allocate(const shape& s) const { return gpu::allocate_gpu(s); }
 
+MIGRAPHX_REGISTER_TARGET(target)
+
 } // namespace gpu
 } // namespace MIGRAPHX_INLINE_NS
 } // namespace migraphx
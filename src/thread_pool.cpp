@@ -0,0 +1,237 @@
+#include <migraphx/thread_pool.hpp>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+
+struct thread_pool_job
+{
+    const std::function<void(std::size_t)>* f = nullptr;
+    std::size_t remaining                     = 0;
+    std::exception_ptr error                  = nullptr;
+    std::mutex m;
+    std::condition_variable cv;
+};
+
+struct thread_pool_task
+{
+    thread_pool_job* job = nullptr;
+    std::size_t i        = 0;
+};
+
+struct thread_pool_queue
+{
+    std::mutex m;
+    std::deque<thread_pool_task> tasks;
+};
+
+// The pool and queue owned by the current thread, so nested calls push to
+// and pop from the local queue first
+thread_local const thread_pool_impl* current_pool = nullptr;
+thread_local std::size_t current_queue            = 0;
+
+static std::size_t hardware_threads()
+{
+    return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+static void pin_thread(std::thread& t, std::size_t cpu)
+{
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu % hardware_threads(), &set);
+    pthread_setaffinity_np(t.native_handle(), sizeof(cpu_set_t), &set);
+#else
+    (void)t;
+    (void)cpu;
+#endif
+}
+
+struct thread_pool_impl
+{
+    // Queue 0 is shared by threads outside of the pool, the rest are owned by
+    // a worker thread each
+    std::vector<thread_pool_queue> queues;
+    std::vector<std::thread> threads;
+    std::atomic<std::ptrdiff_t> queued{0};
+    std::mutex m;
+    std::condition_variable cv;
+    bool stop = false;
+
+    thread_pool_impl(std::size_t nthreads, bool pin) : queues(std::max<std::size_t>(nthreads, 1))
+    {
+        threads.reserve(queues.size() - 1);
+        for(std::size_t i = 1; i < queues.size(); i++)
+        {
+            threads.emplace_back([=] { this->work(i); });
+            if(pin)
+                pin_thread(threads.back(), i);
+        }
+    }
+
+    ~thread_pool_impl()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            stop = true;
+        }
+        cv.notify_all();
+        for(auto&& t : threads)
+            t.join();
+    }
+
+    std::size_t queue_index() const { return current_pool == this ? current_queue : 0; }
+
+    void push(thread_pool_job& job, std::size_t n)
+    {
+        auto start = this->queue_index();
+        for(std::size_t i = 0; i < n; i++)
+        {
+            auto& q = queues[(start + i) % queues.size()];
+            std::lock_guard<std::mutex> lock(q.m);
+            q.tasks.push_back({&job, i});
+        }
+        {
+            std::lock_guard<std::mutex> lock(m);
+            queued += n;
+        }
+        if(n >= threads.size())
+        {
+            cv.notify_all();
+        }
+        else
+        {
+            for(std::size_t i = 0; i < n; i++)
+                cv.notify_one();
+        }
+    }
+
+    // Take from the front of our own queue, otherwise steal from the back of
+    // another queue
+    bool try_pop(std::size_t self, thread_pool_task& t)
+    {
+        for(std::size_t k = 0; k < queues.size() and queued > 0; k++)
+        {
+            auto& q = queues[(self + k) % queues.size()];
+            std::lock_guard<std::mutex> lock(q.m);
+            if(q.tasks.empty())
+                continue;
+            if(k == 0)
+            {
+                t = q.tasks.front();
+                q.tasks.pop_front();
+            }
+            else
+            {
+                t = q.tasks.back();
+                q.tasks.pop_back();
+            }
+            queued--;
+            return true;
+        }
+        return false;
+    }
+
+    static void execute(const thread_pool_task& t)
+    {
+        auto& job = *t.job;
+        std::exception_ptr error = nullptr;
+        try
+        {
+            (*job.f)(t.i);
+        }
+        catch(...)
+        {
+            error = std::current_exception();
+        }
+        // The job is owned by the thread waiting on it, so it must not be
+        // touched after the lock is released
+        std::lock_guard<std::mutex> lock(job.m);
+        if(error and not job.error)
+            job.error = error;
+        job.remaining--;
+        if(job.remaining == 0)
+            job.cv.notify_all();
+    }
+
+    void work(std::size_t self)
+    {
+        current_pool  = this;
+        current_queue = self;
+        thread_pool_task t;
+        for(;;)
+        {
+            if(try_pop(self, t))
+            {
+                execute(t);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(m);
+            cv.wait(lock, [&] { return stop or queued > 0; });
+            if(stop)
+                return;
+        }
+    }
+
+    void run(std::size_t n, const std::function<void(std::size_t)>& f)
+    {
+        thread_pool_job job;
+        job.f         = &f;
+        job.remaining = n;
+        this->push(job, n);
+        // Help out until there is nothing left in the queues, then wait for
+        // the tasks that are still running on the workers
+        auto self = this->queue_index();
+        thread_pool_task t;
+        while(try_pop(self, t))
+            execute(t);
+        std::unique_lock<std::mutex> lock(job.m);
+        job.cv.wait(lock, [&] { return job.remaining == 0; });
+        if(job.error)
+            std::rethrow_exception(job.error);
+    }
+};
+
+thread_pool::thread_pool(std::size_t nthreads, bool pin)
+    : impl(std::make_unique<thread_pool_impl>(nthreads, pin))
+{
+}
+
+thread_pool::~thread_pool() = default;
+
+std::size_t thread_pool::size() const { return impl->queues.size(); }
+
+void thread_pool::run(std::size_t n, const std::function<void(std::size_t)>& f)
+{
+    if(n == 0)
+        return;
+    if(n == 1 or impl->threads.empty())
+    {
+        for(std::size_t i = 0; i < n; i++)
+            f(i);
+        return;
+    }
+    impl->run(n, f);
+}
+
+thread_pool& get_thread_pool()
+{
+    static thread_pool pool{value_of(MIGRAPHX_CPU_THREADS{}, hardware_threads()),
+                            enabled(MIGRAPHX_CPU_AFFINITY{})};
+    return pool;
+}
+
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
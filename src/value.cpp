@@ -2,6 +2,7 @@
 #include <iostream>
 #include <migraphx/cloneable.hpp>
 #include <migraphx/errors.hpp>
+#include <migraphx/make_shared_array.hpp>
 #include <migraphx/stringutils.hpp>
 #include <migraphx/value.hpp>
 #include <unordered_map>
@@ -10,6 +11,23 @@
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
 
+value::binary::binary(const void* x, std::size_t n) : m_size(n)
+{
+    auto b = make_shared_array<char>(n);
+    std::copy_n(static_cast<const char*>(x), n, b.get());
+    buffer = b;
+}
+
+bool operator==(const value::binary& x, const value::binary& y)
+{
+    return std::equal(x.begin(), x.end(), y.begin(), y.end());
+}
+bool operator!=(const value::binary& x, const value::binary& y) { return !(x == y); }
+bool operator<(const value::binary& x, const value::binary& y)
+{
+    return std::lexicographical_compare(x.begin(), x.end(), y.begin(), y.end());
+}
+
 struct value_base_impl : cloneable<value_base_impl>
 {
     virtual value::type_t get_type() { return value::null_type; }
@@ -422,6 +440,10 @@ void print_value(std::ostream& os, const std::pair<T, U>& x)
 }
 
 void print_value(std::ostream& os, const std::nullptr_t&) { os << "null"; }
+void print_value(std::ostream& os, const value::binary& x)
+{
+    os << "binary(" << x.size() << ")";
+}
 void print_value(std::ostream& os, const std::vector<value>& x)
 {
     os << "{";
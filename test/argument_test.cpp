@@ -0,0 +1,84 @@
+#include <migraphx/argument.hpp>
+#include <migraphx/shape.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "test.hpp"
+
+bool is_aligned(const char* p, std::size_t n) { return reinterpret_cast<std::uintptr_t>(p) % n == 0; }
+
+TEST_CASE(argument_zero_init)
+{
+    migraphx::shape s{migraphx::shape::float_type, {3, 5}};
+    migraphx::argument a{s};
+    EXPECT(not a.empty());
+    EXPECT(is_aligned(a.data(), 64));
+    a.visit([](auto x) { EXPECT(std::all_of(x.begin(), x.end(), [](auto y) { return y == 0; })); });
+}
+
+TEST_CASE(argument_allocator)
+{
+    std::size_t allocated = 0;
+    migraphx::shape s{migraphx::shape::int32_type, {7}};
+    migraphx::argument a{s, [&](std::size_t n) {
+                             allocated += n;
+                             return migraphx::allocate_aligned(n);
+                         }};
+    EXPECT(allocated == s.bytes());
+    EXPECT(is_aligned(a.data(), 64));
+}
+
+TEST_CASE(argument_empty_shape)
+{
+    migraphx::shape s{migraphx::shape::float_type, {0}};
+    migraphx::argument a{s};
+    EXPECT(not a.empty());
+    EXPECT(migraphx::argument{}.empty());
+    EXPECT(migraphx::argument{s, nullptr}.empty());
+}
+
+TEST_CASE(argument_share)
+{
+    migraphx::shape s{migraphx::shape::float_type, {4}};
+    migraphx::argument a{s};
+    auto b = a;
+    EXPECT(a.data() == b.data());
+    b.visit([](auto x) { x[2] = 3; });
+    EXPECT(a.at<float>(2) == 3);
+}
+
+TEST_CASE(argument_owner)
+{
+    migraphx::shape s{migraphx::shape::float_type, {4}};
+    migraphx::argument a;
+    {
+        auto data = std::make_shared<std::vector<float>>(4, 2.0f);
+        a         = migraphx::argument{s, std::shared_ptr<float>(data, data->data())};
+    }
+    a.visit([](auto x) { EXPECT(std::all_of(x.begin(), x.end(), [](auto y) { return y == 2; })); });
+}
+
+TEST_CASE(argument_view)
+{
+    migraphx::shape s{migraphx::shape::float_type, {2, 3}};
+    std::vector<float> data = {0, 1, 2, 3, 4, 5};
+    migraphx::argument a{s, data.data()};
+    migraphx::shape row{migraphx::shape::float_type, {3}};
+    auto b = a.view(row, 3 * sizeof(float));
+    EXPECT(b.get_shape() == row);
+    EXPECT(b.at<float>(0) == 3);
+    EXPECT(b.at<float>(2) == 5);
+    auto c = a.reshape(migraphx::shape{migraphx::shape::float_type, {6}});
+    EXPECT(c.data() == a.data());
+}
+
+TEST_CASE(argument_huge)
+{
+    migraphx::shape s{migraphx::shape::int8_type, {4 * 1024 * 1024}};
+    migraphx::argument a{s, migraphx::allocate_aligned};
+    EXPECT(is_aligned(a.data(), 2 * 1024 * 1024));
+    a.data()[s.bytes() - 1] = 1;
+    EXPECT(a.at<int8_t>(s.elements() - 1) == 1);
+}
+
+int main(int argc, const char* argv[]) { test::run(argc, argv); }
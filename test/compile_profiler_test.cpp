@@ -0,0 +1,96 @@
+#include <migraphx/compile_profiler.hpp>
+#include <migraphx/pass_manager.hpp>
+#include <migraphx/dead_code_elimination.hpp>
+#include <migraphx/matcher.hpp>
+#include <migraphx/json.hpp>
+#include <migraphx/ranges.hpp>
+#include <migraphx/cpu/target.hpp>
+#include <migraphx/op/add.hpp>
+#include <basic_ops.hpp>
+#include <sstream>
+#include <test.hpp>
+
+namespace match = migraphx::match;
+
+struct find_sum
+{
+    auto matcher() const { return match::name("sum"); }
+
+    void apply(migraphx::program&, const match::matcher_result&) const {}
+};
+
+struct match_sum_pass
+{
+    std::string name() const { return "match_sum"; }
+    void apply(migraphx::program& p) const { match::find_matches(p, find_sum{}); }
+};
+
+migraphx::program create_program()
+{
+    migraphx::program p;
+    auto one = p.add_literal(1);
+    auto two = p.add_literal(2);
+    auto sum = p.add_instruction(sum_op{}, one, two);
+    // Unused, so it is removed by dead code elimination
+    p.add_instruction(sum_op{}, one, two);
+    p.add_instruction(pass_op{}, sum);
+    return p;
+}
+
+TEST_CASE(profile_passes)
+{
+    auto p = create_program();
+    migraphx::compile_profiler profiler;
+    migraphx::run_passes(p, {match_sum_pass{}, migraphx::dead_code_elimination{}}, {}, &profiler);
+    EXPECT(migraphx::get_compile_profiler() == nullptr);
+
+    const auto& passes = profiler.get_passes();
+    EXPECT(passes.size() == 2);
+    EXPECT(passes[0].name == "match_sum");
+    EXPECT(passes[0].instructions_before == passes[0].instructions_after);
+    EXPECT(passes[1].name == "dead_code_elimination");
+    EXPECT(passes[1].instructions_after < passes[1].instructions_before);
+
+    const auto& matchers = profiler.get_matchers();
+    EXPECT(matchers.size() == 1);
+    const auto& r = matchers.begin()->second;
+    EXPECT(migraphx::contains(matchers.begin()->first, "find_sum"));
+    EXPECT(r.attempts == 5);
+    EXPECT(r.hits == 2);
+}
+
+TEST_CASE(profile_report)
+{
+    auto p = create_program();
+    migraphx::compile_profiler profiler;
+    migraphx::run_passes(p, {match_sum_pass{}}, {}, &profiler);
+
+    std::stringstream ss;
+    profiler.print(ss);
+    auto output = ss.str();
+    EXPECT(migraphx::contains(output, "match_sum"));
+    EXPECT(migraphx::contains(output, "find_sum"));
+    EXPECT(migraphx::contains(output, "Total time:"));
+
+    auto v = migraphx::from_json_string(profiler.to_json());
+    EXPECT(v.at("passes").size() == 1);
+    EXPECT(v.at("passes").front().at("name").get_string() == "match_sum");
+    EXPECT(v.at("matchers").front().at("hits").without_key().to<std::size_t>() == 2);
+}
+
+TEST_CASE(profile_compile)
+{
+    migraphx::program p;
+    auto one = p.add_literal(1);
+    auto two = p.add_literal(2);
+    p.add_instruction(migraphx::op::add{}, one, two);
+
+    migraphx::compile_profiler profiler;
+    migraphx::compile_options options;
+    options.profiler = &profiler;
+    p.compile(migraphx::cpu::target{}, options);
+    EXPECT(not profiler.get_passes().empty());
+    EXPECT(profiler.total_time() >= 0);
+}
+
+int main(int argc, const char* argv[]) { test::run(argc, argv); }
@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <iostream>
+#include <numeric>
 #include <vector>
 #include <migraphx/literal.hpp>
 #include <migraphx/operators.hpp>
@@ -1093,6 +1095,47 @@ TEST_CASE(matmul_mm2)
     }
 }
 
+TEST_CASE(matmul_batch_transposed)
+{
+    // Enough matrices to multiply them in parallel
+    const std::size_t batch = 64;
+    const std::size_t m     = 3;
+    const std::size_t k     = 5;
+    const std::size_t n     = 4;
+    migraphx::program p;
+    migraphx::shape a_shape{migraphx::shape::float_type, {batch, m, k}};
+    migraphx::shape b_shape{migraphx::shape::float_type, {batch, n, k}};
+    std::vector<float> a(a_shape.elements());
+    std::vector<float> b(b_shape.elements());
+    std::iota(a.begin(), a.end(), -100);
+    std::iota(b.begin(), b.end(), -200);
+    auto al  = p.add_literal(migraphx::literal{a_shape, a});
+    auto bl  = p.add_literal(migraphx::literal{b_shape, b});
+    auto tbl = p.add_instruction(migraphx::op::transpose{{0, 2, 1}}, bl);
+    p.add_instruction(migraphx::op::dot{}, al, tbl);
+
+    std::vector<float> gold(batch * m * n);
+    for(std::size_t i = 0; i < batch; i++)
+    {
+        for(std::size_t r = 0; r < m; r++)
+        {
+            for(std::size_t c = 0; c < n; c++)
+            {
+                float s = 0;
+                for(std::size_t kk = 0; kk < k; kk++)
+                    s += a[(i * m + r) * k + kk] * b[(i * n + c) * k + kk];
+                gold[(i * m + r) * n + c] = s;
+            }
+        }
+    }
+
+    p.compile(migraphx::cpu::target{});
+    auto result = p.eval({}).back();
+    std::vector<float> results_vector;
+    result.visit([&](auto output) { results_vector.assign(output.begin(), output.end()); });
+    EXPECT(migraphx::verify_range(results_vector, gold));
+}
+
 TEST_CASE(quant_dot_2args_multi4)
 {
     {
@@ -1510,4 +1553,145 @@ TEST_CASE(quant_dot_3args_batch)
     }
 }
 
+TEST_CASE(quant_dot_tiled)
+{
+    // Large enough to span several tiles, with partial tiles at the edges
+    const std::size_t batch = 2;
+    const std::size_t m     = 9;
+    const std::size_t k     = 36;
+    const std::size_t n     = 37;
+    migraphx::program p;
+    migraphx::shape m1_shape{migraphx::shape::int8_type, {batch, m, k}};
+    migraphx::shape m2_shape{migraphx::shape::int8_type, {batch, n, k}};
+    migraphx::shape m3_shape{migraphx::shape::int32_type, {batch, m, n}};
+    std::vector<int8_t> data1(m1_shape.elements());
+    std::vector<int8_t> data2(m2_shape.elements());
+    std::vector<int> data3(m3_shape.elements());
+    // Use the whole int8 range so the products do not fit in 16 bits
+    std::size_t i = 0;
+    std::generate(data1.begin(), data1.end(), [&] { return int8_t(i++ * 37 % 256 - 128); });
+    std::generate(data2.begin(), data2.end(), [&] { return int8_t(i++ * 91 % 256 - 128); });
+    std::iota(data3.begin(), data3.end(), -100);
+
+    auto l1  = p.add_literal(migraphx::literal{m1_shape, data1});
+    auto l2  = p.add_literal(migraphx::literal{m2_shape, data2});
+    auto tl2 = p.add_instruction(migraphx::op::transpose{{0, 2, 1}}, l2);
+    auto l3  = p.add_literal(migraphx::literal{m3_shape, data3});
+    p.add_instruction(migraphx::op::quant_dot{2, 3}, l1, tl2, l3);
+
+    std::vector<int> gold(m3_shape.elements());
+    for(std::size_t b = 0; b < batch; b++)
+    {
+        for(std::size_t r = 0; r < m; r++)
+        {
+            for(std::size_t c = 0; c < n; c++)
+            {
+                int s = 0;
+                for(std::size_t kk = 0; kk < k; kk++)
+                    s += data1[(b * m + r) * k + kk] * data2[(b * n + c) * k + kk];
+                auto idx  = (b * m + r) * n + c;
+                gold[idx] = 2 * s + 3 * data3[idx];
+            }
+        }
+    }
+
+    p.compile(migraphx::cpu::target{});
+    auto result = p.eval({}).back();
+    std::vector<int> results_vector;
+    result.visit([&](auto output) { results_vector.assign(output.begin(), output.end()); });
+    EXPECT(results_vector == gold);
+}
+
+TEST_CASE(quant_dot_packed_weights)
+{
+    // The transposed constant B is packed when compiling, so it is not copied
+    // on every run
+    const std::size_t m = 5;
+    const std::size_t k = 7;
+    const std::size_t n = 19;
+    migraphx::program p;
+    migraphx::shape a_shape{migraphx::shape::int8_type, {m, k}};
+    migraphx::shape b_shape{migraphx::shape::int8_type, {n, k}};
+    std::vector<int8_t> a_data(a_shape.elements());
+    std::vector<int8_t> b_data(b_shape.elements());
+    std::size_t i = 0;
+    std::generate(a_data.begin(), a_data.end(), [&] { return int8_t(i++ * 53 % 256 - 128); });
+    std::generate(b_data.begin(), b_data.end(), [&] { return int8_t(i++ * 29 % 256 - 128); });
+
+    auto a  = p.add_parameter("a", a_shape);
+    auto b  = p.add_literal(migraphx::literal{b_shape, b_data});
+    auto tb = p.add_instruction(migraphx::op::transpose{{1, 0}}, b);
+    p.add_instruction(migraphx::op::quant_dot{3, 0}, a, tb);
+
+    std::vector<int> gold(m * n);
+    for(std::size_t r = 0; r < m; r++)
+    {
+        for(std::size_t c = 0; c < n; c++)
+        {
+            int s = 0;
+            for(std::size_t kk = 0; kk < k; kk++)
+                s += a_data[r * k + kk] * b_data[c * k + kk];
+            gold[r * n + c] = 3 * s;
+        }
+    }
+
+    p.compile(migraphx::cpu::target{});
+    EXPECT(std::any_of(p.begin(), p.end(), [](const migraphx::instruction& ins) {
+        return ins.name() == "cpu::quant_dot_packed";
+    }));
+    EXPECT(std::none_of(p.begin(), p.end(), [](const migraphx::instruction& ins) {
+        return ins.name() == "cpu::contiguous";
+    }));
+    migraphx::program::parameter_map params;
+    params["a"] = migraphx::argument{a_shape, a_data.data()};
+    auto result = p.eval(params).back();
+    std::vector<int> results_vector;
+    result.visit([&](auto output) { results_vector.assign(output.begin(), output.end()); });
+    EXPECT(results_vector == gold);
+}
+
+TEST_CASE(dot_broadcast_weights)
+{
+    // The constant B shared by every batch is not expanded when compiling
+    const std::size_t b = 8;
+    const std::size_t m = 3;
+    const std::size_t k = 4;
+    const std::size_t n = 5;
+    migraphx::program p;
+    migraphx::shape a_shape{migraphx::shape::float_type, {b, m, k}};
+    migraphx::shape w_shape{migraphx::shape::float_type, {k, n}};
+    std::vector<float> a_data(a_shape.elements());
+    std::vector<float> w_data(w_shape.elements());
+    std::iota(a_data.begin(), a_data.end(), 0.0f);
+    std::iota(w_data.begin(), w_data.end(), 1.0f);
+
+    auto a  = p.add_parameter("a", a_shape);
+    auto w  = p.add_literal(migraphx::literal{w_shape, w_data});
+    auto bw = p.add_instruction(migraphx::op::multibroadcast{{b, k, n}}, w);
+    p.add_instruction(migraphx::op::dot{}, a, bw);
+
+    std::vector<float> gold(b * m * n);
+    for(std::size_t i = 0; i < b * m; i++)
+    {
+        for(std::size_t c = 0; c < n; c++)
+        {
+            float s = 0;
+            for(std::size_t kk = 0; kk < k; kk++)
+                s += a_data[i * k + kk] * w_data[kk * n + c];
+            gold[i * n + c] = s;
+        }
+    }
+
+    p.compile(migraphx::cpu::target{});
+    EXPECT(std::none_of(p.begin(), p.end(), [&](const migraphx::instruction& ins) {
+        return ins.name() == "@literal" and ins.get_shape().elements() == b * k * n;
+    }));
+    migraphx::program::parameter_map params;
+    params["a"] = migraphx::argument{a_shape, a_data.data()};
+    auto result = p.eval(params).back();
+    std::vector<float> results_vector;
+    result.visit([&](auto output) { results_vector.assign(output.begin(), output.end()); });
+    EXPECT(migraphx::verify_range(results_vector, gold));
+}
+
 int main(int argc, const char* argv[]) { test::run(argc, argv); }
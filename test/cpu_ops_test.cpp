@@ -1,10 +1,14 @@
 #include <iostream>
+#include <limits>
+#include <thread>
 #include <vector>
 #include <migraphx/literal.hpp>
 #include <migraphx/operators.hpp>
 #include <migraphx/instruction.hpp>
+#include <migraphx/iterator_for.hpp>
 #include <migraphx/quantization.hpp>
 #include <migraphx/cpu/target.hpp>
+#include <migraphx/cpu/pointwise.hpp>
 #include <migraphx/quantization.hpp>
 #include <migraphx/verify.hpp>
 #include <migraphx/onnx.hpp>
@@ -300,6 +304,28 @@ TEST_CASE(gather_test)
     }
 }
 
+TEST_CASE(gather_transposed_test)
+{
+    std::vector<float> data(3 * 3);
+    std::iota(data.begin(), data.end(), 0.5);
+    migraphx::shape s{migraphx::shape::float_type, {3, 3}, {1, 3}};
+    migraphx::shape s_indices{migraphx::shape::int32_type, {2}};
+    std::vector<int> indices{0, -1};
+    migraphx::argument a0{s, data.data()};
+    migraphx::argument a1{s_indices, indices.data()};
+    auto run = [&](int axis) {
+        migraphx::op::gather op{axis};
+        auto result = op.compute(op.compute_shape({s, s_indices}), {a0, a1});
+        std::vector<float> res_data;
+        result.visit([&](auto output) { res_data.assign(output.begin(), output.end()); });
+        return res_data;
+    };
+    std::vector<float> golden0 = {0.5f, 3.5f, 6.5f, 2.5f, 5.5f, 8.5f};
+    EXPECT(migraphx::verify_range(run(0), golden0));
+    std::vector<float> golden1 = {0.5f, 6.5f, 1.5f, 7.5f, 2.5f, 8.5f};
+    EXPECT(migraphx::verify_range(run(1), golden1));
+}
+
 TEST_CASE(squeeze_test)
 {
     {
@@ -587,6 +613,58 @@ TEST_CASE(globalmaxpool_test)
     EXPECT(migraphx::verify_range(results_vector, gold));
 }
 
+TEST_CASE(pooling_reference_test)
+{
+    auto run = [](const migraphx::op::pooling& op, const std::vector<std::size_t>& lens) {
+        migraphx::program p;
+        migraphx::shape s{migraphx::shape::float_type, lens};
+        std::vector<float> a(s.elements());
+        for(std::size_t i = 0; i < a.size(); i++)
+            a[i] = ((i * 37) % 101) * 0.1f - 5;
+        auto al = p.add_literal(migraphx::literal{s, a});
+        p.add_instruction(op, al);
+        p.compile(migraphx::cpu::target{});
+        auto result = p.eval({}).back();
+        std::vector<float> results_vector;
+        result.visit([&](auto output) { results_vector.assign(output.begin(), output.end()); });
+
+        auto out_s = op.compute_shape({s});
+        std::vector<float> gold(out_s.elements());
+        for(std::size_t i = 0; i < gold.size(); i++)
+        {
+            auto idx = out_s.multi(i);
+            std::vector<std::size_t> first(idx.begin(), idx.begin() + 2);
+            std::vector<std::size_t> win_lens(2, 1);
+            for(std::size_t d = 2; d < lens.size(); d++)
+            {
+                int start = idx[d] * op.stride[d - 2] - op.padding[d - 2];
+                int end   = std::min<int>(start + op.lengths[d - 2], lens[d]);
+                start     = std::max(start, 0);
+                first.push_back(start);
+                win_lens.push_back(end - start);
+            }
+            migraphx::shape win{migraphx::shape::float_type, win_lens};
+            double acc = op.mode == "max" ? std::numeric_limits<double>::lowest() : 0.0;
+            migraphx::shape_for_each(win, [&](auto w) {
+                std::vector<std::size_t> x(w.size());
+                std::transform(w.begin(), w.end(), first.begin(), x.begin(), std::plus<>{});
+                double v = a[s.index(x)];
+                acc      = op.mode == "max" ? std::max(acc, v) : acc + v;
+            });
+            gold[i] = op.mode == "max" ? acc : acc / win.elements();
+        }
+        EXPECT(migraphx::verify_range(results_vector, gold));
+    };
+    for(std::string mode : {"max", "average"})
+    {
+        run(migraphx::op::pooling{mode, {1, 1}, {2, 2}, {3, 3}}, {2, 3, 9, 10});
+        run(migraphx::op::pooling{mode, {0, 2}, {1, 3}, {2, 5}}, {1, 2, 7, 12});
+        run(migraphx::op::pooling{mode, {0, 0}, {1, 1}, {6, 7}}, {2, 4, 6, 7});
+        run(migraphx::op::pooling{mode, {1}, {2}, {3}}, {2, 2, 11});
+        run(migraphx::op::pooling{mode, {1, 0, 1}, {1, 2, 2}, {2, 3, 2}}, {1, 2, 4, 7, 5});
+    }
+}
+
 TEST_CASE(im2col_3x3_no_pad_identity_test)
 {
     std::size_t f[2]    = {3, 3};
@@ -1235,6 +1313,51 @@ TEST_CASE(add_broadcast_test)
     }
 }
 
+TEST_CASE(add_broadcast_strided_test)
+{
+    // Broadcast along the last dimension, along the first dimension and from
+    // a scalar, and a transposed input, with enough elements to split the
+    // rows into several blocks. The kernel is called directly, since the
+    // target copies these inputs to standard tensors.
+    migraphx::shape s{migraphx::shape::float_type, {3, 5000}};
+    std::vector<float> a(s.elements());
+    std::iota(a.begin(), a.end(), 0);
+    std::vector<float> col{1, 2, 3};
+    std::vector<float> row(5000);
+    std::iota(row.begin(), row.end(), -2500);
+    auto run = [&](const migraphx::argument& x) {
+        migraphx::argument result{s};
+        migraphx::op::sub{}.compute_to(result, {x, migraphx::argument{s, a.data()}});
+        std::vector<float> results_vector;
+        result.visit([&](auto output) { results_vector.assign(output.begin(), output.end()); });
+        return results_vector;
+    };
+    std::vector<float> gold(s.elements());
+    for(std::size_t i = 0; i < gold.size(); i++)
+        gold[i] = col[i / 5000] - a[i];
+    EXPECT(migraphx::verify_range(
+        run({migraphx::shape{migraphx::shape::float_type, s.lens(), {1, 0}}, col.data()}), gold));
+    for(std::size_t i = 0; i < gold.size(); i++)
+        gold[i] = row[i % 5000] - a[i];
+    EXPECT(migraphx::verify_range(
+        run({migraphx::shape{migraphx::shape::float_type, s.lens(), {0, 1}}, row.data()}), gold));
+    std::vector<float> scalar{7};
+    for(std::size_t i = 0; i < gold.size(); i++)
+        gold[i] = 7 - a[i];
+    EXPECT(migraphx::verify_range(
+        run({migraphx::shape{migraphx::shape::float_type, s.lens(), {0, 0}}, scalar.data()}),
+        gold));
+    // The transpose of a 5000x3 tensor
+    std::vector<float> t(s.elements());
+    for(std::size_t i = 0; i < t.size(); i++)
+    {
+        t[(i % 5000) * 3 + i / 5000] = row[i % 5000] * col[i / 5000];
+        gold[i]                      = row[i % 5000] * col[i / 5000] - a[i];
+    }
+    EXPECT(migraphx::verify_range(
+        run({migraphx::shape{migraphx::shape::float_type, s.lens(), {1, 3}}, t.data()}), gold));
+}
+
 TEST_CASE(sub_test)
 {
     migraphx::program p;
@@ -1666,6 +1789,49 @@ TEST_CASE(logsoftmax_test_axis_3)
     EXPECT(migraphx::verify_range(results_vector, s));
 }
 
+TEST_CASE(softmax_long_test)
+{
+    // Rows of several blocks, that grow so the sum is rescaled
+    migraphx::shape s{migraphx::shape::float_type, {2, 3000}};
+    std::vector<float> a(s.elements());
+    for(std::size_t i = 0; i < a.size(); i++)
+        a[i] = (i % 3000) * 0.01f - 15 + (i / 3000);
+    auto run = [&](const migraphx::operation& op, int axis, bool log) {
+        migraphx::program p;
+        auto al = p.add_literal(migraphx::literal{s, a});
+        p.add_instruction(op, al);
+        p.compile(migraphx::cpu::target{});
+        auto result = p.eval({}).back();
+        std::vector<float> results_vector;
+        result.visit([&](auto output) { results_vector.assign(output.begin(), output.end()); });
+
+        std::vector<float> gold(s.elements());
+        auto n      = s.lens()[axis];
+        auto stride = s.strides()[axis];
+        auto rows   = s.elements() / n;
+        for(std::size_t r = 0; r < rows; r++)
+        {
+            auto first = axis == 0 ? r : r * n;
+            double m   = a[first];
+            for(std::size_t j = 0; j < n; j++)
+                m = std::max<double>(m, a[first + j * stride]);
+            double sum = 0;
+            for(std::size_t j = 0; j < n; j++)
+                sum += std::exp(a[first + j * stride] - m);
+            for(std::size_t j = 0; j < n; j++)
+            {
+                double x                 = a[first + j * stride];
+                gold[first + j * stride] = log ? x - m - std::log(sum) : std::exp(x - m) / sum;
+            }
+        }
+        EXPECT(migraphx::verify_range(results_vector, gold));
+    };
+    run(migraphx::op::softmax{1}, 1, false);
+    run(migraphx::op::softmax{0}, 0, false);
+    run(migraphx::op::logsoftmax{1}, 1, true);
+    run(migraphx::op::logsoftmax{0}, 0, true);
+}
+
 TEST_CASE(argmax_test_0)
 {
     migraphx::program p;
@@ -2070,6 +2236,102 @@ TEST_CASE(conv2d_padding_stride_test)
     EXPECT(migraphx::verify_range(results_vector, s));
 }
 
+TEST_CASE(conv2d_dilation_test)
+{
+    migraphx::program p;
+    migraphx::shape a_shape{migraphx::shape::float_type, {1, 1, 5, 5}};
+    std::vector<float> a(25);
+    std::iota(a.begin(), a.end(), 0);
+    auto al = p.add_literal(migraphx::literal{a_shape, a});
+
+    migraphx::shape c_shape{migraphx::shape::float_type, {1, 1, 3, 3}};
+    auto cl = p.add_literal(migraphx::literal{c_shape, {1, 2, 1, 0, 1, 0, -1, 2, 1}});
+
+    p.add_instruction(migraphx::op::convolution{{{2, 2}}, {{1, 1}}, {{2, 2}}}, al, cl);
+    p.compile(migraphx::cpu::target{});
+    auto result = p.eval({}).back();
+
+    std::vector<float> s = {32, 36, 30, 18, 20, 52, 56, 45, 28, 30, 74, 81, 68,
+                            45, 50, 32, 36, 45, 40, 44, 52, 56, 70, 60, 64};
+    std::vector<float> results_vector;
+    result.visit([&](auto output) { results_vector.assign(output.begin(), output.end()); });
+    EXPECT(migraphx::verify_range(results_vector, s));
+}
+
+TEST_CASE(conv2d_group_test)
+{
+    migraphx::program p;
+    migraphx::shape a_shape{migraphx::shape::float_type, {1, 2, 4, 4}};
+    std::vector<float> a(32);
+    std::iota(a.begin(), a.end(), 0);
+    auto al = p.add_literal(migraphx::literal{a_shape, a});
+
+    migraphx::shape c_shape{migraphx::shape::float_type, {2, 1, 2, 2}};
+    auto cl = p.add_literal(migraphx::literal{c_shape, {1, -1, 2, 0, 0, 1, 1, -2}});
+
+    migraphx::op::convolution op;
+    op.group = 2;
+    p.add_instruction(op, al, cl);
+    p.compile(migraphx::cpu::target{});
+    auto result = p.eval({}).back();
+
+    std::vector<float> s = {7, 9, 11, 15, 17, 19, 23, 25, 27, -5, -5, -5, -5, -5, -5, -5, -5, -5};
+    std::vector<float> results_vector;
+    result.visit([&](auto output) { results_vector.assign(output.begin(), output.end()); });
+    EXPECT(migraphx::verify_range(results_vector, s));
+}
+
+TEST_CASE(conv2d_dilation_stride_test)
+{
+    migraphx::program p;
+    migraphx::shape a_shape{migraphx::shape::float_type, {1, 2, 5, 5}};
+    std::vector<float> a(a_shape.elements());
+    std::iota(a.begin(), a.end(), 0);
+    std::transform(a.begin(), a.end(), a.begin(), [](auto x) { return int(x) % 7 - 3; });
+    auto al = p.add_literal(migraphx::literal{a_shape, a});
+
+    migraphx::shape c_shape{migraphx::shape::float_type, {3, 2, 3, 3}};
+    std::vector<float> c(c_shape.elements());
+    std::iota(c.begin(), c.end(), 0);
+    std::transform(c.begin(), c.end(), c.begin(), [](auto x) { return int(x) % 5 - 2; });
+    auto cl = p.add_literal(migraphx::literal{c_shape, c});
+
+    p.add_instruction(migraphx::op::convolution{{{1, 1}}, {{2, 1}}, {{2, 1}}}, al, cl);
+    p.compile(migraphx::cpu::target{});
+    auto result = p.eval({}).back();
+
+    std::vector<float> s = {-6, 11, 5, 13, 3, 6,   -17, -17, -3, 7,  7, 9, -8, -11, -11,
+                            -6, 11, 5, 13, 3, -10, -8,  9,   5,  10, 7, 9, -8, -11, -11};
+    std::vector<float> results_vector;
+    result.visit([&](auto output) { results_vector.assign(output.begin(), output.end()); });
+    EXPECT(migraphx::verify_range(results_vector, s));
+}
+
+TEST_CASE(conv2d_1x1_test)
+{
+    migraphx::program p;
+    migraphx::shape a_shape{migraphx::shape::float_type, {1, 16, 2, 2}};
+    std::vector<float> a(a_shape.elements());
+    std::iota(a.begin(), a.end(), 0);
+    std::transform(a.begin(), a.end(), a.begin(), [](auto x) { return int(x) % 5 - 1; });
+    auto al = p.add_literal(migraphx::literal{a_shape, a});
+
+    migraphx::shape c_shape{migraphx::shape::float_type, {2, 16, 1, 1}};
+    std::vector<float> c(c_shape.elements());
+    std::iota(c.begin(), c.end(), 0);
+    std::transform(c.begin(), c.end(), c.begin(), [](auto x) { return int(x) % 3 - 1; });
+    auto cl = p.add_literal(migraphx::literal{c_shape, c});
+
+    p.add_instruction(migraphx::op::convolution{{{0, 0}}}, al, cl);
+    p.compile(migraphx::cpu::target{});
+    auto result = p.eval({}).back();
+
+    std::vector<float> s = {1, 0, -1, -2, 0, 0, 0, 0};
+    std::vector<float> results_vector;
+    result.visit([&](auto output) { results_vector.assign(output.begin(), output.end()); });
+    EXPECT(migraphx::verify_range(results_vector, s));
+}
+
 TEST_CASE(quant_conv2d_test)
 {
     migraphx::program p;
@@ -2930,4 +3192,744 @@ TEST_CASE(recip_test)
     EXPECT(migraphx::verify_range(results_vector, gold));
 }
 
+TEST_CASE(scratch_memory_test)
+{
+    migraphx::program p;
+    migraphx::shape s{migraphx::shape::float_type, {2, 3}};
+    auto x = p.add_parameter("x", s);
+    auto a = p.add_instruction(migraphx::op::leaky_relu{0.5}, x);
+    auto b = p.add_instruction(migraphx::op::leaky_relu{0.5}, a);
+    p.add_instruction(migraphx::op::reshape{{6}}, b);
+    p.compile(migraphx::cpu::target{});
+    // The scratch memory is allocated by the target
+    EXPECT(p.get_parameter_shapes().size() == 1);
+
+    std::vector<float> x1 = {-4, -2, 0, 2, 4, 8};
+    std::vector<float> x2(6, 1);
+    auto result1 = p.eval({{"x", migraphx::argument{s, x1.data()}}}).back();
+    auto result2 = p.eval({{"x", migraphx::argument{s, x2.data()}}}).back();
+    // The result of the first run is not overwritten by the second run
+    std::vector<float> results_vector1;
+    result1.visit([&](auto output) { results_vector1.assign(output.begin(), output.end()); });
+    std::vector<float> results_vector2;
+    result2.visit([&](auto output) { results_vector2.assign(output.begin(), output.end()); });
+    std::vector<float> gold1 = {-1, -0.5, 0, 2, 4, 8};
+    EXPECT(migraphx::verify_range(results_vector1, gold1));
+    EXPECT(migraphx::verify_range(results_vector2, x2));
+}
+
+TEST_CASE(scratch_memory_copy_test)
+{
+    std::vector<char*> buffers;
+    migraphx::program p1;
+    migraphx::shape s{migraphx::shape::float_type, {2, 3}};
+    auto x = p1.add_parameter("x", s);
+    auto a = p1.add_instruction(migraphx::op::leaky_relu{0.5}, x);
+    auto c = p1.add_instruction(
+        migraphx::op::capture{0,
+                              [&](std::size_t, const std::vector<migraphx::argument>& args) {
+                                  buffers.push_back(args.front().data());
+                              }},
+        a);
+    p1.add_instruction(migraphx::op::leaky_relu{0.5}, c);
+    p1.compile(migraphx::cpu::target{});
+    auto p2 = p1;
+
+    std::vector<float> x1 = {-4, -2, 0, 2, 4, 8};
+    migraphx::program::parameter_map params{{"x", migraphx::argument{s, x1.data()}}};
+    p1.eval(params);
+    p2.eval(params);
+    // A copy of the program has its own scratch memory, so copies can run at
+    // the same time
+    EXPECT(buffers.size() == 2);
+    EXPECT(buffers[0] != buffers[1]);
+}
+
+TEST_CASE(out_op_test)
+{
+    migraphx::program p;
+    migraphx::shape s{migraphx::shape::float_type, {2, 3}};
+    auto x = p.add_parameter("x", s);
+    auto y = p.add_parameter("y", s);
+    auto a = p.add_instruction(migraphx::op::add{}, x, y);
+    auto b = p.add_instruction(migraphx::op::relu{}, a);
+    auto t = p.add_instruction(migraphx::op::transpose{{1, 0}}, b);
+    auto c = p.add_instruction(migraphx::op::contiguous{}, t);
+    p.add_instruction(migraphx::op::concat{0}, c, c);
+    p.compile(migraphx::cpu::target{});
+    // The operators write to memory they are given instead of allocating it,
+    // and the only ones left wrapped return a view of their input
+    for(auto ins : migraphx::iterator_for(p))
+    {
+        if(ins->name() != "cpu::op")
+            continue;
+        bool view = migraphx::instruction::get_output_alias(ins) != ins;
+        EXPECT(view);
+    }
+
+    std::vector<float> x1 = {-4, -2, 0, 2, 4, 8};
+    std::vector<float> y1 = {1, 1, 1, 1, 1, 1};
+    migraphx::program::parameter_map params;
+    params["x"] = migraphx::argument{s, x1.data()};
+    params["y"] = migraphx::argument{s, y1.data()};
+    auto result = p.eval(params).back();
+    std::vector<float> results_vector;
+    result.visit([&](auto output) { results_vector.assign(output.begin(), output.end()); });
+    std::vector<float> gold = {0, 3, 0, 5, 1, 9, 0, 3, 0, 5, 1, 9};
+    EXPECT(migraphx::verify_range(results_vector, gold));
+}
+
+// The cpu target with a context of several streams
+struct cpu_streams_target : migraphx::cpu::target
+{
+    migraphx::context get_context() const { return migraphx::cpu::context{4}; }
+};
+
+TEST_CASE(schedule_streams_test)
+{
+    migraphx::shape s{migraphx::shape::float_type, {16, 16}};
+    auto create_program = [&] {
+        migraphx::program p;
+        auto x = p.add_parameter("x", s);
+        std::vector<migraphx::instruction_ref> branches;
+        for(std::size_t i = 0; i < 4; i++)
+        {
+            std::vector<float> w(s.elements());
+            std::iota(w.begin(), w.end(), i);
+            auto l = p.add_literal(migraphx::literal{s, w});
+            auto d = p.add_instruction(migraphx::op::dot{}, x, l);
+            auto t = p.add_instruction(migraphx::op::transpose{{1, 0}}, d);
+            branches.push_back(p.add_instruction(migraphx::op::tanh{}, t));
+        }
+        p.add_instruction(migraphx::op::concat{1}, branches);
+        return p;
+    };
+    auto p1 = create_program();
+    p1.compile(migraphx::cpu::target{});
+    auto p2 = create_program();
+    p2.compile(cpu_streams_target{});
+    EXPECT(std::any_of(p2.begin(), p2.end(), [](const migraphx::instruction& ins) {
+        return ins.name() == "cpu::set_stream";
+    }));
+
+    // Every run waits for the events recorded in the same run
+    for(std::size_t i = 0; i < 3; i++)
+    {
+        std::vector<float> x(s.elements());
+        std::iota(x.begin(), x.end(), -100.0f * i);
+        std::transform(x.begin(), x.end(), x.begin(), [](auto v) { return v * 0.001f; });
+        migraphx::program::parameter_map params;
+        params["x"] = migraphx::argument{s, x.data()};
+        std::vector<float> results_vector1;
+        p1.eval(params).back().visit(
+            [&](auto output) { results_vector1.assign(output.begin(), output.end()); });
+        std::vector<float> results_vector2;
+        p2.eval(params).back().visit(
+            [&](auto output) { results_vector2.assign(output.begin(), output.end()); });
+        EXPECT(migraphx::verify_range(results_vector1, results_vector2));
+    }
+}
+
+TEST_CASE(schedule_streams_capture_test)
+{
+    // capture reads the results of the branches once their streams finish
+    migraphx::shape s{migraphx::shape::float_type, {16, 16}};
+    std::vector<std::vector<float>> captured(4);
+    auto callback = [&](std::size_t i, const std::vector<migraphx::argument>& args) {
+        args.front().visit([&](auto x) { captured[i].assign(x.begin(), x.end()); });
+    };
+    auto create_program = [&] {
+        migraphx::program p;
+        auto x = p.add_parameter("x", s);
+        std::vector<migraphx::instruction_ref> branches;
+        for(std::size_t i = 0; i < 4; i++)
+        {
+            std::vector<float> w(s.elements());
+            std::iota(w.begin(), w.end(), i);
+            auto l = p.add_literal(migraphx::literal{s, w});
+            auto d = p.add_instruction(migraphx::op::dot{}, x, l);
+            auto c = p.add_instruction(migraphx::op::capture{i, callback}, d);
+            branches.push_back(p.add_instruction(migraphx::op::tanh{}, c));
+        }
+        p.add_instruction(migraphx::op::concat{1}, branches);
+        return p;
+    };
+    auto p1 = create_program();
+    p1.compile(migraphx::cpu::target{});
+    auto p2 = create_program();
+    p2.compile(cpu_streams_target{});
+
+    std::vector<float> x(s.elements());
+    std::iota(x.begin(), x.end(), 0.0f);
+    std::transform(x.begin(), x.end(), x.begin(), [](auto v) { return v * 0.001f; });
+    migraphx::program::parameter_map params;
+    params["x"] = migraphx::argument{s, x.data()};
+    p1.eval(params);
+    auto captured1 = captured;
+    captured.assign(4, {});
+    p2.eval(params);
+    for(std::size_t i = 0; i < 4; i++)
+        EXPECT(migraphx::verify_range(captured1[i], captured[i]));
+}
+
+TEST_CASE(schedule_streams_copy_test)
+{
+    // Copies of a program run on their own streams and events, so they can
+    // run at the same time
+    migraphx::shape s{migraphx::shape::float_type, {16, 16}};
+    migraphx::program p1;
+    auto x = p1.add_parameter("x", s);
+    std::vector<migraphx::instruction_ref> branches;
+    for(std::size_t i = 0; i < 4; i++)
+    {
+        std::vector<float> w(s.elements());
+        std::iota(w.begin(), w.end(), i);
+        auto l = p1.add_literal(migraphx::literal{s, w});
+        auto d = p1.add_instruction(migraphx::op::dot{}, x, l);
+        branches.push_back(p1.add_instruction(migraphx::op::tanh{}, d));
+    }
+    p1.add_instruction(migraphx::op::concat{1}, branches);
+    p1.compile(cpu_streams_target{});
+    auto p2 = p1;
+
+    auto make_params = [&](std::vector<float>& data, float scale) {
+        data.resize(s.elements());
+        std::iota(data.begin(), data.end(), 0.0f);
+        std::transform(data.begin(), data.end(), data.begin(), [&](auto v) { return v * scale; });
+        return migraphx::program::parameter_map{{"x", migraphx::argument{s, data.data()}}};
+    };
+    auto run = [](const migraphx::program& p, const migraphx::program::parameter_map& params) {
+        std::vector<float> result;
+        p.eval(params).back().visit(
+            [&](auto output) { result.assign(output.begin(), output.end()); });
+        return result;
+    };
+    std::vector<float> x1;
+    std::vector<float> x2;
+    auto params1 = make_params(x1, 0.001f);
+    auto params2 = make_params(x2, -0.002f);
+    auto gold1   = run(p1, params1);
+    auto gold2   = run(p1, params2);
+
+    std::vector<std::vector<float>> results1(8);
+    std::vector<std::vector<float>> results2(8);
+    std::thread t1([&] {
+        for(auto& r : results1)
+            r = run(p1, params1);
+    });
+    std::thread t2([&] {
+        for(auto& r : results2)
+            r = run(p2, params2);
+    });
+    t1.join();
+    t2.join();
+    for(std::size_t i = 0; i < results1.size(); i++)
+    {
+        EXPECT(migraphx::verify_range(results1[i], gold1));
+        EXPECT(migraphx::verify_range(results2[i], gold2));
+    }
+}
+
+TEST_CASE(nhwc_conv_chain_test)
+{
+    // A tf model transposes from nhwc to nchw around every convolution, which
+    // runs with the channels last without copies between the layers
+    const std::size_t n = 2;
+    const std::size_t c = 4;
+    const std::size_t h = 8;
+    const std::size_t w = 8;
+    const std::size_t k = 16;
+    migraphx::shape w1s{migraphx::shape::float_type, {k, c, 3, 3}};
+    migraphx::shape w2s{migraphx::shape::float_type, {c, k, 1, 1}};
+    migraphx::shape bs{migraphx::shape::float_type, {k}};
+    auto values = [](const migraphx::shape& s, float scale) {
+        std::vector<float> v(s.elements());
+        std::size_t i = 0;
+        std::generate(v.begin(), v.end(), [&] { return scale * std::sin(float(i++)); });
+        return v;
+    };
+    auto w1 = values(w1s, 0.5f);
+    auto w2 = values(w2s, 0.25f);
+    auto b  = values(bs, 1.0f);
+    auto create_program = [&](bool nhwc) {
+        migraphx::program p;
+        auto to_nchw = [&](auto ins) {
+            return nhwc ? p.add_instruction(migraphx::op::transpose{{0, 3, 1, 2}}, ins) : ins;
+        };
+        auto to_nhwc = [&](auto ins) {
+            return nhwc ? p.add_instruction(migraphx::op::transpose{{0, 2, 3, 1}}, ins) : ins;
+        };
+        std::vector<std::size_t> xlens = {n, c, h, w};
+        if(nhwc)
+            xlens = {n, h, w, c};
+        auto x  = p.add_parameter("x", {migraphx::shape::float_type, xlens});
+        auto l1 = p.add_literal(migraphx::literal{w1s, w1});
+        auto l2 = p.add_literal(migraphx::literal{w2s, w2});
+        auto lb = p.add_literal(migraphx::literal{bs, b});
+        auto c1 = to_nhwc(
+            p.add_instruction(migraphx::op::convolution{{{1, 1}}, {{1, 1}}}, to_nchw(x), l1));
+        auto bb = p.add_instruction(
+            migraphx::op::broadcast{nhwc ? 3u : 1u, c1->get_shape().lens()}, lb);
+        auto r    = p.add_instruction(migraphx::op::relu{},
+                                   p.add_instruction(migraphx::op::add{}, c1, bb));
+        auto pool = p.add_instruction(
+            migraphx::op::pooling{"max", {{0, 0}}, {{2, 2}}, {{2, 2}}}, to_nchw(r));
+        to_nhwc(p.add_instruction(migraphx::op::convolution{}, pool, l2));
+        return p;
+    };
+
+    auto p1 = create_program(true);
+    p1.compile(migraphx::cpu::target{});
+    // Only the result of the program is copied from the last transpose
+    EXPECT(std::count_if(p1.begin(), p1.end(), [](const migraphx::instruction& ins) {
+               return ins.name() == "cpu::contiguous";
+           }) == 1);
+    auto p2 = create_program(false);
+    p2.compile(migraphx::cpu::target{});
+
+    std::vector<float> x1(n * h * w * c);
+    std::vector<float> x2(x1.size());
+    std::iota(x1.begin(), x1.end(), 0.0f);
+    std::transform(x1.begin(), x1.end(), x1.begin(), [](auto v) { return std::cos(v); });
+    for(std::size_t i = 0; i < x1.size(); i++)
+    {
+        auto ci = i % c;
+        auto wi = (i / c) % w;
+        auto hi = (i / (c * w)) % h;
+        auto ni = i / (c * w * h);
+        x2[((ni * c + ci) * h + hi) * w + wi] = x1[i];
+    }
+    migraphx::program::parameter_map params1;
+    params1["x"] = migraphx::argument{{migraphx::shape::float_type, {n, h, w, c}}, x1.data()};
+    migraphx::program::parameter_map params2;
+    params2["x"] = migraphx::argument{{migraphx::shape::float_type, {n, c, h, w}}, x2.data()};
+    std::vector<float> results_vector1;
+    p1.eval(params1).back().visit(
+        [&](auto output) { results_vector1.assign(output.begin(), output.end()); });
+    // The result of the nchw program in nhwc order
+    std::vector<float> results_vector2;
+    p2.eval(params2).back().visit([&](auto output) {
+        const auto& lens = output.get_shape().lens();
+        for(std::size_t ni = 0; ni < lens[0]; ni++)
+            for(std::size_t hi = 0; hi < lens[2]; hi++)
+                for(std::size_t wi = 0; wi < lens[3]; wi++)
+                    for(std::size_t ci = 0; ci < lens[1]; ci++)
+                        results_vector2.push_back(output(ni, ci, hi, wi));
+    });
+    EXPECT(migraphx::verify_range(results_vector1, results_vector2));
+}
+
+TEST_CASE(nhwc_conv_add_result_test)
+{
+    // The add reads the convolutions with the channels last and writes the
+    // standard result of the program
+    const std::size_t n = 1;
+    const std::size_t c = 4;
+    const std::size_t h = 4;
+    const std::size_t w = 4;
+    const std::size_t k = 8;
+    migraphx::shape w1s{migraphx::shape::float_type, {k, c, 3, 3}};
+    migraphx::shape w2s{migraphx::shape::float_type, {k, c, 2, 2}};
+    std::vector<float> w1(w1s.elements());
+    std::vector<float> w2(w2s.elements());
+    std::iota(w1.begin(), w1.end(), 0.0f);
+    std::transform(w1.begin(), w1.end(), w1.begin(), [](auto v) { return std::sin(v); });
+    std::iota(w2.begin(), w2.end(), 0.0f);
+    std::transform(w2.begin(), w2.end(), w2.begin(), [](auto v) { return std::cos(v); });
+    auto create_program = [&](bool nhwc) {
+        migraphx::program p;
+        std::vector<std::size_t> xlens = {n, c, h, w};
+        if(nhwc)
+            xlens = {n, h, w, c};
+        auto x = p.add_parameter("x", {migraphx::shape::float_type, xlens});
+        if(nhwc)
+            x = p.add_instruction(migraphx::op::transpose{{0, 3, 1, 2}}, x);
+        auto l1 = p.add_literal(migraphx::literal{w1s, w1});
+        auto l2 = p.add_literal(migraphx::literal{w2s, w2});
+        auto c1 = p.add_instruction(migraphx::op::convolution{{{1, 1}}, {{1, 1}}}, x, l1);
+        auto c2 = p.add_instruction(migraphx::op::convolution{{{1, 1}}, {{1, 1}}, {{2, 2}}}, x, l2);
+        p.add_instruction(migraphx::op::add{}, c1, c2);
+        return p;
+    };
+
+    auto p1 = create_program(true);
+    p1.compile(migraphx::cpu::target{});
+    auto p2 = create_program(false);
+    p2.compile(migraphx::cpu::target{});
+
+    std::vector<float> x1(n * h * w * c);
+    std::vector<float> x2(x1.size());
+    std::iota(x1.begin(), x1.end(), 0.0f);
+    std::transform(x1.begin(), x1.end(), x1.begin(), [](auto v) { return std::cos(v); });
+    for(std::size_t i = 0; i < x1.size(); i++)
+    {
+        auto ci = i % c;
+        auto wi = (i / c) % w;
+        auto hi = (i / (c * w)) % h;
+        auto ni = i / (c * w * h);
+        x2[((ni * c + ci) * h + hi) * w + wi] = x1[i];
+    }
+    migraphx::program::parameter_map params1;
+    params1["x"] = migraphx::argument{{migraphx::shape::float_type, {n, h, w, c}}, x1.data()};
+    migraphx::program::parameter_map params2;
+    params2["x"] = migraphx::argument{{migraphx::shape::float_type, {n, c, h, w}}, x2.data()};
+    auto result1 = p1.eval(params1).back();
+    auto result2 = p2.eval(params2).back();
+    EXPECT(result1.get_shape().standard());
+    std::vector<float> results_vector1;
+    result1.visit([&](auto output) { results_vector1.assign(output.begin(), output.end()); });
+    std::vector<float> results_vector2;
+    result2.visit([&](auto output) { results_vector2.assign(output.begin(), output.end()); });
+    EXPECT(migraphx::verify_range(results_vector1, results_vector2));
+}
+
+TEST_CASE(fuse_pointwise_test)
+{
+    migraphx::program p;
+    // More than one block of elements
+    migraphx::shape s{migraphx::shape::float_type, {3, 1000}};
+    migraphx::shape bs{migraphx::shape::float_type, {1000}};
+    std::vector<float> bias(bs.elements());
+    std::iota(bias.begin(), bias.end(), -500);
+    auto x  = p.add_parameter("x", s);
+    auto b  = p.add_literal(migraphx::literal{bs, bias});
+    auto bb = p.add_instruction(migraphx::op::broadcast{1, s.lens()}, b);
+    auto a  = p.add_instruction(migraphx::op::add{}, x, bb);
+    auto m  = p.add_instruction(migraphx::op::mul{}, a, x);
+    p.add_instruction(migraphx::op::relu{}, m);
+    p.compile(migraphx::cpu::target{});
+    EXPECT(std::count_if(p.begin(), p.end(), [](const migraphx::instruction& ins) {
+               return ins.name() == "cpu::pointwise";
+           }) == 1);
+    EXPECT(std::none_of(p.begin(), p.end(), [](const migraphx::instruction& ins) {
+        return ins.name() == "cpu::add" or ins.name() == "cpu::mul" or ins.name() == "cpu::relu";
+    }));
+    // The fused operators are saved with their names
+    migraphx::program p2;
+    p2.from_value(p.to_value());
+    EXPECT(p == p2);
+
+    std::vector<float> x1(s.elements());
+    std::iota(x1.begin(), x1.end(), -1000);
+    migraphx::program::parameter_map params;
+    params["x"] = migraphx::argument{s, x1.data()};
+    auto result = p.eval(params).back();
+    std::vector<float> results_vector;
+    result.visit([&](auto output) { results_vector.assign(output.begin(), output.end()); });
+    std::vector<float> gold(s.elements());
+    for(std::size_t i = 0; i < gold.size(); i++)
+        gold[i] = std::max(0.0f, (x1[i] + bias[i % bias.size()]) * x1[i]);
+    EXPECT(migraphx::verify_range(results_vector, gold));
+}
+
+TEST_CASE(pointwise_strided_test)
+{
+    // A transposed and a broadcast input are gathered, and the output with
+    // gaps between its rows is scattered, a row at a time
+    migraphx::cpu::pointwise op;
+    op.ops       = {migraphx::op::add{}, migraphx::op::neg{}};
+    op.op_inputs = {0, 1, 2};
+    migraphx::shape xs{migraphx::shape::float_type, {3, 5}, {1, 3}};
+    migraphx::shape bs{migraphx::shape::float_type, {3, 5}, {0, 1}};
+    migraphx::shape os{migraphx::shape::float_type, {3, 5}, {8, 1}};
+    std::vector<float> x(15);
+    std::iota(x.begin(), x.end(), 0);
+    std::vector<float> b = {0, 10, 20, 30, 40};
+    std::vector<float> out(24, 100);
+    op.compute_to(migraphx::argument{os, out.data()},
+                  {migraphx::argument{xs, x.data()}, migraphx::argument{bs, b.data()}});
+    std::vector<float> gold(24, 100);
+    for(std::size_t i = 0; i < 3; i++)
+    {
+        for(std::size_t j = 0; j < 5; j++)
+            gold[i * 8 + j] = -(x[i + 3 * j] + b[j]);
+    }
+    EXPECT(migraphx::verify_range(out, gold));
+}
+
+TEST_CASE(fuse_pointwise_shared_test)
+{
+    migraphx::program p;
+    migraphx::shape s{migraphx::shape::float_type, {4}};
+    auto x = p.add_parameter("x", s);
+    auto y = p.add_parameter("y", s);
+    auto a = p.add_instruction(migraphx::op::add{}, x, y);
+    // The sum is used twice, so it stays its own instruction
+    auto e = p.add_instruction(migraphx::op::exp{}, a);
+    auto n = p.add_instruction(migraphx::op::neg{}, a);
+    auto m = p.add_instruction(migraphx::op::mul{}, e, n);
+    p.add_instruction(migraphx::op::sub{}, m, a);
+    p.compile(migraphx::cpu::target{});
+    EXPECT(std::count_if(p.begin(), p.end(), [](const migraphx::instruction& ins) {
+               return ins.name() == "cpu::add";
+           }) == 1);
+    EXPECT(std::count_if(p.begin(), p.end(), [](const migraphx::instruction& ins) {
+               return ins.name() == "cpu::pointwise";
+           }) == 1);
+
+    std::vector<float> x1 = {-1, 0, 0.5, 1};
+    std::vector<float> y1 = {0.5, 0.25, 0, -2};
+    migraphx::program::parameter_map params;
+    params["x"] = migraphx::argument{s, x1.data()};
+    params["y"] = migraphx::argument{s, y1.data()};
+    auto result = p.eval(params).back();
+    std::vector<float> results_vector;
+    result.visit([&](auto output) { results_vector.assign(output.begin(), output.end()); });
+    std::vector<float> gold(s.elements());
+    for(std::size_t i = 0; i < gold.size(); i++)
+    {
+        auto z  = x1[i] + y1[i];
+        gold[i] = std::exp(z) * -z - z;
+    }
+    EXPECT(migraphx::verify_range(results_vector, gold));
+}
+
+TEST_CASE(unary_math_test)
+{
+    // More than one block of elements, read through a slice, which is packed,
+    // and through a transpose, which is strided
+    const std::size_t n = 10000;
+    auto eval = [](migraphx::program p) {
+        p.compile(migraphx::cpu::target{});
+        std::vector<float> results_vector;
+        p.eval({}).back().visit(
+            [&](auto output) { results_vector.assign(output.begin(), output.end()); });
+        return results_vector;
+    };
+    auto run = [&](const migraphx::operation& op, float first, float last, auto f) {
+        migraphx::shape s{migraphx::shape::float_type, {2, n}};
+        std::vector<float> data(s.elements());
+        for(std::size_t i = 0; i < data.size(); i++)
+            data[i] = first + (last - first) * (i % n) / (n - 1);
+        migraphx::program p1;
+        auto l1 = p1.add_literal(migraphx::literal{s, data});
+        auto sl = p1.add_instruction(migraphx::op::slice{{0}, {1}, {2}}, l1);
+        p1.add_instruction(op, sl);
+        std::vector<float> gold(n);
+        std::transform(data.begin() + n, data.end(), gold.begin(), f);
+        EXPECT(migraphx::verify_range(eval(p1), gold));
+
+        migraphx::shape ts{migraphx::shape::float_type, {100, n / 100}};
+        migraphx::program p2;
+        auto l2 = p2.add_literal(migraphx::literal{ts, data.begin(), data.begin() + n});
+        auto t  = p2.add_instruction(migraphx::op::transpose{{1, 0}}, l2);
+        // The reshape keeps the transpose from being moved past the operator
+        p2.add_instruction(migraphx::op::reshape{{int64_t(n)}}, p2.add_instruction(op, t));
+        for(std::size_t i = 0; i < n; i++)
+            gold[i] = f(data[(i % 100) * (n / 100) + i / 100]);
+        EXPECT(migraphx::verify_range(eval(p2), gold));
+    };
+    run(migraphx::op::exp{}, -80, 80, [](float x) { return std::exp(x); });
+    run(migraphx::op::log{}, 1e-30, 1e30, [](float x) { return std::log(x); });
+    run(migraphx::op::tanh{}, -10, 10, [](float x) { return std::tanh(x); });
+    run(migraphx::op::sigmoid{}, -20, 20, [](float x) { return sigmoid(x); });
+    run(migraphx::op::erf{}, -5, 5, [](float x) { return std::erf(x); });
+}
+
+TEST_CASE(exp_nan_test)
+{
+    migraphx::program p;
+    migraphx::shape s{migraphx::shape::float_type, {3}};
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const float inf = std::numeric_limits<float>::infinity();
+    auto l          = p.add_literal(migraphx::literal{s, {nan, 0.0f, inf}});
+    p.add_instruction(migraphx::op::exp{}, l);
+    p.compile(migraphx::cpu::target{});
+    auto result = p.eval({}).back();
+    std::vector<float> results_vector;
+    result.visit([&](auto output) { results_vector.assign(output.begin(), output.end()); });
+    EXPECT(std::isnan(results_vector[0]));
+    EXPECT(results_vector[1] == 1.0f);
+    EXPECT(std::isinf(results_vector[2]));
+}
+
+migraphx::instruction_ref add_scalar(migraphx::program& p, float x, const migraphx::shape& s)
+{
+    auto l = p.add_literal(migraphx::literal{migraphx::shape{s.type(), {1}}, {x}});
+    return p.add_instruction(migraphx::op::multibroadcast{s.lens()}, l);
+}
+
+void run_gelu(migraphx::program& p, const migraphx::shape& s)
+{
+    p.compile(migraphx::cpu::target{});
+    EXPECT(std::count_if(p.begin(), p.end(), [](const migraphx::instruction& ins) {
+               return ins.name() == "cpu::gelu";
+           }) == 1);
+    EXPECT(std::none_of(p.begin(), p.end(), [](const migraphx::instruction& ins) {
+        return ins.name() == "cpu::erf" or ins.name() == "cpu::tanh" or
+               ins.name() == "cpu::pointwise";
+    }));
+
+    std::vector<float> x1(s.elements());
+    std::iota(x1.begin(), x1.end(), -50);
+    std::transform(x1.begin(), x1.end(), x1.begin(), [](auto x) { return x / 10; });
+    migraphx::program::parameter_map params;
+    params["x"] = migraphx::argument{s, x1.data()};
+    auto result = p.eval(params).back();
+    std::vector<float> results_vector;
+    result.visit([&](auto output) { results_vector.assign(output.begin(), output.end()); });
+    std::vector<float> gold(s.elements());
+    std::transform(x1.begin(), x1.end(), gold.begin(), [](float x) {
+        return x * 0.5f * (1.0f + std::erf(x / std::sqrt(2.0f)));
+    });
+    EXPECT(migraphx::verify_range(results_vector, gold));
+}
+
+TEST_CASE(fuse_gelu_test)
+{
+    migraphx::program p;
+    migraphx::shape s{migraphx::shape::float_type, {2, 50}};
+    auto x = p.add_parameter("x", s);
+    auto d = p.add_instruction(migraphx::op::div{}, x, add_scalar(p, std::sqrt(2.0f), s));
+    auto e = p.add_instruction(migraphx::op::erf{}, d);
+    auto a = p.add_instruction(migraphx::op::add{}, e, add_scalar(p, 1.0f, s));
+    auto m = p.add_instruction(migraphx::op::mul{}, x, a);
+    p.add_instruction(migraphx::op::mul{}, m, add_scalar(p, 0.5f, s));
+    run_gelu(p, s);
+}
+
+TEST_CASE(fuse_gelu_tanh_test)
+{
+    // The tanh approximation is replaced by gelu with erf by default
+    migraphx::program p;
+    migraphx::shape s{migraphx::shape::float_type, {2, 50}};
+    auto x  = p.add_parameter("x", s);
+    auto c  = p.add_instruction(migraphx::op::pow{}, x, add_scalar(p, 3.0f, s));
+    auto c1 = p.add_instruction(migraphx::op::mul{}, add_scalar(p, 0.044715f, s), c);
+    auto a1 = p.add_instruction(migraphx::op::add{}, x, c1);
+    auto m1 = p.add_instruction(migraphx::op::mul{}, a1, add_scalar(p, std::sqrt(M_2_PI), s));
+    auto t  = p.add_instruction(migraphx::op::tanh{}, m1);
+    auto a2 = p.add_instruction(migraphx::op::add{}, add_scalar(p, 1.0f, s), t);
+    auto h  = p.add_instruction(migraphx::op::mul{}, add_scalar(p, 0.5f, s), x);
+    p.add_instruction(migraphx::op::mul{}, h, a2);
+    run_gelu(p, s);
+}
+
+TEST_CASE(empty_program_test)
+{
+    migraphx::program p;
+    p.compile(migraphx::cpu::target{});
+    EXPECT(p.size() == 0);
+}
+
+TEST_CASE(strided_inputs_test)
+{
+    // The transposed and broadcast inputs are read by the kernels without
+    // copies
+    const std::size_t n = 2;
+    const std::size_t k = 3;
+    const std::size_t m = 4;
+    const std::size_t j = 5;
+    migraphx::shape xs{migraphx::shape::float_type, {n, k, m}};
+    migraphx::shape ys{migraphx::shape::float_type, {n, k, j}};
+    migraphx::program p;
+    auto x   = p.add_parameter("x", xs);
+    auto y   = p.add_parameter("y", ys);
+    auto xt  = p.add_instruction(migraphx::op::transpose{{0, 2, 1}}, x);
+    auto sum = p.add_instruction(migraphx::op::reduce_sum{{2}}, xt);
+    auto sb  = p.add_instruction(migraphx::op::multibroadcast{{n, m, j}}, sum);
+    auto dot = p.add_instruction(migraphx::op::dot{}, xt, y);
+    p.add_instruction(migraphx::op::add{}, dot, sb);
+    p.compile(migraphx::cpu::target{});
+    EXPECT(std::none_of(p.begin(), p.end(), [](const migraphx::instruction& ins) {
+        return ins.name() == "cpu::contiguous";
+    }));
+
+    std::vector<float> xv(xs.elements());
+    std::vector<float> yv(ys.elements());
+    std::iota(xv.begin(), xv.end(), 0.0f);
+    std::transform(xv.begin(), xv.end(), xv.begin(), [](auto v) { return std::sin(v); });
+    std::iota(yv.begin(), yv.end(), 0.0f);
+    std::transform(yv.begin(), yv.end(), yv.begin(), [](auto v) { return std::cos(v); });
+    std::vector<float> gold;
+    for(std::size_t ni = 0; ni < n; ni++)
+    {
+        for(std::size_t mi = 0; mi < m; mi++)
+        {
+            for(std::size_t ji = 0; ji < j; ji++)
+            {
+                float r = 0;
+                for(std::size_t ki = 0; ki < k; ki++)
+                {
+                    auto xi = xv[(ni * k + ki) * m + mi];
+                    r += xi * yv[(ni * k + ki) * j + ji] + xi;
+                }
+                gold.push_back(r);
+            }
+        }
+    }
+    migraphx::program::parameter_map params;
+    params["x"] = migraphx::argument{xs, xv.data()};
+    params["y"] = migraphx::argument{ys, yv.data()};
+    std::vector<float> results_vector;
+    p.eval(params).back().visit(
+        [&](auto output) { results_vector.assign(output.begin(), output.end()); });
+    EXPECT(migraphx::verify_range(results_vector, gold));
+}
+
+TEST_CASE(strided_softmax_test)
+{
+    // softmax and logsoftmax gather a transposed input a row at a time on
+    // the last axis, or a tile of columns at a time on an inner axis. The
+    // reshape keeps the transpose from being moved past them.
+    const std::size_t a = 2;
+    const std::size_t b = 600;
+    const std::size_t c = 5;
+    migraphx::shape xs{migraphx::shape::float_type, {a, b, c}};
+    std::vector<float> xv(xs.elements());
+    std::iota(xv.begin(), xv.end(), 0.0f);
+    std::transform(xv.begin(), xv.end(), xv.begin(), [](auto v) { return 4 * std::sin(v); });
+    auto run = [&](const migraphx::operation& op) {
+        migraphx::program p;
+        auto x  = p.add_parameter("x", xs);
+        auto xt = p.add_instruction(migraphx::op::transpose{{0, 2, 1}}, x);
+        auto sm = p.add_instruction(op, xt);
+        p.add_instruction(migraphx::op::reshape{{int64_t(a * b * c)}}, sm);
+        p.compile(migraphx::cpu::target{});
+        EXPECT(std::none_of(p.begin(), p.end(), [](const migraphx::instruction& ins) {
+            return ins.name() == "cpu::contiguous";
+        }));
+        migraphx::program::parameter_map params;
+        params["x"] = migraphx::argument{xs, xv.data()};
+        std::vector<float> results_vector;
+        p.eval(params).back().visit(
+            [&](auto output) { results_vector.assign(output.begin(), output.end()); });
+        return results_vector;
+    };
+    // The softmax of the transposed tensor, of lens {a, c, b}, along axis
+    auto gold = [&](std::size_t axis, bool log) {
+        std::vector<std::size_t> lens = {a, c, b};
+        std::vector<float> result(xs.elements());
+        auto value = [&](std::size_t i, std::size_t ci, std::size_t bi) {
+            return xv[(i * b + bi) * c + ci];
+        };
+        for(std::size_t i = 0; i < a; i++)
+        {
+            for(std::size_t o = 0; o < lens[3 - axis]; o++)
+            {
+                auto at = [&](std::size_t e) {
+                    return axis == 1 ? std::make_pair(e, o) : std::make_pair(o, e);
+                };
+                float m = std::numeric_limits<float>::lowest();
+                for(std::size_t e = 0; e < lens[axis]; e++)
+                    m = std::max(m, value(i, at(e).first, at(e).second));
+                float sum = 0;
+                for(std::size_t e = 0; e < lens[axis]; e++)
+                    sum += std::exp(value(i, at(e).first, at(e).second) - m);
+                for(std::size_t e = 0; e < lens[axis]; e++)
+                {
+                    auto v      = value(i, at(e).first, at(e).second) - m;
+                    auto idx    = (i * c + at(e).first) * b + at(e).second;
+                    result[idx] = log ? v - std::log(sum) : std::exp(v) / sum;
+                }
+            }
+        }
+        return result;
+    };
+    EXPECT(migraphx::verify_range(run(migraphx::op::softmax{2}), gold(2, false)));
+    EXPECT(migraphx::verify_range(run(migraphx::op::softmax{1}), gold(1, false)));
+    EXPECT(migraphx::verify_range(run(migraphx::op::logsoftmax{2}), gold(2, true)));
+    EXPECT(migraphx::verify_range(run(migraphx::op::logsoftmax{1}), gold(1, true)));
+}
+
 int main(int argc, const char* argv[]) { test::run(argc, argv); }
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <iostream>
 #include <vector>
 #include <migraphx/literal.hpp>
@@ -10,6 +11,10 @@
 #include <migraphx/op/concat.hpp>
 #include <migraphx/instruction.hpp>
 #include <migraphx/cpu/target.hpp>
+#include <migraphx/dead_code_elimination.hpp>
+#include <migraphx/generate.hpp>
+#include <migraphx/pass_manager.hpp>
+#include <migraphx/rewrite_rnn.hpp>
 #include <migraphx/verify.hpp>
 #include <migraphx/onnx.hpp>
 #include "test.hpp"
@@ -4169,4 +4174,79 @@ TEST_CASE(lstm_bidirectional_actv_func)
     }
 }
 
+TEST_CASE(lstm_native_var_seq_lens)
+{
+    std::size_t batch_size  = 3;
+    std::size_t seq_len     = 4;
+    std::size_t hidden_size = 4;
+    std::size_t input_size  = 3;
+    std::size_t num_dirct   = 2;
+    migraphx::shape in_shape{migraphx::shape::float_type, {seq_len, batch_size, input_size}};
+    migraphx::shape w_shape{migraphx::shape::float_type,
+                            {num_dirct, 4 * hidden_size, input_size}};
+    migraphx::shape r_shape{migraphx::shape::float_type,
+                            {num_dirct, 4 * hidden_size, hidden_size}};
+    migraphx::shape b_shape{migraphx::shape::float_type, {num_dirct, 8 * hidden_size}};
+    migraphx::shape ihc_shape{migraphx::shape::float_type, {num_dirct, batch_size, hidden_size}};
+    migraphx::shape pph_shape{migraphx::shape::float_type, {num_dirct, 3 * hidden_size}};
+    migraphx::shape sl_shape{migraphx::shape::int32_type, {batch_size}};
+    std::vector<int32_t> sl_data{4, 1, 3};
+
+    auto create_program = [&] {
+        migraphx::program p;
+        auto seq  = p.add_literal(migraphx::generate_literal(in_shape, 0));
+        auto w    = p.add_literal(migraphx::generate_literal(w_shape, 1));
+        auto r    = p.add_literal(migraphx::generate_literal(r_shape, 2));
+        auto bias = p.add_literal(migraphx::generate_literal(b_shape, 3));
+        auto sql  = p.add_literal(sl_shape, sl_data);
+        auto ih   = p.add_literal(migraphx::generate_literal(ihc_shape, 4));
+        auto ic   = p.add_literal(migraphx::generate_literal(ihc_shape, 5));
+        auto pph  = p.add_literal(migraphx::generate_literal(pph_shape, 6));
+        auto hs   = p.add_instruction(
+            migraphx::op::lstm{hidden_size,
+                               {migraphx::op::sigmoid{}, migraphx::op::tanh{}, migraphx::op::tanh{}},
+                               migraphx::op::rnn_direction::bidirectional,
+                               0.0f,
+                               0},
+            seq,
+            w,
+            r,
+            bias,
+            sql,
+            ih,
+            ic,
+            pph);
+        auto lho = p.add_instruction(migraphx::op::rnn_last_hs_output{}, hs);
+        auto lco = p.add_instruction(migraphx::op::rnn_last_cell_output{}, hs);
+        p.add_return({hs, lho, lco});
+        return p;
+    };
+
+    // The lstm is kept as one operator instead of being unrolled
+    auto p1 = create_program();
+    p1.compile(migraphx::cpu::target{});
+    EXPECT(std::any_of(p1.begin(), p1.end(), [](const migraphx::instruction& ins) {
+        return ins.name() == "cpu::lstm";
+    }));
+    EXPECT(std::none_of(p1.begin(), p1.end(), [](const migraphx::instruction& ins) {
+        return ins.name() == "cpu::dot";
+    }));
+
+    auto p2 = create_program();
+    migraphx::run_passes(p2, {migraphx::rewrite_rnn{}, migraphx::dead_code_elimination{}});
+    p2.compile(migraphx::cpu::target{});
+
+    auto results1 = p1.eval({});
+    auto results2 = p2.eval({});
+    EXPECT(results1.size() == results2.size());
+    for(std::size_t i = 0; i < results1.size(); i++)
+    {
+        std::vector<float> data1;
+        std::vector<float> data2;
+        results1[i].visit([&](auto output) { data1.assign(output.begin(), output.end()); });
+        results2[i].visit([&](auto output) { data2.assign(output.begin(), output.end()); });
+        EXPECT(migraphx::verify_range(data1, data2));
+    }
+}
+
 int main(int argc, const char* argv[]) { test::run(argc, argv); }
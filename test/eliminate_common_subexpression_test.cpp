@@ -141,4 +141,53 @@ TEST_CASE(cse_test_literal)
     EXPECT(p1 == p2);
 }
 
+TEST_CASE(cse_test_chain)
+{
+    migraphx::program p1;
+    {
+        auto one = p1.add_literal(1);
+        auto two = p1.add_literal(2);
+        auto x   = one;
+        auto y   = one;
+        for(int i = 0; i < 100; i++)
+        {
+            x = p1.add_instruction(migraphx::op::add{}, x, two);
+            y = p1.add_instruction(migraphx::op::add{}, y, two);
+        }
+        auto sum = p1.add_instruction(migraphx::op::add{}, x, y);
+        p1.add_instruction(pass_op{}, sum);
+    }
+    run_pass(p1);
+
+    migraphx::program p2;
+    {
+        auto one = p2.add_literal(1);
+        auto two = p2.add_literal(2);
+        auto x   = one;
+        for(int i = 0; i < 100; i++)
+            x = p2.add_instruction(migraphx::op::add{}, x, two);
+        auto sum = p2.add_instruction(migraphx::op::add{}, x, x);
+        p2.add_instruction(pass_op{}, sum);
+    }
+    EXPECT(p1 == p2);
+}
+
+TEST_CASE(cse_test_literal_data)
+{
+    migraphx::program p1;
+    {
+        migraphx::shape s{migraphx::shape::float_type, {32}};
+        std::vector<float> data1(32, 1.0f);
+        std::vector<float> data2(32, 1.0f);
+        data2.back() = 2.0f;
+        auto l1      = p1.add_literal(migraphx::literal{s, data1});
+        auto l2      = p1.add_literal(migraphx::literal{s, data2});
+        auto sum     = p1.add_instruction(migraphx::op::add{}, l1, l2);
+        p1.add_instruction(pass_op{}, sum);
+    }
+    auto p2 = p1;
+    run_pass(p1);
+    EXPECT(p1 == p2);
+}
+
 int main(int argc, const char* argv[]) { test::run(argc, argv); }
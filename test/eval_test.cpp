@@ -67,6 +67,52 @@ struct id_ctx_final_op
     int output_alias(const std::vector<migraphx::shape>&) const { return 0; }
 };
 
+struct track_alloc_op
+{
+    std::shared_ptr<std::weak_ptr<float>> buffer = std::make_shared<std::weak_ptr<float>>();
+
+    template <class Self, class F>
+    static auto reflect(Self&, F)
+    {
+        return migraphx::pack();
+    }
+
+    std::string name() const { return "track_alloc"; }
+    migraphx::argument compute(const migraphx::shape& s, std::vector<migraphx::argument>) const
+    {
+        auto x  = std::make_shared<float>(1);
+        *buffer = x;
+        return {s, x};
+    }
+
+    migraphx::shape compute_shape(std::vector<migraphx::shape>) const
+    {
+        return {migraphx::shape::float_type, {1}};
+    }
+};
+
+struct check_freed_op
+{
+    std::shared_ptr<std::weak_ptr<float>> buffer;
+
+    template <class Self, class F>
+    static auto reflect(Self&, F)
+    {
+        return migraphx::pack();
+    }
+
+    std::string name() const { return "check_freed"; }
+    migraphx::argument compute(const migraphx::shape& s, std::vector<migraphx::argument>) const
+    {
+        return migraphx::literal{s, {buffer->expired() ? 1.0f : 0.0f}}.get_argument();
+    }
+
+    migraphx::shape compute_shape(std::vector<migraphx::shape> inputs) const
+    {
+        return inputs.front();
+    }
+};
+
 struct reverse_pass
 {
     std::string name() const { return "reverse_pass"; }
@@ -139,6 +185,18 @@ TEST_CASE(literal_test1)
     EXPECT(result != migraphx::literal{4});
 }
 
+TEST_CASE(literal_result_test)
+{
+    migraphx::argument result;
+    {
+        migraphx::program p;
+        p.add_literal(4);
+        result = p.eval({}).back();
+    }
+    // The result does not refer to the literal in the program
+    EXPECT(result == migraphx::literal{4});
+}
+
 TEST_CASE(literal_test2)
 {
     migraphx::program p;
@@ -492,6 +550,83 @@ std::string capture_output(F f)
     return ss.str();
 }
 
+TEST_CASE(eval_free_results)
+{
+    migraphx::program p;
+    track_alloc_op alloc;
+    auto a = p.add_instruction(alloc);
+    auto b = p.add_instruction(check_freed_op{alloc.buffer}, a);
+    auto c = p.add_instruction(check_freed_op{alloc.buffer}, b);
+    p.add_return({b, c});
+    auto check = [&] {
+        auto results = p.eval({});
+        EXPECT(results.size() == 2);
+        // The buffer is still used by the first check, but is freed before the
+        // second check runs
+        EXPECT(results[0].at<float>() == 0.0f);
+        EXPECT(results[1].at<float>() == 1.0f);
+    };
+    check();
+    p.compile(id_target{});
+    check();
+}
+
+TEST_CASE(eval_modified_program)
+{
+    migraphx::program p;
+    auto one = p.add_literal(1);
+    auto two = p.add_literal(2);
+    auto sum = p.add_instruction(sum_op{}, one, two);
+    p.compile(id_target{});
+    EXPECT(p.eval({}).back() == migraphx::literal{3});
+    p.add_instruction(sum_op{}, sum, two);
+    EXPECT(p.eval({}).back() == migraphx::literal{5});
+    p.replace_instruction(sum, minus_op{}, two, one);
+    EXPECT(p.eval({}).back() == migraphx::literal{3});
+}
+
+TEST_CASE(eval_modified_copy)
+{
+    migraphx::program p1;
+    auto one = p1.add_literal(1);
+    p1.add_instruction(sum_op{}, one, one);
+    p1.compile(id_target{});
+    EXPECT(p1.eval({}).back() == migraphx::literal{2});
+    // Changing a copy only rebuilds the plan of the copy
+    auto p2  = p1;
+    auto two = p2.add_literal(2);
+    p2.replace_instruction(std::prev(p2.end()), sum_op{}, two, two);
+    EXPECT(p2.eval({}).back() == migraphx::literal{4});
+    EXPECT(p1.eval({}).back() == migraphx::literal{2});
+}
+
+TEST_CASE(eval_replace_argument)
+{
+    migraphx::program p;
+    auto one = p.add_literal(1);
+    auto two = p.add_literal(2);
+    auto sum = p.add_instruction(sum_op{}, one, one);
+    p.compile(id_target{});
+    EXPECT(p.eval({}).back() == migraphx::literal{2});
+    // Passes rewire arguments without the program, which the next run sees
+    // without finalizing the program again
+    migraphx::instruction::replace_argument(sum, one, two);
+    EXPECT(p.eval({}).back() == migraphx::literal{4});
+}
+
+TEST_CASE(eval_returned_literal)
+{
+    migraphx::program p;
+    auto one = p.add_literal(1);
+    p.add_return({one});
+    p.compile(id_target{});
+    auto r1 = p.eval({}).back();
+    r1.visit([](auto x) { x[0] = 5; });
+    // Every run returns its own copy of the literal
+    EXPECT(p.eval({}).back() == migraphx::literal{1});
+    EXPECT(r1 == migraphx::literal{5});
+}
+
 TEST_CASE(debug_print_test)
 {
     migraphx::program p;
@@ -245,4 +245,25 @@ TEST_CASE(literal_value)
     EXPECT(l == l_rev);
 }
 
+TEST_CASE(binary_value)
+{
+    std::vector<char> data = {0, 1, 2, 127, -128, -1};
+    migraphx::value v      = {{"data", migraphx::value::binary{data.data(), data.size()}}};
+    std::string json_str   = migraphx::to_json_string(v);
+    EXPECT(json_str == R"({"data":{"@binary":"0001027f80ff"}})");
+    auto v_rev = migraphx::from_json_string(json_str);
+    EXPECT(v_rev.at("data").is_binary());
+    EXPECT(v_rev == v);
+}
+
+TEST_CASE(binary_like_object)
+{
+    // Only the "@binary" tag is read as binary data
+    migraphx::value v = {{"bytes", {1, 2}}, {"subtype", 0}};
+    auto v_rev        = migraphx::from_json_string(migraphx::to_json_string(v));
+    EXPECT(v_rev.is_object());
+    EXPECT(v_rev == v);
+    EXPECT(test::throws([] { migraphx::from_json_string(R"({"@binary":"0g"})"); }));
+}
+
 int main(int argc, const char* argv[]) { test::run(argc, argv); }
@@ -152,4 +152,24 @@ TEST_CASE(value_argument)
     EXPECT(a4 == a2);
 }
 
+TEST_CASE(value_literal_binary)
+{
+    migraphx::shape s{migraphx::shape::float_type, {2, 2}};
+    migraphx::literal l1{s, {1, 2, 3, 4}};
+    auto v = migraphx::to_value(l1);
+    EXPECT(v.at("data").is_binary());
+    EXPECT(v.at("data").get_binary().size() == s.bytes());
+    auto l2 = migraphx::from_value<migraphx::literal>(v);
+    EXPECT(l2 == l1);
+    // The literal shares the bytes of the binary
+    EXPECT(l2.data() == v.at("data").get_binary().data());
+
+    // Data stored as a value for each element is still supported
+    migraphx::value v2 = {{"shape", migraphx::to_value(s)}, {"data", {1, 2, 3, 4}}};
+    EXPECT(migraphx::from_value<migraphx::literal>(v2) == l1);
+
+    v["data"] = migraphx::value::binary{l1.data(), 4};
+    EXPECT(test::throws([&] { migraphx::from_value<migraphx::literal>(v); }));
+}
+
 int main(int argc, const char* argv[]) { test::run(argc, argv); }
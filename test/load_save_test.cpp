@@ -0,0 +1,110 @@
+#include <migraphx/load_save.hpp>
+#include <migraphx/program.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/iterator_for.hpp>
+#include <migraphx/operators.hpp>
+#include <migraphx/generate.hpp>
+#include <migraphx/ranges.hpp>
+#include <migraphx/stringutils.hpp>
+#include <migraphx/register_target.hpp>
+#include <migraphx/cpu/target.hpp>
+#include <cstdio>
+#include <fstream>
+#include "test.hpp"
+
+struct tmp_file
+{
+    std::string name;
+    tmp_file(std::string n) : name(std::move(n)) {}
+    tmp_file(const tmp_file&) = delete;
+    tmp_file& operator=(const tmp_file&) = delete;
+    ~tmp_file() { std::remove(name.c_str()); }
+};
+
+migraphx::program create_program()
+{
+    migraphx::program p;
+    migraphx::shape s{migraphx::shape::float_type, {2, 3}};
+    auto x   = p.add_parameter("x", s);
+    auto y   = p.add_parameter("y", s);
+    auto one = p.add_literal(migraphx::generate_literal(s, 1));
+    auto sum = p.add_instruction(migraphx::op::add{}, x, one);
+    auto lr  = p.add_instruction(migraphx::op::leaky_relu{0.1}, sum);
+    auto t   = p.add_instruction(migraphx::op::transpose{{1, 0}}, y);
+    auto dot = p.add_instruction(migraphx::op::dot{}, lr, t);
+    p.add_return({dot, sum});
+    return p;
+}
+
+migraphx::program::parameter_map create_params(const migraphx::program& p)
+{
+    migraphx::program::parameter_map params;
+    for(auto&& x : p.get_parameter_shapes())
+        params[x.first] = migraphx::generate_argument(x.second, x.first.size());
+    return params;
+}
+
+TEST_CASE(save_load)
+{
+    tmp_file f{"save_load.mxr"};
+    auto p1 = create_program();
+    migraphx::save(p1, f.name);
+    auto p2 = migraphx::load(f.name);
+    EXPECT(p1 == p2);
+    EXPECT(p1.get_parameter_names() == p2.get_parameter_names());
+    p1.compile(migraphx::cpu::target{});
+    p2.compile(migraphx::cpu::target{});
+    auto params = create_params(p1);
+    EXPECT(p1.eval(params) == p2.eval(params));
+}
+
+TEST_CASE(save_load_compiled)
+{
+    tmp_file f{"save_load_compiled.mxr"};
+    auto p1 = create_program();
+    p1.compile(migraphx::cpu::target{});
+    migraphx::save(p1, f.name);
+    auto p2 = migraphx::load(f.name);
+    EXPECT(p1 == p2);
+    EXPECT(std::any_of(p2.begin(), p2.end(), [](auto&& ins) {
+        return migraphx::starts_with(ins.name(), "cpu::");
+    }));
+    auto params = create_params(p1);
+    auto r1     = p1.eval(params);
+    auto r2     = p2.eval(params);
+    EXPECT(r1 == r2);
+    // The scratch memory is allocated again, so the results do not change
+    // between runs
+    EXPECT(p2.eval(params) == r2);
+}
+
+TEST_CASE(value_round_trip)
+{
+    auto p1 = create_program();
+    p1.compile(migraphx::cpu::target{});
+    migraphx::program p2;
+    p2.from_value(p1.to_value());
+    EXPECT(p1 == p2);
+    auto params = create_params(p1);
+    EXPECT(p1.eval(params) == p2.eval(params));
+}
+
+TEST_CASE(make_cpu_target)
+{
+    EXPECT(migraphx::contains(migraphx::get_targets(), "cpu"));
+    EXPECT(migraphx::make_target("cpu").name() == "cpu");
+    EXPECT(test::throws([] { migraphx::make_target("unknown"); }));
+}
+
+TEST_CASE(load_invalid)
+{
+    tmp_file f{"load_invalid.mxr"};
+    {
+        std::ofstream os(f.name, std::ios::binary);
+        os << "not a program file";
+    }
+    EXPECT(test::throws([&] { migraphx::load(f.name); }));
+    EXPECT(test::throws([] { migraphx::load("does_not_exist.mxr"); }));
+}
+
+int main(int argc, const char* argv[]) { test::run(argc, argv); }
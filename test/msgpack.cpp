@@ -93,14 +93,35 @@ TEST_CASE(test_msgpack_empty_object)
 {
     migraphx::value v = migraphx::value::object{};
     auto buffer       = migraphx::to_msgpack(v);
-    EXPECT(buffer == msgpack_buffer(std::vector<int>{}));
+    EXPECT(buffer == msgpack_buffer(std::map<std::string, int>{}));
     auto u = migraphx::from_msgpack(buffer);
-    // This is not equal since an empty object becomes an empty array
-    EXPECT(u != v);
-    EXPECT(u.is_array());
+    EXPECT(u == v);
+    EXPECT(u.is_object());
     EXPECT(u.size() == 0);
 }
 
+TEST_CASE(test_msgpack_binary)
+{
+    std::vector<char> data = {1, 2, 3, 4};
+    migraphx::value v      = migraphx::value::binary{data.data(), data.size()};
+    auto buffer            = migraphx::to_msgpack(v);
+    EXPECT(buffer == msgpack_buffer(msgpack::type::raw_ref{data.data(), 4}));
+    EXPECT(migraphx::from_msgpack(buffer) == v);
+}
+
+TEST_CASE(test_msgpack_binary_shared)
+{
+    std::vector<char> data = {1, 2, 3, 4};
+    migraphx::value v      = {{"data", migraphx::value::binary{data.data(), data.size()}}};
+    auto buffer            = migraphx::to_msgpack(v);
+    std::shared_ptr<const char> shared(buffer.data(), [](const char*) {});
+    auto u = migraphx::from_msgpack(shared, buffer.size());
+    EXPECT(u == v);
+    // The bytes are not copied out of the buffer
+    const auto* p = u.at("data").get_binary().data();
+    EXPECT(p >= buffer.data() and p < buffer.data() + buffer.size());
+}
+
 struct foo
 {
     double a;
@@ -1162,6 +1162,46 @@ def expand_test():
     return ([shape_const, node], [x], [y])
 
 
+def external_data_test():
+    values = np.arange(6).reshape(2, 3).astype(np.float32)
+    w = numpy_helper.from_array(values, name='w')
+    x = helper.make_tensor_value_info('x', TensorProto.FLOAT, [2, 3])
+    y = helper.make_tensor_value_info('y', TensorProto.FLOAT, [2, 3])
+
+    node = onnx.helper.make_node('Add', inputs=['x', 'w'], outputs=['y'])
+
+    graph_def = helper.make_graph([node],
+                                  'external_data_test', [x], [y],
+                                  initializer=[w])
+    model_def = helper.make_model(graph_def,
+                                  producer_name='external_data_test')
+    onnx.save_model(model_def,
+                    'external_data_test.onnx',
+                    save_as_external_data=True,
+                    location='external_data_test.weight',
+                    size_threshold=0)
+
+
+def external_data_offset_test():
+    values = np.arange(6).reshape(2, 3).astype(np.float32)
+    w = numpy_helper.from_array(values, name='w')
+    x = helper.make_tensor_value_info('x', TensorProto.FLOAT, [2, 3])
+    y = helper.make_tensor_value_info('y', TensorProto.FLOAT, [2, 3])
+
+    node = onnx.helper.make_node('Add', inputs=['x', 'w'], outputs=['y'])
+
+    graph_def = helper.make_graph([node],
+                                  'external_data_offset_test', [x], [y],
+                                  initializer=[w])
+    model_def = helper.make_model(graph_def,
+                                  producer_name='external_data_offset_test')
+    onnx.external_data_helper.convert_model_to_external_data(
+        model_def, location='external_data_test.weight', size_threshold=0)
+    for e in model_def.graph.initializer[0].external_data:
+        if e.key == 'offset':
+            e.value = '-1'
+    onnx.save_model(model_def, 'external_data_offset_test.onnx')
+
 @onnx_test
 def flatten_test():
     x = helper.make_tensor_value_info('0', TensorProto.FLOAT, [2, 3, 4, 5])
@@ -2048,6 +2088,23 @@ def range_float_test():
     return ([start, limit, delta, node], [], [y])
 
 
+@onnx_test
+def raw_data_size_test():
+    x = helper.make_tensor_value_info('x', TensorProto.FLOAT, [2, 3])
+    y = helper.make_tensor_value_info('y', TensorProto.FLOAT, [2, 3])
+
+    # Only two of the six floats are stored
+    w = helper.make_tensor(name='w',
+                           data_type=TensorProto.FLOAT,
+                           dims=[2, 3],
+                           vals=np.array([0, 1], dtype=np.float32).tobytes(),
+                           raw=True)
+
+    node = onnx.helper.make_node('Add', inputs=['x', 'w'], outputs=['y'])
+
+    return ([node], [x], [y], [w])
+
+
 @onnx_test
 def recip_test():
     x = helper.make_tensor_value_info('x', TensorProto.FLOAT, [3])
@@ -807,6 +807,30 @@ TEST_CASE(expand_test)
     EXPECT(p == prog);
 }
 
+TEST_CASE(external_data_test)
+{
+    migraphx::program p;
+    std::vector<float> w = {0, 1, 2, 3, 4, 5};
+    auto l1 = p.add_literal(migraphx::literal({migraphx::shape::float_type, {2, 3}}, w));
+    auto l0 = p.add_parameter("x", migraphx::shape{migraphx::shape::float_type, {2, 3}});
+    p.add_instruction(migraphx::op::add{}, l0, l1);
+
+    auto prog = optimize_onnx("external_data_test.onnx");
+    EXPECT(p == prog);
+
+    migraphx::onnx_options options;
+    options.use_mmap = true;
+    auto mapped      = migraphx::parse_onnx("external_data_test.onnx", options);
+    // remove the return instruction
+    mapped.remove_instruction(std::prev(mapped.end()));
+    EXPECT(p == mapped);
+}
+
+TEST_CASE(external_data_offset_test)
+{
+    EXPECT(test::throws([&] { migraphx::parse_onnx("external_data_offset_test.onnx"); }));
+}
+
 TEST_CASE(flatten_test)
 {
     migraphx::program p;
@@ -1517,6 +1541,11 @@ TEST_CASE(range_float_test)
     EXPECT(p == prog);
 }
 
+TEST_CASE(raw_data_size_test)
+{
+    EXPECT(test::throws([&] { migraphx::parse_onnx("raw_data_size_test.onnx"); }));
+}
+
 TEST_CASE(recip_test)
 {
     migraphx::program p;
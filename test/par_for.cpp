@@ -0,0 +1,80 @@
+#include <migraphx/par_for.hpp>
+#include <migraphx/par_dfor.hpp>
+#include <migraphx/thread_pool.hpp>
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+#include "test.hpp"
+
+TEST_CASE(par_for_all)
+{
+    std::vector<std::size_t> visited(1000, 0);
+    migraphx::par_for(visited.size(), [&](auto i) { visited[i]++; });
+    EXPECT(std::all_of(visited.begin(), visited.end(), [](auto x) { return x == 1; }));
+}
+
+TEST_CASE(par_for_tid)
+{
+    auto n = migraphx::get_thread_pool().size();
+    std::vector<std::size_t> sums(n, 0);
+    migraphx::par_for(1000, [&](auto i, auto tid) {
+        EXPECT(tid < n);
+        sums[tid] += i;
+    });
+    EXPECT(std::accumulate(sums.begin(), sums.end(), std::size_t{0}) == 999 * 1000 / 2);
+}
+
+TEST_CASE(par_for_nested)
+{
+    std::atomic<std::size_t> count{0};
+    migraphx::par_for(64, 1, [&](auto) { migraphx::par_for(64, 1, [&](auto) { count++; }); });
+    EXPECT(count == 64 * 64);
+}
+
+TEST_CASE(par_dfor_all)
+{
+    std::vector<std::size_t> visited(8 * 9 * 10, 0);
+    migraphx::par_dfor(8, 9, 10)(
+        [&](std::size_t i, std::size_t j, std::size_t k) { visited[(i * 9 + j) * 10 + k]++; });
+    EXPECT(std::all_of(visited.begin(), visited.end(), [](auto x) { return x == 1; }));
+}
+
+TEST_CASE(thread_pool_run)
+{
+    migraphx::thread_pool pool{4};
+    EXPECT(pool.size() == 4);
+    std::vector<std::size_t> visited(100, 0);
+    for(std::size_t k = 0; k < 10; k++)
+        pool.run(visited.size(), [&](std::size_t i) { visited[i]++; });
+    EXPECT(std::all_of(visited.begin(), visited.end(), [](auto x) { return x == 10; }));
+}
+
+TEST_CASE(thread_pool_single)
+{
+    migraphx::thread_pool pool{0};
+    EXPECT(pool.size() == 1);
+    std::size_t count = 0;
+    pool.run(10, [&](std::size_t) { count++; });
+    EXPECT(count == 10);
+}
+
+TEST_CASE(thread_pool_exception)
+{
+    migraphx::thread_pool pool{4};
+    std::atomic<std::size_t> count{0};
+    EXPECT(test::throws([&] {
+        pool.run(8, [&](std::size_t i) {
+            count++;
+            if(i == 3)
+                throw std::runtime_error("error");
+        });
+    }));
+    EXPECT(count == 8);
+    // The pool is still usable after a failed run
+    count = 0;
+    pool.run(8, [&](std::size_t) { count++; });
+    EXPECT(count == 8);
+}
+
+int main(int argc, const char* argv[]) { test::run(argc, argv); }
@@ -69,4 +69,11 @@ TEST_CASE(serialize_reflectable_type)
     EXPECT(v2 != v3);
 }
 
+TEST_CASE(serialize_empty_type_from_empty_array)
+{
+    // Older msgpack buffers have empty arrays in place of empty objects
+    migraphx::from_value<empty_type>(migraphx::value::array{});
+    EXPECT(test::throws([] { migraphx::from_value<empty_type>(migraphx::value::array{1}); }));
+}
+
 int main(int argc, const char* argv[]) { test::run(argc, argv); }
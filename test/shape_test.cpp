@@ -1,6 +1,8 @@
 
 #include <migraphx/shape.hpp>
 #include <migraphx/serialize.hpp>
+#include <migraphx/shape_for_each.hpp>
+#include <migraphx/tensor_view.hpp>
 #include <array>
 #include <algorithm>
 #include <numeric>
@@ -386,4 +388,45 @@ TEST_CASE(test_serialize)
     EXPECT(s3 != s4);
 }
 
+TEST_CASE(test_shape_for_each_order)
+{
+    migraphx::shape s{migraphx::shape::float_type, {2, 3, 4}, {1, 8, 2}};
+    std::vector<std::vector<std::size_t>> indices;
+    migraphx::shape_for_each(s, [&](const auto& idx) { indices.push_back(idx); });
+    EXPECT(indices.size() == s.elements());
+    for(std::size_t i = 0; i < indices.size(); i++)
+    {
+        EXPECT(indices[i].size() == 3);
+        EXPECT(s.index(indices[i].begin(), indices[i].end()) == s.index(i));
+    }
+    EXPECT(indices.back() == std::vector<std::size_t>{1, 2, 3});
+}
+
+TEST_CASE(test_tensor_view_strided_iterator)
+{
+    std::vector<int> data(6);
+    std::iota(data.begin(), data.end(), 0);
+    migraphx::shape s{migraphx::shape::int32_type, {3, 2}, {1, 3}};
+    auto view = migraphx::make_view(s, data.data());
+    std::vector<int> gold = {0, 3, 1, 4, 2, 5};
+    EXPECT(view.to_vector() == gold);
+    EXPECT(std::distance(view.strided_begin(), view.strided_end()) == 6);
+    EXPECT(view.strided_begin()[3] == 4);
+    EXPECT(*(view.strided_end() - 1) == 5);
+    std::vector<int> reversed(std::make_reverse_iterator(view.strided_end()),
+                              std::make_reverse_iterator(view.strided_begin()));
+    EXPECT(reversed == std::vector<int>(gold.rbegin(), gold.rend()));
+}
+
+TEST_CASE(test_tensor_view_iterator_temporary)
+{
+    std::vector<int> data(6);
+    std::iota(data.begin(), data.end(), 0);
+    migraphx::shape s{migraphx::shape::int32_type, {3, 2}, {1, 3}};
+    // The views are destroyed before the iterators are used
+    auto first = migraphx::make_view(s, data.data()).strided_begin();
+    auto last  = migraphx::make_view(s, data.data()).strided_end();
+    EXPECT(std::vector<int>(first, last) == std::vector<int>{0, 3, 1, 4, 2, 5});
+}
+
 int main(int argc, const char* argv[]) { test::run(argc, argv); }
@@ -0,0 +1,132 @@
+#include <migraphx/sink_transposes.hpp>
+#include <migraphx/simplify_reshapes.hpp>
+#include <migraphx/dead_code_elimination.hpp>
+#include <migraphx/pass_manager.hpp>
+#include <migraphx/operators.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/generate.hpp>
+#include <basic_ops.hpp>
+#include <test.hpp>
+
+void run_pass(migraphx::program& p)
+{
+    migraphx::run_passes(p,
+                         {migraphx::sink_transposes{},
+                          migraphx::simplify_reshapes{},
+                          migraphx::dead_code_elimination{}});
+}
+
+TEST_CASE(unary_transpose)
+{
+    migraphx::shape s{migraphx::shape::float_type, {1, 2, 3, 4}};
+    migraphx::program p1;
+    {
+        auto x    = p1.add_parameter("x", s);
+        auto t1   = p1.add_instruction(migraphx::op::transpose{{0, 2, 3, 1}}, x);
+        auto relu = p1.add_instruction(migraphx::op::relu{}, t1);
+        auto t2   = p1.add_instruction(migraphx::op::transpose{{0, 3, 1, 2}}, relu);
+        p1.add_instruction(pass_op{}, t2);
+    }
+    run_pass(p1);
+
+    migraphx::program p2;
+    {
+        auto x    = p2.add_parameter("x", s);
+        auto relu = p2.add_instruction(migraphx::op::relu{}, x);
+        p2.add_instruction(pass_op{}, relu);
+    }
+    EXPECT(p1 == p2);
+}
+
+TEST_CASE(binary_broadcast_reduce_transpose)
+{
+    migraphx::shape s{migraphx::shape::float_type, {2, 3, 4, 5}};
+    migraphx::shape bs{migraphx::shape::float_type, {3}};
+    auto b = migraphx::generate_literal(bs);
+    migraphx::program p1;
+    {
+        auto x   = p1.add_parameter("x", s);
+        auto y   = p1.add_parameter("y", s);
+        auto l   = p1.add_literal(b);
+        auto xt  = p1.add_instruction(migraphx::op::transpose{{0, 2, 3, 1}}, x);
+        auto yt  = p1.add_instruction(migraphx::op::transpose{{0, 2, 3, 1}}, y);
+        auto bb  = p1.add_instruction(migraphx::op::broadcast{3, {2, 4, 5, 3}}, l);
+        auto sum = p1.add_instruction(migraphx::op::add{}, xt, yt);
+        auto add = p1.add_instruction(migraphx::op::add{}, sum, bb);
+        auto r   = p1.add_instruction(migraphx::op::reduce_sum{{1}}, add);
+        auto t   = p1.add_instruction(migraphx::op::transpose{{0, 3, 1, 2}}, r);
+        p1.add_instruction(pass_op{}, t);
+    }
+    run_pass(p1);
+
+    migraphx::program p2;
+    {
+        auto x   = p2.add_parameter("x", s);
+        auto y   = p2.add_parameter("y", s);
+        auto l   = p2.add_literal(b);
+        auto bb  = p2.add_instruction(migraphx::op::broadcast{3, {2, 4, 5, 3}}, l);
+        auto sum = p2.add_instruction(migraphx::op::add{}, x, y);
+        auto bt  = p2.add_instruction(migraphx::op::transpose{{0, 3, 1, 2}}, bb);
+        auto add = p2.add_instruction(migraphx::op::add{}, sum, bt);
+        auto r   = p2.add_instruction(migraphx::op::reduce_sum{{2}}, add);
+        p2.add_instruction(pass_op{}, r);
+    }
+    EXPECT(p1 == p2);
+}
+
+TEST_CASE(softmax_transpose)
+{
+    migraphx::shape s{migraphx::shape::float_type, {2, 3, 4, 5}};
+    migraphx::program p1;
+    {
+        auto x  = p1.add_parameter("x", s);
+        auto t1 = p1.add_instruction(migraphx::op::transpose{{0, 2, 3, 1}}, x);
+        auto c  = p1.add_instruction(migraphx::op::contiguous{}, t1);
+        auto sm = p1.add_instruction(migraphx::op::softmax{-1}, c);
+        auto t2 = p1.add_instruction(migraphx::op::transpose{{0, 3, 1, 2}}, sm);
+        p1.add_instruction(pass_op{}, t2);
+    }
+    run_pass(p1);
+
+    migraphx::program p2;
+    {
+        auto x  = p2.add_parameter("x", s);
+        auto sm = p2.add_instruction(migraphx::op::softmax{1}, x);
+        p2.add_instruction(pass_op{}, sm);
+    }
+    EXPECT(p1 == p2);
+}
+
+TEST_CASE(reduce_transpose_kept)
+{
+    auto create_program = [] {
+        migraphx::program p;
+        auto x = p.add_parameter("x", {migraphx::shape::float_type, {2, 3, 4, 5}});
+        auto t = p.add_instruction(migraphx::op::transpose{{0, 2, 3, 1}}, x);
+        auto r = p.add_instruction(migraphx::op::reduce_sum{{1}}, t);
+        p.add_instruction(pass_op{}, r);
+        return p;
+    };
+    auto p1 = create_program();
+    run_pass(p1);
+    EXPECT(p1 == create_program());
+}
+
+TEST_CASE(binary_standard_transpose_kept)
+{
+    auto create_program = [] {
+        migraphx::program p;
+        auto x   = p.add_parameter("x", {migraphx::shape::float_type, {2, 3, 4, 5}});
+        auto y   = p.add_parameter("y", {migraphx::shape::float_type, {2, 4, 5, 3}});
+        auto t1  = p.add_instruction(migraphx::op::transpose{{0, 2, 3, 1}}, x);
+        auto add = p.add_instruction(migraphx::op::add{}, t1, y);
+        auto t2  = p.add_instruction(migraphx::op::transpose{{0, 3, 1, 2}}, add);
+        p.add_instruction(pass_op{}, t2);
+        return p;
+    };
+    auto p1 = create_program();
+    run_pass(p1);
+    EXPECT(p1 == create_program());
+}
+
+int main(int argc, const char* argv[]) { test::run(argc, argv); }
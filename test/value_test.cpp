@@ -555,6 +555,32 @@ TEST_CASE(not_array)
     }();
 }
 
+TEST_CASE(value_binary)
+{
+    std::vector<char> data = {1, 2, 3};
+    migraphx::value v      = migraphx::value::binary{data.data(), data.size()};
+    EXPECT(v.is_binary());
+    EXPECT(v.get_binary().size() == 3);
+    EXPECT(std::equal(data.begin(), data.end(), v.get_binary().begin()));
+    // Copies of the value share the bytes
+    migraphx::value v2 = v; // NOLINT
+    EXPECT(v2 == v);
+    EXPECT(v2.get_binary().data() == v.get_binary().data());
+    data.back()        = 4;
+    migraphx::value v3 = migraphx::value::binary{data.data(), data.size()};
+    EXPECT(v3 != v);
+    EXPECT(v < v3);
+    EXPECT(test::throws([&] { v.to<int>(); }));
+}
+
+TEST_CASE(value_binary_key)
+{
+    std::vector<char> data = {1, 2, 3};
+    migraphx::value v      = {{"data", migraphx::value::binary{data.data(), data.size()}}};
+    EXPECT(v.at("data").is_binary());
+    EXPECT(v.at("data").get_binary() == migraphx::value::binary{data.data(), data.size()});
+}
+
 TEST_CASE(print)
 {
     std::stringstream ss;